@@ -74,7 +74,7 @@ void ActivateWindowAction::cfg_write( KConfigGroup& cfg_P ) const
 
 void ActivateWindowAction::execute()
     {
-    if( window()->match( windows_handler->active_window()))
+    if( window()->match( windows_handler->window_data( windows_handler->active_window())))
         return; // is already active
     WId win_id = windows_handler->find_window( window());
     if( win_id != XCB_WINDOW_NONE )
@@ -98,7 +98,7 @@ bool Active_window_condition::match() const
 
 void Active_window_condition::set_match()
     {
-    is_match = window()->match( Window_data( windows_handler->active_window()));
+    is_match = window()->match( windows_handler->window_data( windows_handler->active_window()));
     updated();
     }
 
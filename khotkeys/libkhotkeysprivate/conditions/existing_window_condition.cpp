@@ -89,7 +89,7 @@ bool Existing_window_condition::match() const
 void Existing_window_condition::set_match( WId w_P )
     {
     if( w_P != None && !is_match )
-        is_match = window()->match( Window_data( w_P ));
+        is_match = window()->match( windows_handler->window_data( w_P ));
     else
         is_match = windows_handler->find_window( window()) != None;
     updated();
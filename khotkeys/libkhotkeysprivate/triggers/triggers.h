@@ -282,6 +282,9 @@ class Q_DECL_EXPORT WindowTrigger : public QObject, public Trigger
 
     private:
 
+        //! Calls the slots above for the windows we can match
+        friend class WindowsHandler;
+
         //! Useful code for all constructors
         void init();
 
@@ -58,7 +58,10 @@ WindowTrigger::WindowTrigger(
 WindowTrigger::~WindowTrigger()
     {
 //    kDebug() << "~WindowTrigger :" << this;
-    disconnect( windows_handler, NULL, this, NULL );
+    if (windows_handler)
+        {
+        windows_handler->remove_window_trigger( this );
+        }
     delete _windows;
     }
 
@@ -79,13 +82,11 @@ void WindowTrigger::accept(TriggerVisitor& visitor)
 void WindowTrigger::init()
     {
     kDebug() << "WindowTrigger::init()";
-    connect( windows_handler, SIGNAL(window_added(WId)), this, SLOT(window_added(WId)));
-    connect( windows_handler, SIGNAL(window_removed(WId)), this, SLOT(window_removed(WId)));
-    if( window_actions & ( WINDOW_ACTIVATES | WINDOW_DEACTIVATES /*| WINDOW_DISAPPEARS*/ ))
-        connect( windows_handler, SIGNAL(active_window_changed(WId)),
-            this, SLOT(active_window_changed(WId)));
-    connect( windows_handler, SIGNAL(window_changed(WId,uint)),
-        this, SLOT(window_changed(WId,uint)));
+    // The handler only tells us about windows of the classes we can match
+    if (windows_handler)
+        {
+        windows_handler->add_window_trigger( this );
+        }
     }
 
 
@@ -99,7 +100,7 @@ void WindowTrigger::active_window_changed( WId window_P )
     {
     if (!existing_windows.contains(window_P))
         {
-        existing_windows[window_P] = windows()->match( Window_data( window_P ));
+        existing_windows[window_P] = windows()->match( windows_handler->window_data( window_P ));
         }
 
     if (!active || !khotkeys_active())
@@ -161,6 +162,12 @@ void WindowTrigger::set_window_rules(Windowdef_list *list)
     {
      delete _windows;
     _windows = list;
+    // The classes we can match have changed
+    existing_windows.clear();
+    if (windows_handler)
+        {
+        windows_handler->add_window_trigger( this );
+        }
     }
 
 
@@ -173,7 +180,7 @@ bool WindowTrigger::triggers_on( window_action_t w_action_P ) const
 void WindowTrigger::window_added( WId window_P )
     {
     // Always keep track of windows,
-    existing_windows[window_P] = windows()->match( Window_data( window_P ));
+    existing_windows[window_P] = windows()->match( windows_handler->window_data( window_P ));
 
     if (!active || !khotkeys_active())
         {
@@ -222,7 +229,7 @@ void WindowTrigger::window_changed( WId window_P, unsigned int dirty_P )
         was_match = existing_windows[window_P];
 
     // Check if the new state is a match
-    bool matches = windows()->match( Window_data( window_P ));
+    bool matches = windows()->match( windows_handler->window_data( window_P ));
     existing_windows[window_P] = matches;
 
     if (!active || !khotkeys_active())
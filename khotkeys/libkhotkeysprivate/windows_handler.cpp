@@ -14,6 +14,7 @@
 
 #include "windows_helper/window_selection_rules.h"
 #include "windows_helper/window_selection_list.h"
+#include "triggers/triggers.h"
 
 #include <QRegExp>
 
@@ -36,7 +37,7 @@ namespace KHotKeys
 
 WindowsHandler::WindowsHandler( bool enable_signal_P, QObject* parent_P )
     : QObject( parent_P ), signals_enabled( enable_signal_P ),
-        _action_window( 0 )
+        _action_window( 0 ), _active_window( 0 )
     {
     if( signals_enabled )
         {
@@ -44,6 +45,10 @@ WindowsHandler::WindowsHandler( bool enable_signal_P, QObject* parent_P )
         connect( KWindowSystem::self(), SIGNAL(windowRemoved(WId)), SLOT(window_removed_slot(WId)));
         connect( KWindowSystem::self(), SIGNAL(activeWindowChanged(WId)),
             SLOT(active_window_changed_slot(WId)));
+        // only to keep the window data cache current
+        connect( KWindowSystem::self(), SIGNAL(windowChanged(WId,uint)),
+            SLOT(window_properties_changed(WId,uint)));
+        _active_window = KWindowSystem::activeWindow();
         }
     }
 
@@ -53,8 +58,14 @@ WindowsHandler::~WindowsHandler()
 
 void WindowsHandler::window_added_slot( WId window_P )
     {
-    if( signals_enabled )
-        emit window_added( window_P );
+    if( !signals_enabled )
+        return;
+    emit window_added( window_P );
+    foreach( WindowTrigger* trigger, window_triggers( window_data( window_P ).wclass ))
+        {
+        if( _triggers.contains( trigger ))
+            trigger->window_added( window_P );
+        }
     // CHECKME tyhle i dalsi by asi mely jit nastavit, jestli aktivuji vsechny, nebo jen jeden
     // pripojeny slot ( stejne jako u Kdb, kde by to take melo jit nastavit )
     }
@@ -62,27 +73,124 @@ void WindowsHandler::window_added_slot( WId window_P )
 void WindowsHandler::window_removed_slot( WId window_P )
     {
     if( signals_enabled )
+        {
+        // the window is gone, so only the cache knows its class
+        const QString wclass = _window_data.value( window_P ).wclass;
+        _window_data.remove( window_P );
         emit window_removed( window_P );
+        foreach( WindowTrigger* trigger, window_triggers( wclass ))
+            {
+            if( _triggers.contains( trigger ))
+                trigger->window_removed( window_P );
+            }
+        }
     if( window_P == _action_window )
         _action_window = 0;
     }
 
 void WindowsHandler::active_window_changed_slot( WId window_P )
     {
-    if( signals_enabled )
-        emit active_window_changed( window_P );
+    if( !signals_enabled )
+        return;
+    const WId previous = _active_window;
+    _active_window = window_P;
+    emit active_window_changed( window_P );
+
+    // triggers for the class of the previous window need to see it deactivate
+    QList< WindowTrigger* > triggers = window_triggers( window_data( window_P ).wclass );
+    if( previous != None && previous != window_P )
+        {
+        foreach( WindowTrigger* trigger, window_triggers( window_data( previous ).wclass ))
+            {
+            if( !triggers.contains( trigger ))
+                triggers.append( trigger );
+            }
+        }
+    foreach( WindowTrigger* trigger, triggers )
+        {
+        if( _triggers.contains( trigger )
+            && ( trigger->triggers_on( WindowTrigger::WINDOW_ACTIVATES )
+                || trigger->triggers_on( WindowTrigger::WINDOW_DEACTIVATES )))
+            trigger->active_window_changed( window_P );
+        }
     }
 
 void WindowsHandler::window_changed_slot( WId window_P )
     {
     if( signals_enabled )
+        {
+        _window_data.remove( window_P );
         emit window_changed( window_P );
+        }
     }
 
 void WindowsHandler::window_changed_slot( WId window_P, unsigned int flags_P )
     {
-    if( signals_enabled )
-        emit window_changed( window_P, flags_P );
+    if( !signals_enabled )
+        return;
+    window_properties_changed( window_P, flags_P );
+    emit window_changed( window_P, flags_P );
+    foreach( WindowTrigger* trigger, window_triggers( window_data( window_P ).wclass ))
+        {
+        if( _triggers.contains( trigger ))
+            trigger->window_changed( window_P, flags_P );
+        }
+    }
+
+void WindowsHandler::window_properties_changed( WId window_P, unsigned int flags_P )
+    {
+    if( flags_P & ( NET::WMName | NET::WMWindowType ))
+        _window_data.remove( window_P );
+    }
+
+Window_data WindowsHandler::window_data( WId id_P )
+    {
+    if( !signals_enabled ) // nothing would tell us when the data gets stale
+        return Window_data( id_P );
+    QHash< WId, Window_data >::const_iterator it = _window_data.constFind( id_P );
+    if( it != _window_data.constEnd())
+        return *it;
+    return *_window_data.insert( id_P, Window_data( id_P ));
+    }
+
+void WindowsHandler::add_window_trigger( WindowTrigger* trigger_P )
+    {
+    remove_window_trigger( trigger_P );
+    _triggers.insert( trigger_P );
+    QStringList classes;
+    if( trigger_P->windows()->match_classes( classes ))
+        {
+        foreach( const QString& wclass, classes )
+            _class_triggers.insert( wclass, trigger_P );
+        }
+    else
+        _any_class_triggers.append( trigger_P );
+    }
+
+void WindowsHandler::remove_window_trigger( WindowTrigger* trigger_P )
+    {
+    if( !_triggers.remove( trigger_P ))
+        return;
+    _any_class_triggers.removeAll( trigger_P );
+    QMultiHash< QString, WindowTrigger* >::iterator it = _class_triggers.begin();
+    while( it != _class_triggers.end())
+        {
+        if( it.value() == trigger_P )
+            it = _class_triggers.erase( it );
+        else
+            ++it;
+        }
+    }
+
+QList< WindowTrigger* > WindowsHandler::window_triggers( const QString& wclass_P ) const
+    {
+    QList< WindowTrigger* > ret = _any_class_triggers;
+    foreach( WindowTrigger* trigger, _class_triggers.values( wclass_P ))
+        {
+        if( !ret.contains( trigger ))
+            ret.append( trigger );
+        }
+    return ret;
     }
 
 QString WindowsHandler::get_window_role( WId id_P )
@@ -126,8 +234,7 @@ WId WindowsHandler::find_window( const Windowdef_list* window_P )
          it != windows.end();
          ++it )
         {
-        Window_data tmp( *it );
-        if( window_P->match( tmp ))
+        if( window_P->match( window_data( *it )))
             return *it;
         }
     return None;
@@ -177,6 +284,11 @@ void WindowsHandler::activate_window( WId id_P )
 
 // Window_data
 
+Window_data::Window_data()
+    : type( NET::Unknown )
+    {
+    }
+
 Window_data::Window_data( WId id_P )
     : type( NET::Unknown )
     {
@@ -19,11 +19,17 @@
 
 #include <kdemacros.h>
 
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMultiHash>
 #include <QtCore/QObject>
+#include <QtCore/QSet>
 #include <QtGui/qwindowdefs.h>
 
 #include <netwm.h>
 
+#include "windows_helper/window_selection_interface.h"
+
 namespace KHotKeys
 {
 
@@ -33,6 +39,7 @@ const NET::WindowTypes SUPPORTED_WINDOW_TYPES_MASK = NET::NormalMask | NET::Desk
 
 
 class Windowdef_list;
+class WindowTrigger;
 
 class Q_DECL_EXPORT WindowsHandler : public QObject
                                   #include <QtGui/qwindowdefs.h>
@@ -49,6 +56,20 @@ class Q_DECL_EXPORT WindowsHandler : public QObject
         WId find_window( const Windowdef_list* window_P );
         static WId window_at_position( int x, int y );
         static void activate_window( WId id_P );
+
+        /**
+         * Title, class, role and type of window @p id_P. While signals are
+         * enabled they are fetched once per window and shared by all
+         * conditions and triggers.
+         */
+        Window_data window_data( WId id_P );
+
+        /**
+         * Window triggers are not connected to the signals, they are called
+         * only for the windows of the classes they can match.
+         */
+        void add_window_trigger( WindowTrigger* trigger_P );
+        void remove_window_trigger( WindowTrigger* trigger_P );
     Q_SIGNALS:
         void window_added( WId window_P );
         void window_removed( WId window_P );
@@ -61,9 +82,18 @@ class Q_DECL_EXPORT WindowsHandler : public QObject
         void active_window_changed_slot( WId window_P );
         void window_changed_slot( WId window_P );
         void window_changed_slot( WId window_P, unsigned int flags_P );
+        void window_properties_changed( WId window_P, unsigned int flags_P );
     private:
+        QList< WindowTrigger* > window_triggers( const QString& wclass_P ) const;
         bool signals_enabled;
         WId _action_window;
+        WId _active_window;
+        QHash< WId, Window_data > _window_data;
+        //! Triggers by the classes they can match
+        QMultiHash< QString, WindowTrigger* > _class_triggers;
+        //! Triggers that can match windows of any class
+        QList< WindowTrigger* > _any_class_triggers;
+        QSet< WindowTrigger* > _triggers;
     };
 
 
@@ -46,6 +46,12 @@ void Windowdef::cfg_write( KConfigGroup& cfg_P ) const
     }
 
 
+bool Windowdef::exact_class( QString& ) const
+    {
+    return false;
+    }
+
+
 const QString& Windowdef::comment() const
     {
     return _comment;
@@ -31,6 +31,7 @@ namespace KHotKeys {
 
 struct Q_DECL_EXPORT Window_data
     {
+    Window_data();
     Window_data( WId id_P );
     QString title; // _NET_WM_NAME or WM_NAME
     QString role; // WM_WINDOW_ROLE
@@ -49,6 +50,11 @@ class Q_DECL_EXPORT Windowdef
         const QString& comment() const;
         void set_comment(const QString &comment);
         virtual bool match( const Window_data& window_P ) = 0;
+        /**
+         * Returns true and sets @p wclass_P if only windows of exactly that
+         * class can match.
+         */
+        virtual bool exact_class( QString& wclass_P ) const;
         static Windowdef* create_cfg_read( KConfigGroup& cfg_P/*, ActionDataBase* data_P*/ );
         virtual void cfg_write( KConfigGroup& cfg_P ) const = 0;
         virtual Windowdef* copy( /*ActionDataBase* data_P*/ ) const = 0;
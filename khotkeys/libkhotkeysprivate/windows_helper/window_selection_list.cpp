@@ -102,6 +102,24 @@ bool Windowdef_list::match( const Window_data& window_P ) const
     }
 
 
+bool Windowdef_list::match_classes( QStringList& classes_P ) const
+    {
+    classes_P.clear();
+    if( count() == 0 ) // matches everything, see match()
+        return false;
+    for( ConstIterator it(begin());
+         it != end();
+         ++it )
+        {
+        QString wclass;
+        if( !(*it)->exact_class( wclass ))
+            return false;
+        classes_P.append( wclass );
+        }
+    return true;
+    }
+
+
 void Windowdef_list::set_comment(const QString &comment)
     {
     _comment = comment;
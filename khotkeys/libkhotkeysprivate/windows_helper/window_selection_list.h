@@ -20,6 +20,7 @@
 #include "windows_helper/window_selection_interface.h"
 
 #include <QtCore/QList>
+#include <QtCore/QStringList>
 
 namespace KHotKeys {
 
@@ -36,6 +37,11 @@ class Q_DECL_EXPORT Windowdef_list : public QList< Windowdef* >
 
         void cfg_write( KConfigGroup& cfg_P ) const;
         bool match( const Window_data& window_P ) const;
+        /**
+         * Returns true and fills @p classes_P if only windows of these
+         * classes can match, false if windows of any class can.
+         */
+        bool match_classes( QStringList& classes_P ) const;
         Windowdef_list* copy( /*ActionDataBase* data_P*/ ) const;
         // typedef QList< Windowdef* >::iterator Iterator;
         void set_comment(const QString &comment);
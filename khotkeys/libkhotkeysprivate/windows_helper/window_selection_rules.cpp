@@ -15,7 +15,6 @@
    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
-#include "windows_helper/window_selection_rules.h"
 #include "windows_helper/window_selection_rules.h"
 
 #include <KLocalizedString>
@@ -40,7 +39,9 @@ Windowdef_simple::Windowdef_simple(
         _role( role_P ),
         _role_match_type( role_type_P ),
         _window_types( window_types_P )
-    {}
+    {
+    update_regexps();
+    }
 
 
 Windowdef_simple::Windowdef_simple( KConfigGroup& cfg_P )
@@ -53,6 +54,18 @@ Windowdef_simple::Windowdef_simple( KConfigGroup& cfg_P )
     _role = cfg_P.readEntry( "Role" );
     _role_match_type = static_cast< substr_type_t >( cfg_P.readEntry( "RoleType", 0 ));
     _window_types = cfg_P.readEntry( "WindowTypes",0 );
+    update_regexps();
+    }
+
+
+void Windowdef_simple::update_regexps()
+    {
+    _title_regexp = ( _title_match_type == REGEXP || _title_match_type == REGEXP_NOT )
+        ? QRegExp( _title ) : QRegExp();
+    _wclass_regexp = ( _wclass_match_type == REGEXP || _wclass_match_type == REGEXP_NOT )
+        ? QRegExp( _wclass ) : QRegExp();
+    _role_regexp = ( _role_match_type == REGEXP || _role_match_type == REGEXP_NOT )
+        ? QRegExp( _role ) : QRegExp();
     }
 
 
@@ -84,7 +97,7 @@ const QString Windowdef_simple::description() const
 
 
 bool Windowdef_simple::is_substr_match( const QString& str1_P, const QString& str2_P,
-    substr_type_t type_P )
+    substr_type_t type_P, const QRegExp& regexp_P ) const
     {
     switch( type_P )
         {
@@ -95,19 +108,13 @@ bool Windowdef_simple::is_substr_match( const QString& str1_P, const QString& st
         case IS :
           return str1_P == str2_P;
         case REGEXP :
-            {
-            QRegExp rg( str2_P );
-          return rg.indexIn( str1_P ) >= 0;
-            }
+          return regexp_P.indexIn( str1_P ) >= 0;
         case CONTAINS_NOT :
           return str1_P.contains( str2_P ) == 0;
         case IS_NOT :
           return str1_P != str2_P;
         case REGEXP_NOT :
-            {
-            QRegExp rg( str2_P );
-          return rg.indexIn( str1_P ) < 0;
-            }
+          return regexp_P.indexIn( str1_P ) < 0;
         }
     return false;
     }
@@ -117,17 +124,26 @@ bool Windowdef_simple::match( const Window_data& window_P )
     {
     if( !type_match( window_P.type ))
         return false;
-    if( !is_substr_match( window_P.title, title(), _title_match_type ))
+    if( !is_substr_match( window_P.wclass, wclass(), _wclass_match_type, _wclass_regexp ))
         return false;
-    if( !is_substr_match( window_P.wclass, wclass(), _wclass_match_type ))
+    if( !is_substr_match( window_P.title, title(), _title_match_type, _title_regexp ))
         return false;
-    if( !is_substr_match( window_P.role, role(), _role_match_type ))
+    if( !is_substr_match( window_P.role, role(), _role_match_type, _role_regexp ))
         return false;
     kDebug() << "window match:" << window_P.title << ":OK";
     return true;
     }
 
 
+bool Windowdef_simple::exact_class( QString& wclass_P ) const
+    {
+    if( _wclass_match_type != IS )
+        return false;
+    wclass_P = _wclass;
+    return true;
+    }
+
+
 const QString& Windowdef_simple::role() const
     {
     return _role;
@@ -143,24 +159,28 @@ Windowdef_simple::substr_type_t Windowdef_simple::role_match_type() const
 void Windowdef_simple::set_title(const QString &title)
     {
     _title = title;
+    update_regexps();
     }
 
 
 void Windowdef_simple::set_title_match_type(const substr_type_t &type)
     {
     _title_match_type = type;
+    update_regexps();
     }
 
 
 void Windowdef_simple::set_role(const QString &role)
     {
     _role = role;
+    update_regexps();
     }
 
 
 void Windowdef_simple::set_role_match_type(const substr_type_t &type)
     {
     _role_match_type = type;
+    update_regexps();
     }
 
 
@@ -173,12 +193,14 @@ void Windowdef_simple::set_window_types(const int types)
 void Windowdef_simple::set_wclass(const QString &wclass)
     {
     _wclass = wclass;
+    update_regexps();
     }
 
 
 void Windowdef_simple::set_wclass_match_type(const substr_type_t &type)
     {
     _wclass_match_type = type;
+    update_regexps();
     }
 
 
@@ -19,6 +19,8 @@
 
 #include "windows_helper/window_selection_interface.h"
 
+#include <QtCore/QRegExp>
+
 
 namespace KHotKeys {
 
@@ -80,6 +82,11 @@ class Q_DECL_EXPORT Windowdef_simple : public Windowdef
          */
         virtual bool match( const Window_data& window_P );
 
+        /**
+         * Only windows of class wclass() can match if it has to be IS
+         */
+        virtual bool exact_class( QString& wclass_P ) const;
+
         /**
          * Write to configuration file @p cfg_P
          */
@@ -155,10 +162,14 @@ class Q_DECL_EXPORT Windowdef_simple : public Windowdef
         bool is_substr_match(
                 const QString& str1_P,
                 const QString& str2_P,
-                substr_type_t type_P );
+                substr_type_t type_P,
+                const QRegExp& regexp_P ) const;
 
     private:
 
+        //! Compile the regular expressions once instead of on every match
+        void update_regexps();
+
         //! The title string
         QString _title;
 
@@ -179,6 +190,11 @@ class Q_DECL_EXPORT Windowdef_simple : public Windowdef
 
         //! Which window types to match
         int _window_types;
+
+        //! Compiled _title, _wclass and _role for the REGEXP match types
+        QRegExp _title_regexp;
+        QRegExp _wclass_regexp;
+        QRegExp _role_regexp;
     };
 
 
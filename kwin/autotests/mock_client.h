@@ -0,0 +1,98 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_MOCK_CLIENT_H
+#define KWIN_MOCK_CLIENT_H
+
+#include <QtGlobal>
+
+namespace KWin
+{
+
+/**
+ * Stand-in for the parts of Client the FocusChain uses.
+ **/
+class Client
+{
+public:
+    explicit Client(uint desktop = 1, int application = 0)
+        : m_desktop(desktop)
+        , m_application(application)
+        , m_screen(0)
+        , m_minimized(false)
+        , m_wantsTabFocus(true)
+    {
+    }
+
+    bool wantsTabFocus() const {
+        return m_wantsTabFocus;
+    }
+    void setWantsTabFocus(bool set) {
+        m_wantsTabFocus = set;
+    }
+    bool isOnAllDesktops() const {
+        return m_desktop == 0;
+    }
+    bool isOnDesktop(uint desktop) const {
+        return isOnAllDesktops() || m_desktop == desktop;
+    }
+    bool isOnCurrentDesktop() const {
+        return isOnDesktop(s_currentDesktop);
+    }
+    void setDesktop(uint desktop) {
+        m_desktop = desktop;
+    }
+    bool isOnCurrentActivity() const {
+        return true;
+    }
+    bool isMinimized() const {
+        return m_minimized;
+    }
+    void setMinimized(bool set) {
+        m_minimized = set;
+    }
+    bool isShown(bool shaded_is_shown) const {
+        Q_UNUSED(shaded_is_shown)
+        return !m_minimized;
+    }
+    int screen() const {
+        return m_screen;
+    }
+    bool isOnScreen(int screen) const {
+        return m_screen == screen;
+    }
+    void setScreen(int screen) {
+        m_screen = screen;
+    }
+    static bool belongToSameApplication(const Client *c1, const Client *c2, bool active_hack = false) {
+        Q_UNUSED(active_hack)
+        return c1->m_application == c2->m_application;
+    }
+
+    static uint s_currentDesktop;
+
+private:
+    uint m_desktop; // 0 for all desktops
+    int m_application;
+    int m_screen;
+    bool m_minimized;
+    bool m_wantsTabFocus;
+};
+
+}
+
+#endif
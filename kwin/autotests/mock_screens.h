@@ -0,0 +1,50 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_MOCK_SCREENS_H
+#define KWIN_MOCK_SCREENS_H
+
+namespace KWin
+{
+
+/**
+ * Stand-in for the parts of Screens the FocusChain uses.
+ **/
+class Screens
+{
+public:
+    Screens() : m_current(0) {}
+    int current() const {
+        return m_current;
+    }
+    void setCurrent(int current) {
+        m_current = current;
+    }
+    static Screens *self();
+private:
+    int m_current;
+};
+
+inline
+Screens *screens()
+{
+    return Screens::self();
+}
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+// KWin
+#include "../clientwindowindex.h"
+// Qt
+#include <QtTest/QtTest>
+// std
+#include <algorithm>
+
+using namespace KWin;
+
+/**
+ * Stand-in for the windows of a Client.
+ **/
+struct FakeClient
+{
+    xcb_window_t window;
+    xcb_window_t wrapper;
+    xcb_window_t frame;
+    xcb_window_t input;
+};
+
+class TestClientWindowIndex : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void find();
+    void noneIsIgnored();
+    void removeOnlyOwnWindow();
+    void benchmarkDispatch_data();
+    void benchmarkDispatch();
+
+private:
+    void createClients(int count);
+    void index(ClientWindowIndex<FakeClient> &index, FakeClient *c);
+    // the lookup Workspace::workspaceEvent() used before the index: up to four scans of all clients
+    FakeClient *findLinear(xcb_window_t w) const;
+
+    QList<FakeClient*> m_clients;
+};
+
+void TestClientWindowIndex::init()
+{
+    createClients(10);
+}
+
+void TestClientWindowIndex::cleanup()
+{
+    qDeleteAll(m_clients);
+    m_clients.clear();
+}
+
+void TestClientWindowIndex::createClients(int count)
+{
+    qDeleteAll(m_clients);
+    m_clients.clear();
+    // ids like the X server hands them out, each client's windows are created one after another
+    xcb_window_t id = 0x1000000;
+    for (int i = 0; i < count; ++i) {
+        FakeClient *c = new FakeClient;
+        c->window = id++;
+        c->wrapper = id++;
+        c->frame = id++;
+        // only decorated clients with an input extent have an input window
+        c->input = i % 2 ? id++ : XCB_WINDOW_NONE;
+        m_clients << c;
+    }
+}
+
+void TestClientWindowIndex::index(ClientWindowIndex<FakeClient> &index, FakeClient *c)
+{
+    index.insert(c->window, c, Predicate::WindowMatch);
+    index.insert(c->wrapper, c, Predicate::WrapperIdMatch);
+    index.insert(c->frame, c, Predicate::FrameIdMatch);
+    index.insert(c->input, c, Predicate::InputIdMatch);
+}
+
+FakeClient *TestClientWindowIndex::findLinear(xcb_window_t w) const
+{
+    auto it = std::find_if(m_clients.constBegin(), m_clients.constEnd(),
+                           [w](const FakeClient *c) { return c->window == w; });
+    if (it == m_clients.constEnd())
+        it = std::find_if(m_clients.constBegin(), m_clients.constEnd(),
+                          [w](const FakeClient *c) { return c->wrapper == w; });
+    if (it == m_clients.constEnd())
+        it = std::find_if(m_clients.constBegin(), m_clients.constEnd(),
+                          [w](const FakeClient *c) { return c->frame == w; });
+    if (it == m_clients.constEnd())
+        it = std::find_if(m_clients.constBegin(), m_clients.constEnd(),
+                          [w](const FakeClient *c) { return c->input == w; });
+    return it == m_clients.constEnd() ? nullptr : *it;
+}
+
+void TestClientWindowIndex::find()
+{
+    ClientWindowIndex<FakeClient> windows;
+    foreach (FakeClient *c, m_clients) {
+        index(windows, c);
+    }
+    foreach (FakeClient *c, m_clients) {
+        QCOMPARE(windows.find(c->window), c);
+        QCOMPARE(windows.find(c->frame), c);
+        QCOMPARE(windows.find(Predicate::WindowMatch, c->window), c);
+        QCOMPARE(windows.find(Predicate::WrapperIdMatch, c->wrapper), c);
+        QCOMPARE(windows.find(Predicate::FrameIdMatch, c->frame), c);
+        // a window only matches in its own role
+        QVERIFY(!windows.find(Predicate::WindowMatch, c->frame));
+        QVERIFY(!windows.find(Predicate::FrameIdMatch, c->wrapper));
+        QCOMPARE(windows.find(c->frame), findLinear(c->frame));
+    }
+    QVERIFY(!windows.find(0x42));
+}
+
+void TestClientWindowIndex::noneIsIgnored()
+{
+    ClientWindowIndex<FakeClient> windows;
+    FakeClient *c = m_clients.first();
+    QCOMPARE(c->input, xcb_window_t(XCB_WINDOW_NONE));
+    index(windows, c);
+    QCOMPARE(windows.count(), 3);
+    QVERIFY(!windows.find(XCB_WINDOW_NONE));
+}
+
+void TestClientWindowIndex::removeOnlyOwnWindow()
+{
+    ClientWindowIndex<FakeClient> windows;
+    FakeClient *first = m_clients.at(0);
+    FakeClient *second = m_clients.at(1);
+    index(windows, first);
+    index(windows, second);
+
+    // the id got reused for a window of the second client before the first one was released
+    windows.insert(first->frame, second, Predicate::InputIdMatch);
+    windows.remove(first->window, first);
+    windows.remove(first->wrapper, first);
+    windows.remove(first->frame, first);
+    QVERIFY(!windows.find(first->window));
+    QVERIFY(!windows.find(first->wrapper));
+    QCOMPARE(windows.find(Predicate::InputIdMatch, first->frame), second);
+    QCOMPARE(windows.find(second->frame), second);
+}
+
+void TestClientWindowIndex::benchmarkDispatch_data()
+{
+    QTest::addColumn<int>("clients");
+    QTest::addColumn<bool>("indexed");
+
+    QTest::newRow("10 linear") << 10 << false;
+    QTest::newRow("10 indexed") << 10 << true;
+    QTest::newRow("100 linear") << 100 << false;
+    QTest::newRow("100 indexed") << 100 << true;
+    QTest::newRow("1000 linear") << 1000 << false;
+    QTest::newRow("1000 indexed") << 1000 << true;
+}
+
+void TestClientWindowIndex::benchmarkDispatch()
+{
+    QFETCH(int, clients);
+    QFETCH(bool, indexed);
+    createClients(clients);
+    ClientWindowIndex<FakeClient> windows;
+    foreach (FakeClient *c, m_clients) {
+        index(windows, c);
+    }
+
+    // motion and crossing events mostly go to the frames and input windows, so most events
+    // are only found by the later scans of the old lookup
+    QVector<xcb_window_t> events;
+    foreach (FakeClient *c, m_clients) {
+        events << c->frame << (c->input != XCB_WINDOW_NONE ? c->input : c->wrapper);
+    }
+
+    FakeClient *found = nullptr;
+    QBENCHMARK {
+        for (xcb_window_t w : events) {
+            found = indexed ? windows.find(w) : findLinear(w);
+        }
+    }
+    QVERIFY(found);
+}
+
+QTEST_MAIN(TestClientWindowIndex)
+#include "test_client_window_index.moc"
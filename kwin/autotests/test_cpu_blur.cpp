@@ -0,0 +1,125 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+// KWin
+#include "../effects/blur/cpublur.h"
+// Qt
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+class TestCpuBlur : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void uniform_data();
+    void uniform();
+    void locality_data();
+    void locality();
+    void benchmarkMegapixel_data();
+    void benchmarkMegapixel();
+private:
+    QImage randomImage(const QSize &size) const;
+};
+
+void TestCpuBlur::initTestCase()
+{
+    qsrand(1);
+}
+
+QImage TestCpuBlur::randomImage(const QSize &size) const
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            const int alpha = qrand() % 256;
+            line[x] = qRgba(qrand() % (alpha + 1), qrand() % (alpha + 1), qrand() % (alpha + 1), alpha);
+        }
+    }
+    return image;
+}
+
+void TestCpuBlur::uniform_data()
+{
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("2") << 2;
+    QTest::newRow("6") << 6;
+    QTest::newRow("8") << 8;
+    QTest::newRow("14") << 14;
+}
+
+void TestCpuBlur::uniform()
+{
+    QFETCH(int, radius);
+    QImage image(QSize(37, 21), QImage::Format_ARGB32_Premultiplied);
+    image.fill(qRgba(40, 80, 120, 200));
+
+    const QImage blurred = CpuBlur(radius).blur(image);
+    QCOMPARE(blurred.size(), image.size());
+    QCOMPARE(blurred.format(), QImage::Format_ARGB32_Premultiplied);
+    QCOMPARE(blurred, image);
+}
+
+void TestCpuBlur::locality_data()
+{
+    uniform_data();
+}
+
+void TestCpuBlur::locality()
+{
+    // the effect relies on a pixel only depending on the pixels within the radius
+    QFETCH(int, radius);
+    const QImage image = randomImage(QSize(65, 63));
+    QImage changed = image;
+    const QPoint center(32, 31);
+    changed.setPixel(center, qRgba(255, 255, 255, 255));
+
+    const CpuBlur blur(radius);
+    const QImage a = blur.blur(image);
+    const QImage b = blur.blur(changed);
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            if (qAbs(x - center.x()) > radius || qAbs(y - center.y()) > radius) {
+                QCOMPARE(a.pixel(x, y), b.pixel(x, y));
+            }
+        }
+    }
+}
+
+void TestCpuBlur::benchmarkMegapixel_data()
+{
+    uniform_data();
+}
+
+void TestCpuBlur::benchmarkMegapixel()
+{
+    QFETCH(int, radius);
+    const QImage image = randomImage(QSize(1000, 1000));
+    const CpuBlur blur(radius);
+
+    QImage blurred;
+    QBENCHMARK {
+        blurred = blur.blur(image);
+    }
+    QCOMPARE(blurred.size(), image.size());
+}
+
+QTEST_GUILESS_MAIN(TestCpuBlur)
+#include "test_cpu_blur.moc"
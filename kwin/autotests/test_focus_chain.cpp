@@ -0,0 +1,220 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../focuschain.h"
+#include "mock_client.h"
+#include "mock_screens.h"
+
+#include <QtTest/QtTest>
+
+namespace KWin
+{
+
+uint Client::s_currentDesktop = 1;
+
+Screens *Screens::self()
+{
+    static Screens s_screens;
+    return &s_screens;
+}
+
+}
+
+using namespace KWin;
+
+class TestFocusChain : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testUpdateAppends();
+    void testUpdateInsertsBehindActive();
+    void testAllDesktops();
+    void testChangeDesktop();
+    void testNoTabFocus();
+    void testMakeFirstMinimized();
+    void testMakeLast();
+    void testNextMostRecentlyUsed();
+    void testMoveAfterClient();
+    void testRemove();
+    void testResize();
+private:
+    FocusChain *m_chain;
+};
+
+void TestFocusChain::init()
+{
+    Client::s_currentDesktop = 1;
+    m_chain = FocusChain::create(this);
+    m_chain->resize(0, 2);
+    m_chain->setCurrentDesktop(0, 1);
+}
+
+void TestFocusChain::cleanup()
+{
+    delete m_chain;
+    m_chain = nullptr;
+}
+
+void TestFocusChain::testUpdateAppends()
+{
+    Client c1, c2;
+    m_chain->update(&c1, FocusChain::Update);
+    m_chain->update(&c2, FocusChain::Update);
+    QVERIFY(m_chain->contains(&c1));
+    QVERIFY(m_chain->contains(&c1, 1));
+    QVERIFY(!m_chain->contains(&c1, 2));
+    // without an active client the last one becomes the most recently used
+    QCOMPARE(m_chain->getForActivation(1), &c2);
+    QCOMPARE(m_chain->firstMostRecentlyUsed(), &c1);
+}
+
+void TestFocusChain::testUpdateInsertsBehindActive()
+{
+    Client active, c1, c2;
+    m_chain->update(&active, FocusChain::MakeFirst);
+    m_chain->setActiveClient(&active);
+    m_chain->update(&c1, FocusChain::Update);
+    m_chain->update(&c2, FocusChain::Update);
+    // the active client stays the most recently used, the new ones follow it
+    QCOMPARE(m_chain->getForActivation(1), &active);
+    QCOMPARE(m_chain->nextForDesktop(&active, 1), &c2);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&active), &c2);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&c2), &c1);
+    // an update of a client in the chain doesn't move it
+    m_chain->update(&c1, FocusChain::Update);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&c2), &c1);
+}
+
+void TestFocusChain::testAllDesktops()
+{
+    Client c(0);
+    m_chain->update(&c, FocusChain::Update);
+    QVERIFY(m_chain->contains(&c, 1));
+    QVERIFY(m_chain->contains(&c, 2));
+    QCOMPARE(m_chain->getForActivation(2), &c);
+}
+
+void TestFocusChain::testChangeDesktop()
+{
+    Client c(0);
+    m_chain->update(&c, FocusChain::Update);
+    c.setDesktop(2);
+    m_chain->update(&c, FocusChain::Update);
+    QVERIFY(!m_chain->contains(&c, 1));
+    QVERIFY(m_chain->contains(&c, 2));
+    QVERIFY(!m_chain->getForActivation(1));
+}
+
+void TestFocusChain::testNoTabFocus()
+{
+    Client c;
+    m_chain->update(&c, FocusChain::Update);
+    QVERIFY(m_chain->contains(&c));
+    c.setWantsTabFocus(false);
+    m_chain->update(&c, FocusChain::Update);
+    QVERIFY(!m_chain->contains(&c));
+    QVERIFY(!m_chain->contains(&c, 1));
+}
+
+void TestFocusChain::testMakeFirstMinimized()
+{
+    Client minimized, c1, c2;
+    minimized.setMinimized(true);
+    m_chain->update(&minimized, FocusChain::Update);
+    m_chain->update(&c1, FocusChain::Update);
+    QCOMPARE(m_chain->getForActivation(1), &c1);
+
+    // a minimized client only becomes the most recently used of the minimized ones
+    c2.setMinimized(true);
+    m_chain->update(&c2, FocusChain::MakeFirst);
+    QCOMPARE(m_chain->getForActivation(1), &c1);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&c1), &c2);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&c2), &minimized);
+    QCOMPARE(m_chain->firstMostRecentlyUsed(), &minimized);
+}
+
+void TestFocusChain::testMakeLast()
+{
+    Client c1, c2;
+    m_chain->update(&c1, FocusChain::Update);
+    m_chain->update(&c2, FocusChain::Update);
+    m_chain->update(&c2, FocusChain::MakeLast);
+    QCOMPARE(m_chain->firstMostRecentlyUsed(), &c2);
+    QCOMPARE(m_chain->getForActivation(1), &c1);
+}
+
+void TestFocusChain::testNextMostRecentlyUsed()
+{
+    Client c1, c2, c3, outside;
+    QVERIFY(!m_chain->nextMostRecentlyUsed(&c1));
+    m_chain->update(&c1, FocusChain::Update);
+    m_chain->update(&c2, FocusChain::Update);
+    m_chain->update(&c3, FocusChain::Update);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&c3), &c2);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&c2), &c1);
+    // wraps around
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&c1), &c3);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&outside), &c3);
+}
+
+void TestFocusChain::testMoveAfterClient()
+{
+    Client reference(1, 1), other(1, 2), sameApplication(1, 1), c(1, 1);
+    m_chain->update(&other, FocusChain::Update);
+    m_chain->update(&reference, FocusChain::Update);
+    m_chain->update(&c, FocusChain::Update);
+    // same application as the reference: directly behind it
+    m_chain->moveAfterClient(&c, &reference);
+    QCOMPARE(m_chain->getForActivation(1), &reference);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&reference), &c);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&c), &other);
+
+    // otherwise behind the most recently used client of the reference's application
+    Client foreign(1, 3);
+    m_chain->update(&foreign, FocusChain::Update);
+    m_chain->moveAfterClient(&foreign, &other);
+    QCOMPARE(m_chain->nextMostRecentlyUsed(&other), &foreign);
+}
+
+void TestFocusChain::testRemove()
+{
+    Client c1(0), c2;
+    m_chain->update(&c1, FocusChain::Update);
+    m_chain->update(&c2, FocusChain::Update);
+    m_chain->remove(&c1);
+    QVERIFY(!m_chain->contains(&c1));
+    QVERIFY(!m_chain->contains(&c1, 1));
+    QVERIFY(!m_chain->contains(&c1, 2));
+    QVERIFY(!m_chain->getForActivation(2));
+    QCOMPARE(m_chain->firstMostRecentlyUsed(), &c2);
+}
+
+void TestFocusChain::testResize()
+{
+    Client c(0);
+    m_chain->resize(2, 3);
+    m_chain->update(&c, FocusChain::Update);
+    QVERIFY(m_chain->contains(&c, 3));
+    m_chain->resize(3, 1);
+    QVERIFY(!m_chain->contains(&c, 2));
+    QVERIFY(!m_chain->getForActivation(3));
+}
+
+QTEST_MAIN(TestFocusChain)
+#include "test_focus_chain.moc"
@@ -0,0 +1,145 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+// KWin
+#include "../paintredirector.h"
+// Qt
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+Q_DECLARE_METATYPE(QVector<QRect>)
+
+/**
+ * The decoration of a 1000x800 window with a 30 pixel title bar, in decoration relative coordinates,
+ * in the order of PaintRedirector::DecorationPixmap.
+ **/
+static const QRect s_borders[PaintRedirector::PixmapCount] = {
+    QRect(0, 0, 1008, 30),
+    QRect(1004, 30, 4, 800),
+    QRect(0, 830, 1008, 4),
+    QRect(0, 30, 4, 800)
+};
+
+class TestPaintRedirectorRegion : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void paintRegion();
+    void benchmarkRepaint_data();
+    void benchmarkRepaint();
+
+private:
+    // what gets uploaded or blitted to the decoration pixmaps for the damage
+    static QVector<QRect> dirtyRects(const QVector<QRect> &damage, bool perRect);
+};
+
+QVector<QRect> TestPaintRedirectorRegion::dirtyRects(const QVector<QRect> &damage, bool perRect)
+{
+    // PaintRedirector::addRepaint()
+    QRegion pending;
+    for (const QRect &rect : damage) {
+        pending |= rect;
+    }
+
+    QVector<QRect> dirty;
+    if (!perRect) {
+        // the bookkeeping before the damaged rects got painted on their own
+        for (int i = 0; i < PaintRedirector::PixmapCount; ++i) {
+            const QRect rect = (pending & s_borders[i]).boundingRect();
+            if (!rect.isEmpty()) {
+                dirty << rect;
+            }
+        }
+        return dirty;
+    }
+    // PaintRedirector::performPendingPaint() and updatePixmaps()
+    const QRegion region = PaintRedirector::paintRegion(pending);
+    for (int i = 0; i < PaintRedirector::PixmapCount; ++i) {
+        dirty << (region & s_borders[i]).rects();
+    }
+    return dirty;
+}
+
+static QVector<QRect> buttons(int count)
+{
+    QVector<QRect> rects;
+    for (int i = 0; i < count; ++i) {
+        rects << QRect(5 + i * 22, 5, 20, 20);
+    }
+    return rects;
+}
+
+void TestPaintRedirectorRegion::paintRegion()
+{
+    // up to eight rects are repainted on their own
+    QRegion damage;
+    for (const QRect &rect : buttons(PaintRedirector::MaxPendingRects)) {
+        damage |= rect;
+    }
+    QCOMPARE(PaintRedirector::paintRegion(damage), damage);
+
+    damage |= QRect(500, 5, 20, 20);
+    QCOMPARE(PaintRedirector::paintRegion(damage), QRegion(damage.boundingRect()));
+    QCOMPARE(PaintRedirector::paintRegion(QRegion()), QRegion());
+}
+
+void TestPaintRedirectorRegion::benchmarkRepaint_data()
+{
+    QTest::addColumn<QVector<QRect> >("damage");
+    QTest::addColumn<bool>("perRect");
+
+    const QRect caption(300, 5, 400, 20);
+    const QVector<QRect> hover = QVector<QRect>() << QRect(5, 5, 20, 20) << QRect(983, 5, 20, 20);
+    const QVector<QRect> activation = QVector<QRect>() << caption << buttons(2) << QRect(939, 5, 64, 20);
+    // e.g. a client group, more rects than get painted on their own
+    QVector<QRect> tabs;
+    for (int i = 0; i < 12; ++i) {
+        tabs << QRect(100 + i * 70, 5, 60, 20);
+    }
+
+    QTest::newRow("caption bounding") << (QVector<QRect>() << caption) << false;
+    QTest::newRow("caption rects") << (QVector<QRect>() << caption) << true;
+    QTest::newRow("hover bounding") << hover << false;
+    QTest::newRow("hover rects") << hover << true;
+    QTest::newRow("activation bounding") << activation << false;
+    QTest::newRow("activation rects") << activation << true;
+    QTest::newRow("tabs bounding") << tabs << false;
+    QTest::newRow("tabs rects") << tabs << true;
+}
+
+void TestPaintRedirectorRegion::benchmarkRepaint()
+{
+    QFETCH(QVector<QRect>, damage);
+    QFETCH(bool, perRect);
+
+    QVector<QRect> dirty;
+    QBENCHMARK {
+        dirty = dirtyRects(damage, perRect);
+    }
+
+    // the pixels that get uploaded or blitted, which the bookkeeping has to pay for
+    int pixels = 0;
+    for (const QRect &rect : dirty) {
+        pixels += rect.width() * rect.height();
+    }
+    qDebug() << dirty.count() << "rects," << pixels << "pixels";
+    QVERIFY(dirty.count() <= PaintRedirector::MaxPendingRects);
+}
+
+QTEST_MAIN(TestPaintRedirectorRegion)
+#include "test_paint_redirector_region.moc"
@@ -0,0 +1,226 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+// KWin
+#include "../stackingorder.h"
+// Qt
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+class TestStackingOrder : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void noTransients();
+    void transientBelowMainWindow();
+    void transientAboveMainWindow();
+    void siblingTransients();
+    void nestedTransients();
+    void multipleMainWindows();
+    void loop();
+    void restackDelta_data();
+    void restackDelta();
+    void restackDeltaFixed();
+    void benchmarkGroupTransients_data();
+    void benchmarkGroupTransients();
+private:
+    QVector<int> identity(int count) const;
+};
+
+QVector<int> TestStackingOrder::identity(int count) const
+{
+    QVector<int> order(count);
+    for (int i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    return order;
+}
+
+void TestStackingOrder::noTransients()
+{
+    QCOMPARE(TransientStacking(0).order(), QVector<int>());
+    QCOMPARE(TransientStacking(5).order(), identity(5));
+}
+
+void TestStackingOrder::transientBelowMainWindow()
+{
+    TransientStacking stacking(4);
+    stacking.addMainWindow(0, 2);
+    QCOMPARE(stacking.order(), QVector<int>() << 1 << 2 << 0 << 3);
+}
+
+void TestStackingOrder::transientAboveMainWindow()
+{
+    // a transient already above its main window is not moved down to it
+    TransientStacking stacking(4);
+    stacking.addMainWindow(3, 1);
+    QCOMPARE(stacking.order(), identity(4));
+}
+
+void TestStackingOrder::siblingTransients()
+{
+    TransientStacking stacking(5);
+    stacking.addMainWindow(0, 3);
+    stacking.addMainWindow(2, 3);
+    QCOMPARE(stacking.order(), QVector<int>() << 1 << 3 << 0 << 2 << 4);
+}
+
+void TestStackingOrder::nestedTransients()
+{
+    // 1 is transient for 3, 2 is transient for 1: once 1 moves above 3, 2 has to follow it
+    TransientStacking stacking(5);
+    stacking.addMainWindow(1, 3);
+    stacking.addMainWindow(2, 1);
+    QCOMPARE(stacking.order(), QVector<int>() << 0 << 3 << 1 << 2 << 4);
+
+    // the transients of the transient stay below the transient's siblings
+    TransientStacking siblings(5);
+    siblings.addMainWindow(0, 4);
+    siblings.addMainWindow(1, 4);
+    siblings.addMainWindow(2, 0);
+    QCOMPARE(siblings.order(), QVector<int>() << 3 << 4 << 0 << 2 << 1);
+}
+
+void TestStackingOrder::multipleMainWindows()
+{
+    // a group transient goes above the topmost of its main windows
+    TransientStacking stacking(5);
+    stacking.addMainWindow(0, 1);
+    stacking.addMainWindow(0, 3);
+    QCOMPARE(stacking.order(), QVector<int>() << 1 << 2 << 3 << 0 << 4);
+
+    // the topmost main window is determined after moving the main windows themselves
+    TransientStacking moved(5);
+    moved.addMainWindow(1, 4);
+    moved.addMainWindow(0, 1);
+    moved.addMainWindow(0, 3);
+    QCOMPARE(moved.order(), QVector<int>() << 2 << 3 << 4 << 1 << 0);
+}
+
+void TestStackingOrder::loop()
+{
+    TransientStacking stacking(3);
+    stacking.addMainWindow(0, 2);
+    stacking.addMainWindow(2, 0);
+    stacking.addMainWindow(1, 1);
+    const QVector<int> order = stacking.order();
+    QCOMPARE(order.count(), 3);
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(order.contains(i));
+    }
+}
+
+void TestStackingOrder::restackDelta_data()
+{
+    QTest::addColumn<QVector<int> >("previous");
+    QTest::addColumn<QVector<int> >("stack");
+    QTest::addColumn<QVector<int> >("expected");
+
+    QTest::newRow("unchanged") << (QVector<int>() << 0 << 1 << 2 << 3)
+                               << (QVector<int>() << 0 << 1 << 2 << 3)
+                               << QVector<int>();
+    QTest::newRow("raise") << (QVector<int>() << 0 << 1 << 2 << 3 << 4)
+                           << (QVector<int>() << 0 << 3 << 1 << 2 << 4)
+                           << (QVector<int>() << 1);
+    QTest::newRow("lower") << (QVector<int>() << 0 << 1 << 2 << 3 << 4)
+                           << (QVector<int>() << 0 << 2 << 3 << 4 << 1)
+                           << (QVector<int>() << 4);
+    QTest::newRow("new") << (QVector<int>() << 0 << 1 << 2)
+                         << (QVector<int>() << 0 << 1 << 5 << 2)
+                         << (QVector<int>() << 2);
+    QTest::newRow("removed") << (QVector<int>() << 0 << 1 << 2 << 3)
+                             << (QVector<int>() << 0 << 1 << 3)
+                             << QVector<int>();
+    // raising a main window together with its transient
+    QTest::newRow("block") << (QVector<int>() << 0 << 1 << 2 << 3 << 4)
+                           << (QVector<int>() << 0 << 3 << 4 << 1 << 2)
+                           << (QVector<int>() << 1 << 2);
+    QTest::newRow("block below") << (QVector<int>() << 0 << 1 << 2 << 3 << 4 << 5)
+                                 << (QVector<int>() << 0 << 3 << 1 << 2 << 5 << 4)
+                                 << (QVector<int>() << 1 << 4);
+    QTest::newRow("reversed") << (QVector<int>() << 0 << 1 << 2 << 3)
+                              << (QVector<int>() << 0 << 3 << 2 << 1)
+                              << (QVector<int>() << 1 << 2);
+}
+
+void TestStackingOrder::restackDelta()
+{
+    QFETCH(QVector<int>, previous);
+    QFETCH(QVector<int>, stack);
+    QFETCH(QVector<int>, expected);
+    const QVector<int> delta = KWin::restackDelta(previous, stack);
+    QCOMPARE(delta, expected);
+
+    // simulate the restacking on the previous stack, without the windows which are gone
+    QList<int> simulated;
+    for (int window : previous) {
+        if (stack.contains(window)) {
+            simulated << window;
+        }
+    }
+    for (int i : delta) {
+        simulated.removeOne(stack.at(i));
+        simulated.insert(simulated.indexOf(stack.at(i - 1)) + 1, stack.at(i));
+    }
+    for (int i = 1; i < stack.count(); ++i) {
+        QCOMPARE(simulated.indexOf(stack.at(i)), simulated.indexOf(stack.at(i - 1)) + 1);
+    }
+}
+
+void TestStackingOrder::restackDeltaFixed()
+{
+    const QVector<int> stack = QVector<int>() << 0 << 1 << 2 << 3 << 4;
+    QCOMPARE(KWin::restackDelta(stack, stack, 2), QVector<int>() << 1 << 2);
+}
+
+void TestStackingOrder::benchmarkGroupTransients_data()
+{
+    QTest::addColumn<int>("windows");
+    QTest::addColumn<int>("transients");
+
+    QTest::newRow("20/40") << 20 << 40;
+    QTest::newRow("200/40") << 200 << 40;
+    QTest::newRow("200/400") << 200 << 400;
+}
+
+void TestStackingOrder::benchmarkGroupTransients()
+{
+    // group transients with a dialog each at the bottom, which all have to move above the
+    // topmost of four main windows, like when raising a group of dialogs
+    QFETCH(int, windows);
+    QFETCH(int, transients);
+    const int mainWindows = 4;
+    const int count = windows + 2 * transients;
+
+    QVector<int> order;
+    QBENCHMARK {
+        TransientStacking stacking(count);
+        for (int i = 0; i < transients; ++i) {
+            const int transient = 2 * i;
+            for (int j = 0; j < mainWindows; ++j) {
+                stacking.addMainWindow(transient, 2 * transients + j * windows / mainWindows);
+            }
+            stacking.addMainWindow(transient + 1, transient);
+        }
+        order = stacking.order();
+    }
+    QCOMPARE(order.count(), count);
+}
+
+QTEST_MAIN(TestStackingOrder)
+#include "test_stacking_order.moc"
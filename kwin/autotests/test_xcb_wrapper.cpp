@@ -23,6 +23,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Qt
 #include <QApplication>
 #include <QtTest/QtTest>
+// STL
+#include <vector>
 // xcb
 #include <xcb/xcb.h>
 
@@ -44,6 +46,11 @@ private Q_SLOTS:
     void assignmentBeforeRetrieve();
     void assignmentAfterRetrieve();
     void discard();
+    void property();
+    void propertyMove();
+    void wmHints();
+    void benchmarkPropertyFetch_data();
+    void benchmarkPropertyFetch();
 private:
     void testEmpty(WindowGeometry &geometry);
     void testGeometry(WindowGeometry &geometry, const QRect &rect);
@@ -210,5 +217,123 @@ void TestXcbWrapper::discard()
     delete geometry;
 }
 
+void TestXcbWrapper::property()
+{
+    m_testWindow = createWindow();
+    QVERIFY(m_testWindow != noneWindow());
+    const QByteArray data = QByteArrayLiteral("foo");
+    xcb_change_property(connection(), XCB_PROP_MODE_REPLACE, m_testWindow, XCB_ATOM_WM_NAME, XCB_ATOM_STRING,
+                        8, data.length(), data.constData());
+
+    Property prop(m_testWindow, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 100);
+    QVERIFY(!prop.isRetrieved());
+    QCOMPARE(prop.window(), m_testWindow);
+    QCOMPARE(prop.toByteArray(), data);
+    QVERIFY(prop.isRetrieved());
+    // wrong format
+    QVERIFY(!prop.value<const uint32_t>(32));
+
+    // wrong type
+    Property wrongType(m_testWindow, XCB_ATOM_WM_NAME, XCB_ATOM_CARDINAL, 100);
+    QVERIFY(wrongType.toByteArray().isNull());
+
+    // not set
+    Property notSet(m_testWindow, XCB_ATOM_WM_ICON_NAME, XCB_ATOM_STRING, 100);
+    QVERIFY(notSet.toByteArray().isNull());
+
+    Property empty;
+    QVERIFY(empty.isNull());
+    QVERIFY(empty.toByteArray().isNull());
+}
+
+void TestXcbWrapper::propertyMove()
+{
+    m_testWindow = createWindow();
+    QVERIFY(m_testWindow != noneWindow());
+    const uint32_t values[] = { 1, 2, 3 };
+    xcb_change_property(connection(), XCB_PROP_MODE_REPLACE, m_testWindow, XCB_ATOM_WM_NAME, XCB_ATOM_CARDINAL,
+                        32, 3, values);
+
+    Property prop(m_testWindow, XCB_ATOM_WM_NAME, XCB_ATOM_CARDINAL, 100);
+    Property other(std::move(prop));
+    QVERIFY(prop.isRetrieved());
+    QCOMPARE(prop.window(), noneWindow());
+    QVERIFY(prop.isNull());
+
+    QVERIFY(!other.isRetrieved());
+    uint32_t count = 0;
+    const uint32_t *data = other.value<const uint32_t>(32, &count);
+    QVERIFY(data);
+    QCOMPARE(count, 3u);
+    QCOMPARE(data[0], 1u);
+    QCOMPARE(data[2], 3u);
+}
+
+void TestXcbWrapper::wmHints()
+{
+    m_testWindow = createWindow();
+    QVERIFY(m_testWindow != noneWindow());
+
+    WMHints notSet(m_testWindow);
+    QCOMPARE(notSet.input(), true);
+    QCOMPARE(notSet.isInitiallyIconic(), false);
+    QCOMPARE(notSet.windowGroup(), noneWindow());
+    QCOMPARE(notSet.urgency(), false);
+
+    // flags: input, state, window group and urgency
+    const uint32_t hints[] = { 1 | 2 | 64 | 256, 0, 3, 0, 0, 0, 0, 0, m_testWindow };
+    xcb_change_property(connection(), XCB_PROP_MODE_REPLACE, m_testWindow, XCB_ATOM_WM_HINTS, XCB_ATOM_WM_HINTS,
+                        32, 9, hints);
+    WMHints set(m_testWindow);
+    QCOMPARE(set.input(), false);
+    QCOMPARE(set.isInitiallyIconic(), true);
+    QCOMPARE(set.windowGroup(), m_testWindow);
+    QCOMPARE(set.urgency(), true);
+}
+
+void TestXcbWrapper::benchmarkPropertyFetch_data()
+{
+    QTest::addColumn<bool>("pipelined");
+
+    QTest::newRow("sequential") << false;
+    QTest::newRow("pipelined") << true;
+}
+
+void TestXcbWrapper::benchmarkPropertyFetch()
+{
+    // reads the same number of properties Client::manage() prefetches for a batch of windows
+    const int windowCount = 50;
+    const int propertyCount = 10;
+    QFETCH(bool, pipelined);
+    QVector<xcb_window_t> windows;
+    for (int i = 0; i < windowCount; ++i) {
+        windows << createWindow();
+    }
+    xcb_flush(connection());
+
+    QBENCHMARK {
+        for (xcb_window_t window : windows) {
+            if (pipelined) {
+                std::vector<Property> props;
+                props.reserve(propertyCount);
+                for (int i = 0; i < propertyCount; ++i) {
+                    props.emplace_back(window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 100);
+                }
+                for (Property &prop : props) {
+                    prop.toByteArray();
+                }
+            } else {
+                for (int i = 0; i < propertyCount; ++i) {
+                    Property(window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 100).toByteArray();
+                }
+            }
+        }
+    }
+
+    for (xcb_window_t window : windows) {
+        xcb_destroy_window(connection(), window);
+    }
+}
+
 KWIN_TEST_MAIN(TestXcbWrapper)
 #include "test_xcb_wrapper.moc"
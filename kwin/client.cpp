@@ -90,15 +90,15 @@ public:
     // property.  If it explicitly requests that decorations be shown
     // or hidden, 'got_noborder' is set to true and 'noborder' is set
     // appropriately.
-    static void readFlags(xcb_window_t w, bool& got_noborder, bool& noborder,
+    static void readFlags(Xcb::Property &prop, bool& got_noborder, bool& noborder,
                           bool& resize, bool& move, bool& minimize, bool& maximize,
                           bool& close);
     struct MwmHints {
-        ulong flags;
-        ulong functions;
-        ulong decorations;
-        long input_mode;
-        ulong status;
+        uint32_t flags;
+        uint32_t functions;
+        uint32_t decorations;
+        int32_t input_mode;
+        uint32_t status;
     };
     enum {
         MWM_HINTS_FUNCTIONS = (1L << 0),
@@ -113,20 +113,13 @@ public:
     };
 };
 
-void Motif::readFlags(xcb_window_t w, bool& got_noborder, bool& noborder,
+void Motif::readFlags(Xcb::Property &prop, bool& got_noborder, bool& noborder,
                       bool& resize, bool& move, bool& minimize, bool& maximize, bool& close)
 {
-    Atom type;
-    int format;
-    unsigned long length, after;
-    unsigned char* data;
-    MwmHints* hints = 0;
-    if (XGetWindowProperty(display(), w, atoms->motif_wm_hints, 0, 5,
-                          false, atoms->motif_wm_hints, &type, &format,
-                          &length, &after, &data) == Success) {
-        if (data)
-            hints = (MwmHints*) data;
-    }
+    uint32_t length = 0;
+    const MwmHints* hints = reinterpret_cast<const MwmHints*>(prop.value<const uint32_t>(32, &length));
+    if (length < sizeof(MwmHints) / sizeof(uint32_t))
+        hints = 0;
     got_noborder = false;
     noborder = false;
     resize = true;
@@ -155,7 +148,6 @@ void Motif::readFlags(xcb_window_t w, bool& got_noborder, bool& noborder,
             got_noborder = true;
             noborder = !hints->decorations;
         }
-        XFree(data);
     }
 }
 
@@ -231,6 +223,8 @@ Client::Client()
 #endif
     , m_decoInputExtent()
     , m_focusOutTimer(nullptr)
+    , m_propertyFetchTimer(nullptr)
+    , m_pendingPropertyFetches(0)
     , m_palette(QApplication::palette())
 {
     // TODO: Do all as initialization
@@ -467,7 +461,10 @@ void Client::updateInputWindow()
     }
 
     if (region.isEmpty()) {
+        const xcb_window_t oldInputWindow = m_decoInputExtent;
         m_decoInputExtent.reset();
+        if (oldInputWindow != XCB_WINDOW_NONE)
+            workspace()->clientInputWindowChanged(this, oldInputWindow);
         return;
     }
 
@@ -490,6 +487,7 @@ void Client::updateInputWindow()
             XCB_EVENT_MASK_POINTER_MOTION
         };
         m_decoInputExtent.create(bounds, XCB_WINDOW_CLASS_INPUT_ONLY, mask, values);
+        workspace()->clientInputWindowChanged(this, XCB_WINDOW_NONE);
         if (mapping_state == Mapped)
             m_decoInputExtent.map();
     } else {
@@ -585,7 +583,10 @@ void Client::destroyDecoration()
             emit geometryShapeChanged(this, oldgeom);
         }
     }
+    const xcb_window_t oldInputWindow = m_decoInputExtent;
     m_decoInputExtent.reset();
+    if (oldInputWindow != XCB_WINDOW_NONE)
+        workspace()->clientInputWindowChanged(this, oldInputWindow);
 }
 
 bool Client::checkBorderSizes(bool also_resize)
@@ -2035,27 +2036,40 @@ void Client::setClientShown(bool shown)
 
 void Client::getWMHints()
 {
-    XWMHints* hints = XGetWMHints(display(), window());
-    input = true;
-    m_windowGroup = XCB_WINDOW_NONE;
-    urgency = false;
-    if (hints) {
-        if (hints->flags & InputHint)
-            input = hints->input;
-        if (hints->flags & WindowGroupHint)
-            m_windowGroup = hints->window_group;
-        urgency = !!(hints->flags & UrgencyHint);   // Need boolean, it's a uint bitfield
-        XFree((char*)hints);
-    }
+    Xcb::WMHints hints = fetchWMHints();
+    readWMHints(hints);
+}
+
+Xcb::WMHints Client::fetchWMHints() const
+{
+    return Xcb::WMHints(window());
+}
+
+void Client::readWMHints(Xcb::WMHints &hints)
+{
+    input = hints.input();
+    m_windowGroup = hints.windowGroup();
+    urgency = hints.urgency();
     checkGroup();
     updateUrgency();
     updateAllowedActions(); // Group affects isMinimizable()
 }
 
 void Client::getMotifHints()
+{
+    Xcb::Property prop = fetchMotifHints();
+    readMotifHints(prop);
+}
+
+Xcb::Property Client::fetchMotifHints() const
+{
+    return Xcb::Property(m_client, atoms->motif_wm_hints, atoms->motif_wm_hints, 5);
+}
+
+void Client::readMotifHints(Xcb::Property &prop)
 {
     bool mgot_noborder, mnoborder, mresize, mmove, mminimize, mmaximize, mclose;
-    Motif::readFlags(m_client, mgot_noborder, mnoborder, mresize, mmove, mminimize, mmaximize, mclose);
+    Motif::readFlags(prop, mgot_noborder, mnoborder, mresize, mmove, mminimize, mmaximize, mclose);
     if (mgot_noborder && motif_noborder != mnoborder) {
         motif_noborder = mnoborder;
         // If we just got a hint telling us to hide decorations, we do so.
@@ -2126,45 +2140,57 @@ void Client::getIcons()
 
 void Client::getWindowProtocols()
 {
-    Atom* p;
-    int i, n;
+    Xcb::Property prop = fetchWindowProtocols();
+    readWindowProtocols(prop);
+}
+
+Xcb::Property Client::fetchWindowProtocols() const
+{
+    return Xcb::Property(window(), atoms->wm_protocols, XCB_ATOM_ATOM, 1024);
+}
 
+void Client::readWindowProtocols(Xcb::Property &prop)
+{
     Pdeletewindow = 0;
     Ptakefocus = 0;
     Pcontexthelp = 0;
     Pping = 0;
 
-    if (XGetWMProtocols(display(), window(), &p, &n)) {
-        for (i = 0; i < n; ++i) {
-            if (p[i] == atoms->wm_delete_window)
-                Pdeletewindow = 1;
-            else if (p[i] == atoms->wm_take_focus)
-                Ptakefocus = 1;
-            else if (p[i] == atoms->net_wm_context_help)
-                Pcontexthelp = 1;
-            else if (p[i] == atoms->net_wm_ping)
-                Pping = 1;
-        }
-        if (n > 0)
-            XFree(p);
+    uint32_t n = 0;
+    const xcb_atom_t *p = prop.value<const xcb_atom_t>(32, &n);
+    for (uint32_t i = 0; i < n; ++i) {
+        if (p[i] == atoms->wm_delete_window)
+            Pdeletewindow = 1;
+        else if (p[i] == atoms->wm_take_focus)
+            Ptakefocus = 1;
+        else if (p[i] == atoms->net_wm_context_help)
+            Pcontexthelp = 1;
+        else if (p[i] == atoms->net_wm_ping)
+            Pping = 1;
     }
 }
 
 void Client::getSyncCounter()
+{
+    Xcb::Property prop = fetchSyncCounter();
+    readSyncCounter(prop);
+}
+
+Xcb::Property Client::fetchSyncCounter() const
 {
     if (!Xcb::Extensions::self()->isSyncAvailable())
-        return;
+        return Xcb::Property();
+    return Xcb::Property(window(), atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 1);
+}
 
-    Atom retType;
-    unsigned long nItemRet;
-    unsigned long byteRet;
-    int formatRet;
-    unsigned char* propRet;
-    int ret = XGetWindowProperty(display(), window(), atoms->net_wm_sync_request_counter,
-                                 0, 1, false, XCB_ATOM_CARDINAL, &retType, &formatRet, &nItemRet, &byteRet, &propRet);
+void Client::readSyncCounter(Xcb::Property &prop)
+{
+    if (!Xcb::Extensions::self()->isSyncAvailable())
+        return;
 
-    if (ret == Success && formatRet == 32) {
-        syncRequest.counter = *(xcb_sync_counter_t*)(propRet);
+    const xcb_sync_counter_t *counter = prop.value<const xcb_sync_counter_t>();
+    if (counter) {
+        syncRequest.counter = *counter;
         syncRequest.value.hi = 0;
         syncRequest.value.lo = 0;
         auto *c = connection();
@@ -2190,9 +2216,6 @@ void Client::getSyncCounter()
             }
         }
     }
-
-    if (ret == Success)
-        XFree(propRet);
 }
 
 /**
@@ -23,12 +23,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_CLIENT_H
 
 // kwin
+#include "clientwindowindex.h"
 #include "options.h"
 #include "rules.h"
 #include "tabgroup.h"
 #include "toplevel.h"
 #include "xcbutils.h"
 // Qt
+#include <QElapsedTimer>
 #include <QPixmap>
 #include <QWindow>
 // X
@@ -55,19 +57,6 @@ class TabBoxClientImpl;
 class Bridge;
 class PaintRedirector;
 
-
-/**
- * @brief Defines Predicates on how to search for a Client.
- *
- * Used by Workspace::findClient.
- */
-enum class Predicate {
-    WindowMatch,
-    WrapperIdMatch,
-    FrameIdMatch,
-    InputIdMatch
-};
-
 class Client
     : public Toplevel
 {
@@ -690,6 +679,29 @@ private:
     Position mousePosition(const QPoint&) const;
     void updateCursor();
 
+    /**
+     * Properties which changed on the client window and still need to be read.
+     **/
+    enum PropertyFetch {
+        FetchNormalHints = 1 << 0,
+        FetchName = 1 << 1,
+        FetchIconicName = 1 << 2,
+        FetchTransient = 1 << 3,
+        FetchWMHints = 1 << 4,
+        FetchIcons = 1 << 5,
+        FetchWindowProtocols = 1 << 6,
+        FetchMotifHints = 1 << 7,
+        FetchSyncCounter = 1 << 8,
+        FetchCaption = FetchName | FetchIconicName
+    };
+    /**
+     * Marks the @p fetches as dirty. They are read together once the current batch of
+     * events has been processed, caption changes at most every CAPTION_UPDATE_INTERVAL ms.
+     * Map and configure requests read the pending properties other than the caption first.
+     **/
+    void schedulePropertyFetch(uint fetches);
+    void fetchPendingProperties();
+
     // Handlers for X11 events
     bool mapRequestEvent(xcb_map_request_event_t *e);
     void unmapNotifyEvent(xcb_unmap_notify_event_t *e);
@@ -795,6 +807,8 @@ private:
     void updateFullScreenHack(const QRect& geom);
     void getWmNormalHints();
     void getMotifHints();
+    Xcb::Property fetchMotifHints() const;
+    void readMotifHints(Xcb::Property &prop);
     void getIcons();
     void fetchName();
     void fetchIconicName();
@@ -809,6 +823,8 @@ private:
     int checkShadeGeometry(int w, int h);
     void blockGeometryUpdates(bool block);
     void getSyncCounter();
+    Xcb::Property fetchSyncCounter() const;
+    void readSyncCounter(Xcb::Property &prop);
     void sendSyncRequest();
     bool startMoveResize();
     void finishMoveResize(bool cancel);
@@ -898,6 +914,8 @@ private:
     int quick_tile_mode;
 
     void readTransient();
+    Xcb::TransientFor fetchTransient() const;
+    void readTransientProperty(Xcb::TransientFor &transientFor);
     xcb_window_t verifyTransientFor(xcb_window_t transient_for, bool set);
     void addTransient(Client* cl);
     void removeTransient(Client* cl);
@@ -939,7 +957,11 @@ private:
     bool blocks_compositing;
     WindowRules client_rules;
     void getWMHints();
+    Xcb::WMHints fetchWMHints() const;
+    void readWMHints(Xcb::WMHints &hints);
     void getWindowProtocols();
+    Xcb::Property fetchWindowProtocols() const;
+    void readWindowProtocols(Xcb::Property &prop);
     QIcon m_icon;
     Qt::CursorShape m_cursor;
     // DON'T reorder - Saved to config files !!!
@@ -1014,6 +1036,9 @@ private:
     QPoint input_offset;
 
     QTimer *m_focusOutTimer;
+    QTimer *m_propertyFetchTimer;
+    uint m_pendingPropertyFetches;
+    QElapsedTimer m_lastCaptionUpdate;
 
     QPalette m_palette;
     QList<QMetaObject::Connection> m_connections;
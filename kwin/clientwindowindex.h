@@ -0,0 +1,111 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_CLIENTWINDOWINDEX_H
+#define KWIN_CLIENTWINDOWINDEX_H
+
+#include <QHash>
+
+#include <xcb/xcb.h>
+
+namespace KWin
+{
+
+/**
+ * @brief Defines Predicates on how to search for a Client.
+ *
+ * Used by Workspace::findClient.
+ */
+enum class Predicate {
+    WindowMatch,
+    WrapperIdMatch,
+    FrameIdMatch,
+    InputIdMatch
+};
+
+/**
+ * @brief Maps the windows of the managed clients to their client.
+ *
+ * Every client owns up to four windows: the client window itself, the wrapper, the frame and
+ * the input window of the decoration. Each of them is stored with the role it has for its client,
+ * so that mapping the window of an X event to the client doesn't need to walk all clients.
+ *
+ * The client type is a template parameter so that the index can be benchmarked without a Workspace.
+ **/
+template <typename T>
+class ClientWindowIndex
+{
+public:
+    /**
+     * Stores @p w as the window of @p client with the given @p role. XCB_WINDOW_NONE is ignored.
+     **/
+    void insert(xcb_window_t w, T *client, Predicate role) {
+        if (w == XCB_WINDOW_NONE) {
+            return;
+        }
+        Entry entry;
+        entry.client = client;
+        entry.role = role;
+        m_windows.insert(w, entry);
+    }
+    /**
+     * Removes @p w, unless it got indexed for another client than @p client in the meantime.
+     **/
+    void remove(xcb_window_t w, const T *client) {
+        const auto it = m_windows.find(w);
+        if (it != m_windows.end() && it->client == client) {
+            m_windows.erase(it);
+        }
+    }
+    /**
+     * @returns The client owning @p w in any role or @c null
+     **/
+    T *find(xcb_window_t w) const {
+        const auto it = m_windows.constFind(w);
+        return it == m_windows.constEnd() ? nullptr : it->client;
+    }
+    /**
+     * @returns The client owning @p w in the given @p role or @c null
+     **/
+    T *find(Predicate role, xcb_window_t w) const {
+        const auto it = m_windows.constFind(w);
+        if (it == m_windows.constEnd() || it->role != role) {
+            return nullptr;
+        }
+        return it->client;
+    }
+    bool contains(xcb_window_t w, const T *client) const {
+        return find(w) == client;
+    }
+    int count() const {
+        return m_windows.count();
+    }
+    void clear() {
+        m_windows.clear();
+    }
+
+private:
+    struct Entry {
+        T *client;
+        Predicate role;
+    };
+    QHash<xcb_window_t, Entry> m_windows;
+};
+
+} // namespace
+
+#endif
@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "cursor.h"
 // kwin
+#include <config-kwin.h>
 #include <kwinglobals.h>
 #include "input.h"
 #include "main.h"
@@ -29,9 +30,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KConfigGroup>
 #include <KSharedConfig>
 // Qt
+#include <QAbstractNativeEventFilter>
+#include <QCoreApplication>
 #include <QTimer>
 // Xlib
 #include <X11/Xcursor/Xcursor.h>
+#if HAVE_X11_XINPUT && !defined(KCMRULES)
+#include <X11/extensions/XInput2.h>
+#endif
 #include <fixx11h.h>
 // xcb
 #include <xcb/xfixes.h>
@@ -194,24 +200,125 @@ void Cursor::notifyCursorChanged(uint32_t serial)
     emit cursorChanged(serial);
 }
 
+#if HAVE_X11_XINPUT && !defined(KCMRULES)
+/**
+ * Forwards the XInput 2 raw pointer events selected on the root window to the X11Cursor.
+ * The events are not filtered out, so that they still reach Qt.
+ **/
+class XInputEventFilter : public QAbstractNativeEventFilter
+{
+public:
+    XInputEventFilter(X11Cursor *cursor, int xiOpcode)
+        : QAbstractNativeEventFilter()
+        , m_cursor(cursor)
+        , m_xiOpcode(xiOpcode)
+    {
+    }
+
+    bool nativeEventFilter(const QByteArray &eventType, void *message, long int *result) override {
+        Q_UNUSED(result)
+        if (eventType != "xcb_generic_event_t") {
+            return false;
+        }
+        auto *event = static_cast<xcb_generic_event_t *>(message);
+        if ((event->response_type & ~0x80) != XCB_GE_GENERIC) {
+            return false;
+        }
+        auto *geEvent = reinterpret_cast<xcb_ge_generic_event_t *>(event);
+        if (geEvent->extension != m_xiOpcode) {
+            return false;
+        }
+        switch (geEvent->event_type) {
+        case XI_RawMotion:
+        case XI_RawButtonPress:
+        case XI_RawButtonRelease:
+            m_cursor->schedulePoll();
+            break;
+        default:
+            break;
+        }
+        return false;
+    }
+
+private:
+    X11Cursor *m_cursor;
+    int m_xiOpcode;
+};
+#endif
+
 X11Cursor::X11Cursor(QObject *parent)
     : Cursor(parent)
     , m_timeStamp(XCB_TIME_CURRENT_TIME)
     , m_buttonMask(0)
     , m_resetTimeStampTimer(new QTimer(this))
     , m_mousePollingTimer(new QTimer(this))
+    , m_hasXInput(false)
 {
     m_resetTimeStampTimer->setSingleShot(true);
     connect(m_resetTimeStampTimer, SIGNAL(timeout()), SLOT(resetTimeStamp()));
-    // TODO: How often do we really need to poll?
+    // Without XInput 2 we need to poll, 50 msec is a compromise between latency and wakeups
     m_mousePollingTimer->setInterval(50);
     connect(m_mousePollingTimer, SIGNAL(timeout()), SLOT(mousePolled()));
+    initXInput();
 }
 
 X11Cursor::~X11Cursor()
 {
 }
 
+void X11Cursor::initXInput()
+{
+#if HAVE_X11_XINPUT && !defined(KCMRULES)
+    int xiOpcode, event, error;
+    if (!XQueryExtension(display(), "XInputExtension", &xiOpcode, &event, &error)) {
+        return;
+    }
+    // Qt already negotiated the version on the shared connection, ask for the same one.
+    // Raw events are available since 2.0
+    int major = 2, minor = 2;
+    if (XIQueryVersion(display(), &major, &minor) != Success || major < 2) {
+        return;
+    }
+    m_hasXInput = true;
+    // Each raw event triggers a poll once control returns to the event loop,
+    // so that a burst of motion events results in a single position update
+    m_mousePollingTimer->setSingleShot(true);
+    m_mousePollingTimer->setInterval(0);
+    m_xiEventFilter.reset(new XInputEventFilter(this, xiOpcode));
+    QCoreApplication::instance()->installNativeEventFilter(m_xiEventFilter.data());
+#endif
+}
+
+void X11Cursor::selectRawPointerEvents(bool select)
+{
+#if HAVE_X11_XINPUT && !defined(KCMRULES)
+    unsigned char mask[XIMaskLen(XI_LASTEVENT)] = { 0 };
+    if (select) {
+        XISetMask(mask, XI_RawMotion);
+        XISetMask(mask, XI_RawButtonPress);
+        XISetMask(mask, XI_RawButtonRelease);
+    }
+    XIEventMask eventMask;
+    eventMask.deviceid = XIAllMasterDevices;
+    eventMask.mask_len = sizeof(mask);
+    eventMask.mask = mask;
+    XISelectEvents(display(), rootWindow(), &eventMask, 1);
+    XFlush(display());
+#else
+    Q_UNUSED(select)
+#endif
+}
+
+void X11Cursor::schedulePoll()
+{
+    if (m_mousePollingTimer->isActive()) {
+        return;
+    }
+    // the pointer moved, the position has to be queried even if the X time stamp is unchanged
+    resetTimeStamp();
+    m_mousePollingTimer->start();
+}
+
 void X11Cursor::doSetPos()
 {
     const QPoint &pos = currentPos();
@@ -245,11 +352,18 @@ void X11Cursor::resetTimeStamp()
 
 void X11Cursor::doStartMousePolling()
 {
-    m_mousePollingTimer->start();
+    if (m_hasXInput) {
+        selectRawPointerEvents(true);
+    } else {
+        m_mousePollingTimer->start();
+    }
 }
 
 void X11Cursor::doStopMousePolling()
 {
+    if (m_hasXInput) {
+        selectRawPointerEvents(false);
+    }
     m_mousePollingTimer->stop();
 }
 
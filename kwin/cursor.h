@@ -25,9 +25,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QHash>
 #include <QObject>
 #include <QPoint>
+#include <QScopedPointer>
 // xcb
 #include <xcb/xcb.h>
 
+class QAbstractNativeEventFilter;
 class QTimer;
 
 namespace KWin
@@ -48,8 +50,9 @@ namespace KWin
  *
  * The actual implementation is split into two parts: a system independent interface and a windowing
  * system specific subclass. So far only an X11 backend is implemented which uses query pointer to
- * fetch the position and warp pointer to set the position. It uses a timer based mouse polling and
- * can provide X11 cursors through the XCursor library.
+ * fetch the position and warp pointer to set the position. Mouse polling is driven by XInput 2 raw
+ * pointer events if available, otherwise by a timer. It can provide X11 cursors through the XCursor
+ * library.
  **/
 class Cursor : public QObject
 {
@@ -206,6 +209,11 @@ class X11Cursor : public Cursor
     Q_OBJECT
 public:
     virtual ~X11Cursor();
+    /**
+     * Refetches the position once control returns to the event loop. Called for XInput 2
+     * raw pointer events while mouse polling is active.
+     **/
+    void schedulePoll();
 protected:
     virtual xcb_cursor_t getX11Cursor(Qt::CursorShape shape);
     virtual void doSetPos();
@@ -226,11 +234,15 @@ private Q_SLOTS:
 private:
     X11Cursor(QObject *parent);
     xcb_cursor_t createCursor(Qt::CursorShape shape);
+    void initXInput();
+    void selectRawPointerEvents(bool select);
     QHash<Qt::CursorShape, xcb_cursor_t > m_cursors;
     xcb_timestamp_t m_timeStamp;
     uint16_t m_buttonMask;
     QTimer *m_resetTimeStampTimer;
     QTimer *m_mousePollingTimer;
+    bool m_hasXInput;
+    QScopedPointer<QAbstractNativeEventFilter> m_xiEventFilter;
     friend class Cursor;
 };
 
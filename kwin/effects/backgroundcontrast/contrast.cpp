@@ -25,6 +25,7 @@
 
 #include <QMatrix4x4>
 #include <QLinkedList>
+#include <QPainter>
 
 namespace KWin
 {
@@ -32,14 +33,18 @@ namespace KWin
 static const QByteArray s_contrastAtomName = QByteArrayLiteral("_KDE_NET_WM_BACKGROUND_CONTRAST_REGION");
 
 ContrastEffect::ContrastEffect()
+    : shader(nullptr)
+    , m_cpuContrast(effects->compositingType() == QPainterCompositing)
 {
-    shader = ContrastShader::create();
+    if (!m_cpuContrast) {
+        shader = ContrastShader::create();
+    }
 
     reconfigure(ReconfigureAll);
 
     // ### Hackish way to announce support.
     //     Should be included in _NET_SUPPORTED instead.
-    if (shader && shader->isValid()) {
+    if (isValid()) {
         net_wm_contrast_region = effects->announceSupportProperty(s_contrastAtomName, this);
     } else {
         net_wm_contrast_region = 0;
@@ -71,7 +76,7 @@ void ContrastEffect::reconfigure(ReconfigureFlags flags)
     if (shader)
         shader->init();
 
-    if (!shader || !shader->isValid())
+    if (!isValid())
         effects->removeSupportProperty(s_contrastAtomName, this);
 }
 
@@ -99,7 +104,9 @@ void ContrastEffect::updateContrastRegion(EffectWindow *w) const
         }
 
         QMatrix4x4 colorMatrix(colorTransform);
-        shader->setColorMatrix(colorMatrix);
+        if (shader)
+            shader->setColorMatrix(colorMatrix);
+        m_colorMatrix = colorMatrix;
     }
 
     if (region.isEmpty() && !value.isNull()) {
@@ -174,6 +181,10 @@ bool ContrastEffect::enabledByDefault()
 
 bool ContrastEffect::supported()
 {
+    if (effects->compositingType() == QPainterCompositing) {
+        return true;
+    }
+
     bool supported = GLRenderTarget::supported() && GLTexture::NPOTTextureSupported() && ContrastShader::supported();
 
     if (supported) {
@@ -187,6 +198,11 @@ bool ContrastEffect::supported()
     return supported;
 }
 
+bool ContrastEffect::isValid() const
+{
+    return m_cpuContrast || (shader && shader->isValid());
+}
+
 QRegion ContrastEffect::contrastRegion(const EffectWindow *w) const
 {
     QRegion region;
@@ -260,7 +276,7 @@ void ContrastEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, i
     if (!w->isPaintingEnabled()) {
         return;
     }
-    if (!shader || !shader->isValid()) {
+    if (!isValid()) {
         return;
     }
 
@@ -302,7 +318,7 @@ void ContrastEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, i
 
 bool ContrastEffect::shouldContrast(const EffectWindow *w, int mask, const WindowPaintData &data) const
 {
-    if (!shader || !shader->isValid())
+    if (!isValid())
         return false;
 
     if (effects->activeFullScreenEffect() && !w->data(WindowForceBackgroundContrastRole).toBool())
@@ -337,7 +353,11 @@ void ContrastEffect::drawWindow(EffectWindow *w, int mask, QRegion region, Windo
         }
 
         if (!shape.isEmpty()) {
-            doContrast(shape, screen, data.opacity());
+            if (m_cpuContrast) {
+                doCpuContrast(shape, screen, data.opacity());
+            } else {
+                doContrast(shape, screen, data.opacity());
+            }
         }
     }
 
@@ -398,5 +418,55 @@ void ContrastEffect::doContrast(const QRegion& shape, const QRect& screen, const
     shader->unbind();
 }
 
+void ContrastEffect::doCpuContrast(const QRegion& shape, const QRect& screen, const float opacity)
+{
+    // The back buffer of the QPainter scene, which the background is read from
+    QPainter *painter = effects->scenePainter();
+    if (!painter || !painter->device() || painter->device()->devType() != QInternal::Image) {
+        return;
+    }
+    const QImage *buffer = static_cast<const QImage*>(painter->device());
+
+    const QRegion actualShape = shape & screen;
+    const QRect r = actualShape.boundingRect() & buffer->rect();
+    QImage background = buffer->copy(r).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    // Like the shader, blend the color matrix with the identity for translucent windows
+    const QMatrix4x4 matrix = opacity >= 1.0 ? m_colorMatrix :
+                              m_colorMatrix * opacity + QMatrix4x4() * (1.0 - opacity);
+
+    // The output channel j is the sum of the input channels i weighted with
+    // matrix(i, j), in 8.8 fixed point and in the order red, green, blue, alpha
+    int weights[4][4];
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            weights[i][j] = qRound(matrix(i, j) * 256);
+        }
+    }
+
+    for (int y = 0; y < background.height(); ++y) {
+        quint32 *line = reinterpret_cast<quint32*>(background.scanLine(y));
+        for (int x = 0; x < background.width(); ++x) {
+            const quint32 pixel = line[x];
+            const int in[4] = { qRed(pixel), qGreen(pixel), qBlue(pixel), qAlpha(pixel) };
+            int out[4];
+            for (int j = 0; j < 4; ++j) {
+                const int sum = in[0] * weights[0][j] + in[1] * weights[1][j] +
+                                in[2] * weights[2][j] + in[3] * weights[3][j];
+                out[j] = qBound(0, (sum + 128) / 256, 255);
+            }
+            // keep the pixel premultiplied
+            line[x] = qRgba(qMin(out[0], out[3]), qMin(out[1], out[3]), qMin(out[2], out[3]), out[3]);
+        }
+    }
+
+    // The matrix already contains the opacity, so the background gets replaced
+    painter->save();
+    painter->setClipRegion(actualShape);
+    painter->setCompositionMode(QPainter::CompositionMode_Source);
+    painter->drawImage(r.topLeft(), background);
+    painter->restore();
+}
+
 } // namespace KWin
 
@@ -25,6 +25,7 @@
 #include <kwinglplatform.h>
 #include <kwinglutils.h>
 
+#include <QMatrix4x4>
 #include <QVector>
 #include <QVector2D>
 
@@ -62,15 +63,19 @@ public Q_SLOTS:
     void slotScreenGeometryChanged();
 
 private:
+    bool isValid() const;
     QRegion contrastRegion(const EffectWindow *w) const;
     bool shouldContrast(const EffectWindow *w, int mask, const WindowPaintData &data) const;
     void updateContrastRegion(EffectWindow *w) const;
     void doContrast(const QRegion &shape, const QRect &screen, const float opacity);
+    void doCpuContrast(const QRegion &shape, const QRect &screen, const float opacity);
     void uploadRegion(QVector2D *&map, const QRegion &region);
     void uploadGeometry(GLVertexBuffer *vbo, const QRegion &region);
 
 private:
     ContrastShader *shader;
+    bool m_cpuContrast; // applies the color matrix on the CPU with the QPainter scene
+    mutable QMatrix4x4 m_colorMatrix;
     long net_wm_contrast_region;
     QRegion m_paintedArea; // actually painted area which is greater than m_damagedArea
     QRegion m_currentContrast; // keeps track of the currently contrasted area of non-caching windows(from bottom to top)
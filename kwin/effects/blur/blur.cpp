@@ -20,11 +20,13 @@
 
 #include "blur.h"
 #include "blurshader.h"
+#include "cpublur.h"
 // KConfigSkeleton
 #include "blurconfig.h"
 
 #include <QMatrix4x4>
 #include <QLinkedList>
+#include <QPainter>
 
 namespace KWin
 {
@@ -32,22 +34,30 @@ namespace KWin
 static const QByteArray s_blurAtomName = QByteArrayLiteral("_KDE_NET_WM_BLUR_BEHIND_REGION");
 
 BlurEffect::BlurEffect()
+    : shader(nullptr)
+    , m_cpuBlur(nullptr)
+    , target(nullptr)
 {
-    shader = BlurShader::create();
+    if (effects->compositingType() == QPainterCompositing) {
+        // Without OpenGL the background gets blurred on the CPU
+        m_cpuBlur = new CpuBlur;
+    } else {
+        shader = BlurShader::create();
 
-    // Offscreen texture that's used as the target for the horizontal blur pass
-    // and the source for the vertical pass.
-    tex = GLTexture(effects->virtualScreenSize());
-    tex.setFilter(GL_LINEAR);
-    tex.setWrapMode(GL_CLAMP_TO_EDGE);
+        // Offscreen texture that's used as the target for the horizontal blur pass
+        // and the source for the vertical pass.
+        tex = GLTexture(effects->virtualScreenSize());
+        tex.setFilter(GL_LINEAR);
+        tex.setWrapMode(GL_CLAMP_TO_EDGE);
 
-    target = new GLRenderTarget(tex);
+        target = new GLRenderTarget(tex);
+    }
 
     reconfigure(ReconfigureAll);
 
     // ### Hackish way to announce support.
     //     Should be included in _NET_SUPPORTED instead.
-    if (shader && shader->isValid() && target->valid()) {
+    if (isValid()) {
         net_wm_blur_region = effects->announceSupportProperty(s_blurAtomName, this);
     } else {
         net_wm_blur_region = 0;
@@ -68,6 +78,7 @@ BlurEffect::~BlurEffect()
     windows.clear();
 
     delete shader;
+    delete m_cpuBlur;
     delete target;
 }
 
@@ -84,12 +95,14 @@ void BlurEffect::reconfigure(ReconfigureFlags flags)
     int radius = qBound(2, BlurConfig::blurRadius(), 14);
     if (shader)
         shader->setRadius(radius);
+    if (m_cpuBlur)
+        m_cpuBlur->setRadius(radius);
 
     m_shouldCache = BlurConfig::cacheTexture();
 
     windows.clear();
 
-    if (!shader || !shader->isValid())
+    if (!isValid())
         effects->removeSupportProperty(s_blurAtomName, this);
 }
 
@@ -154,6 +167,10 @@ bool BlurEffect::enabledByDefault()
 
 bool BlurEffect::supported()
 {
+    if (effects->compositingType() == QPainterCompositing) {
+        return true;
+    }
+
     bool supported = GLRenderTarget::supported() && GLTexture::NPOTTextureSupported() && GLSLBlurShader::supported();
 
     if (supported) {
@@ -167,9 +184,17 @@ bool BlurEffect::supported()
     return supported;
 }
 
+bool BlurEffect::isValid() const
+{
+    if (m_cpuBlur) {
+        return true;
+    }
+    return shader && shader->isValid() && target->valid();
+}
+
 QRect BlurEffect::expand(const QRect &rect) const
 {
-    const int radius = shader->radius();
+    const int radius = blurRadius();
     return rect.adjusted(-radius, -radius, radius, radius);
 }
 
@@ -268,14 +293,14 @@ void BlurEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int t
     if (!w->isPaintingEnabled()) {
         return;
     }
-    if (!shader || !shader->isValid()) {
+    if (!isValid()) {
         return;
     }
 
     // to blur an area partially we have to shrink the opaque area of a window
     QRegion newClip;
     const QRegion oldClip = data.clip;
-    const int radius = shader->radius();
+    const int radius = blurRadius();
     foreach (const QRect& rect, data.clip.rects()) {
         newClip |= rect.adjusted(radius,radius,-radius,-radius);
     }
@@ -303,9 +328,11 @@ void BlurEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int t
         // update the cached texture
         QRegion damagedCache;
         CacheEntry it = windows.find(w);
+        const QSize cacheSize = it == windows.end() ? QSize() :
+                                m_cpuBlur ? it->blurredImage.size() : it->blurredBackground.size();
         if (it != windows.end() && !it->dropCache &&
             it->windowPos == w->pos() &&
-            it->blurredBackground.size() == expandedBlur.boundingRect().size()) {
+            cacheSize == expandedBlur.boundingRect().size()) {
             damagedCache = (expand(expandedBlur & m_damagedArea) |
                             (it->damagedRegion & data.paint)) & expandedBlur;
         } else {
@@ -365,7 +392,7 @@ void BlurEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int t
 
 bool BlurEffect::shouldBlur(const EffectWindow *w, int mask, const WindowPaintData &data) const
 {
-    if (!target->valid() || !shader || !shader->isValid())
+    if (!isValid())
         return false;
 
     if (effects->activeFullScreenEffect() && !w->data(WindowForceBlurRole).toBool())
@@ -403,7 +430,13 @@ void BlurEffect::drawWindow(EffectWindow *w, int mask, QRegion region, WindowPai
         }
 
         if (!shape.isEmpty()) {
-            if (m_shouldCache && !translated) {
+            if (m_cpuBlur) {
+                if (m_shouldCache && !translated) {
+                    doCachedCpuBlur(w, region, data.opacity());
+                } else {
+                    doCpuBlur(shape, screen, data.opacity());
+                }
+            } else if (m_shouldCache && !translated) {
                 doCachedBlur(w, region, data.opacity());
             } else {
                 doBlur(shape, screen, data.opacity());
@@ -418,10 +451,14 @@ void BlurEffect::drawWindow(EffectWindow *w, int mask, QRegion region, WindowPai
 void BlurEffect::paintEffectFrame(EffectFrame *frame, QRegion region, double opacity, double frameOpacity)
 {
     const QRect screen = effects->virtualScreenGeometry();
-    bool valid = target->valid() && shader && shader->isValid();
+    bool valid = isValid();
     QRegion shape = frame->geometry().adjusted(-5, -5, 5, 5) & screen;
     if (valid && !shape.isEmpty() && region.intersects(shape.boundingRect()) && frame->style() != EffectFrameNone) {
-        doBlur(shape, screen, opacity * frameOpacity);
+        if (m_cpuBlur) {
+            doCpuBlur(shape, screen, opacity * frameOpacity);
+        } else {
+            doBlur(shape, screen, opacity * frameOpacity);
+        }
     }
     effects->paintEffectFrame(frame, region, opacity, frameOpacity);
 }
@@ -652,8 +689,96 @@ void BlurEffect::doCachedBlur(EffectWindow *w, const QRegion& region, const floa
     shader->unbind();
 }
 
+// The back buffer of the QPainter scene, which the background is read from
+static const QImage *sceneImage()
+{
+    const QPainter *painter = effects->scenePainter();
+    if (!painter || !painter->device() || painter->device()->devType() != QInternal::Image) {
+        return nullptr;
+    }
+    return static_cast<const QImage*>(painter->device());
+}
+
+void BlurEffect::doCpuBlur(const QRegion& shape, const QRect& screen, const float opacity)
+{
+    const QImage *buffer = sceneImage();
+    if (!buffer) {
+        return;
+    }
+    const QRect r = (expand(shape) & screen).boundingRect() & buffer->rect();
+    const QImage blurred = m_cpuBlur->blur(buffer->copy(r));
+
+    // Draw the blurred area back to the back buffer, clipped to the window shape
+    QPainter *painter = effects->scenePainter();
+    painter->save();
+    painter->setClipRegion(shape);
+    painter->setOpacity(opacity);
+    painter->drawImage(r.topLeft(), blurred);
+    painter->restore();
+}
+
+void BlurEffect::doCachedCpuBlur(EffectWindow *w, const QRegion& region, const float opacity)
+{
+    const QImage *buffer = sceneImage();
+    if (!buffer) {
+        return;
+    }
+    const QRect screen = effects->virtualScreenGeometry();
+    const QRegion blurredRegion = blurRegion(w).translated(w->pos()) & screen;
+    const QRegion expanded = expand(blurredRegion) & screen;
+    const QRect r = expanded.boundingRect();
+
+    CacheEntry it = windows.find(w);
+    if (it == windows.end()) {
+        BlurWindowInfo bwi;
+        bwi.blurredImage = QImage(r.size(), QImage::Format_ARGB32_Premultiplied);
+        bwi.damagedRegion = expanded;
+        bwi.dropCache = false;
+        bwi.windowPos = w->pos();
+        it = windows.insert(w, bwi);
+    } else if (it->blurredImage.size() != r.size()) {
+        it->blurredImage = QImage(r.size(), QImage::Format_ARGB32_Premultiplied);
+        it->dropCache = false;
+        it->windowPos = w->pos();
+    } else if (it->windowPos != w->pos()) {
+        it->dropCache = false;
+        it->windowPos = w->pos();
+    }
+
+    // Same as in doCachedBlur, only the part of the damaged region whose background
+    // got completely repainted becomes valid
+    const QRegion damagedRegion = it->damagedRegion;
+    const QRegion updateBackground = damagedRegion & region;
+    const QRegion validUpdate = damagedRegion - expand(damagedRegion - region);
+
+    if (!validUpdate.isEmpty()) {
+        // Blur only the damaged part, together with the background it depends on
+        const QRect updateRect = (expand(updateBackground) & expanded).boundingRect() & buffer->rect();
+        const QImage blurred = m_cpuBlur->blur(buffer->copy(updateRect));
+
+        QPainter p(&it->blurredImage);
+        p.setCompositionMode(QPainter::CompositionMode_Source);
+        p.setClipRegion(updateBackground.translated(-r.topLeft()));
+        p.drawImage(updateRect.topLeft() - r.topLeft(), blurred);
+        p.end();
+
+        // mark the updated region as valid
+        it->damagedRegion -= validUpdate;
+    }
+
+    QPainter *painter = effects->scenePainter();
+    painter->save();
+    painter->setClipRegion(blurredRegion & region);
+    painter->setOpacity(opacity);
+    painter->drawImage(r.topLeft(), it->blurredImage);
+    painter->restore();
+}
+
 int BlurEffect::blurRadius() const
 {
+    if (m_cpuBlur) {
+        return m_cpuBlur->radius();
+    }
     if (!shader) {
         return 0;
     }
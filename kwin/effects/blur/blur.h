@@ -24,6 +24,7 @@
 #include <kwinglplatform.h>
 #include <kwinglutils.h>
 
+#include <QImage>
 #include <QVector>
 #include <QVector2D>
 
@@ -31,6 +32,7 @@ namespace KWin
 {
 
 class BlurShader;
+class CpuBlur;
 
 class BlurEffect : public KWin::Effect
 {
@@ -68,6 +70,7 @@ public Q_SLOTS:
     void slotScreenGeometryChanged();
 
 private:
+    bool isValid() const;
     QRect expand(const QRect &rect) const;
     QRegion expand(const QRegion &region) const;
     QRegion blurRegion(const EffectWindow *w) const;
@@ -77,9 +80,12 @@ private:
     void doCachedBlur(EffectWindow *w, const QRegion& region, const float opacity);
     void uploadRegion(QVector2D *&map, const QRegion &region);
     void uploadGeometry(GLVertexBuffer *vbo, const QRegion &horizontal, const QRegion &vertical);
+    void doCpuBlur(const QRegion &shape, const QRect &screen, const float opacity);
+    void doCachedCpuBlur(EffectWindow *w, const QRegion& region, const float opacity);
 
 private:
     BlurShader *shader;
+    CpuBlur *m_cpuBlur; // replaces the shader with the QPainter scene
     GLRenderTarget *target;
     GLTexture tex;
     long net_wm_blur_region;
@@ -90,6 +96,7 @@ private:
 
     struct BlurWindowInfo {
         GLTexture blurredBackground; // keeps the horizontally blurred background
+        QImage blurredImage; // keeps the blurred background with the QPainter scene
         QRegion damagedRegion;
         QPoint windowPos;
         bool dropCache;
@@ -0,0 +1,227 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "cpublur.h"
+
+#include <QVector>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+// The four channels of a premultiplied pixel are processed at once in two words
+// with two 16 bit lanes each, one for red and blue and one for alpha and green.
+// This leaves eight bits of headroom for the sums in every lane.
+static const quint32 s_laneMask = 0x00ff00ff;
+
+static inline quint32 redBlue(quint32 pixel)
+{
+    return pixel & s_laneMask;
+}
+
+static inline quint32 alphaGreen(quint32 pixel)
+{
+    return (pixel >> 8) & s_laneMask;
+}
+
+static inline quint32 fromLanes(quint32 redBlue, quint32 alphaGreen)
+{
+    return (redBlue & s_laneMask) | ((alphaGreen & s_laneMask) << 8);
+}
+
+// Divides the lanes of the sums by a multiplication with a 16.16 fixed point reciprocal
+static inline quint32 boxAverage(quint32 sumRB, quint32 sumAG, quint64 multiplier)
+{
+    const quint64 rb = ((sumRB & 0xffff) | (quint64(sumRB >> 16) << 32)) * multiplier;
+    const quint64 ag = ((sumAG & 0xffff) | (quint64(sumAG >> 16) << 32)) * multiplier;
+    return ((rb >> 16) & 0xff) | ((rb >> 32) & 0xff0000) | ((ag >> 8) & 0xff00) | ((ag >> 24) & 0xff000000);
+}
+
+// Mixes three parts of a with one part of b
+static inline quint32 mix31(quint32 a, quint32 b)
+{
+    return fromLanes((redBlue(a) * 3 + redBlue(b) + 0x00020002) >> 2,
+                     (alphaGreen(a) * 3 + alphaGreen(b) + 0x00020002) >> 2);
+}
+
+// Box blurs count pixels from src into dst with a running sum
+static void boxBlurLine(const quint32 *src, quint32 *dst, int count, int radius)
+{
+    // rounding up keeps the average of 255 at 255
+    const quint64 multiplier = ((1 << 16) + 2 * radius) / (2 * radius + 1);
+    const int last = count - 1;
+
+    quint32 sumRB = 0;
+    quint32 sumAG = 0;
+    for (int i = -radius; i <= radius; ++i) {
+        const quint32 pixel = src[qBound(0, i, last)];
+        sumRB += redBlue(pixel);
+        sumAG += alphaGreen(pixel);
+    }
+    for (int i = 0; i < count; ++i) {
+        dst[i] = boxAverage(sumRB, sumAG, multiplier);
+        // the lanes can't underflow as the pixel going out is part of the sum
+        const quint32 in = src[qMin(i + radius + 1, last)];
+        const quint32 out = src[qMax(i - radius, 0)];
+        sumRB += redBlue(in) - redBlue(out);
+        sumAG += alphaGreen(in) - alphaGreen(out);
+    }
+}
+
+CpuBlur::CpuBlur(int radius)
+{
+    setRadius(radius);
+}
+
+void CpuBlur::setRadius(int radius)
+{
+    m_radius = qMax(radius, 2);
+    m_downsample = m_radius >= 8;
+    if (m_downsample) {
+        // resampling reaches two pixels and each pixel of the small image covers two
+        m_passes = 3;
+        m_boxRadius = (m_radius - 2) / 2 / m_passes;
+    } else {
+        m_boxRadius = qMax(1, m_radius / 3);
+        m_passes = qMin(3, m_radius / m_boxRadius);
+    }
+}
+
+QImage CpuBlur::blur(const QImage &image) const
+{
+    if (image.isNull()) {
+        return QImage();
+    }
+    if (!m_downsample) {
+        QImage result = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        boxBlur(result, m_boxRadius, m_passes);
+        return result;
+    }
+    QImage small = downsample(image);
+    boxBlur(small, m_boxRadius, m_passes);
+    return upsample(small, image.size());
+}
+
+void CpuBlur::boxBlur(QImage &image, int boxRadius, int passes)
+{
+    if (image.isNull() || passes <= 0) {
+        return;
+    }
+    if (image.format() != QImage::Format_ARGB32_Premultiplied) {
+        image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    // the sums of 255 values fit into the lanes
+    boxRadius = qBound(1, boxRadius, 127);
+
+    const int width = image.width();
+    const int height = image.height();
+    const int stride = image.bytesPerLine() / sizeof(quint32);
+    quint32 *bits = reinterpret_cast<quint32*>(image.bits());
+
+    // all passes of a line are done in the line buffers
+    QVector<quint32> front(qMax(width, height));
+    QVector<quint32> back(front.size());
+    for (int y = 0; y < height; ++y) {
+        quint32 *row = bits + y * stride;
+        quint32 *src = front.data();
+        quint32 *dst = back.data();
+        std::copy(row, row + width, src);
+        for (int i = 0; i < passes; ++i) {
+            boxBlurLine(src, dst, width, boxRadius);
+            std::swap(src, dst);
+        }
+        std::copy(src, src + width, row);
+    }
+    for (int x = 0; x < width; ++x) {
+        quint32 *src = front.data();
+        quint32 *dst = back.data();
+        for (int y = 0; y < height; ++y) {
+            src[y] = bits[y * stride + x];
+        }
+        for (int i = 0; i < passes; ++i) {
+            boxBlurLine(src, dst, height, boxRadius);
+            std::swap(src, dst);
+        }
+        for (int y = 0; y < height; ++y) {
+            bits[y * stride + x] = src[y];
+        }
+    }
+}
+
+QImage CpuBlur::downsample(const QImage &image)
+{
+    if (image.isNull()) {
+        return QImage();
+    }
+    const QImage source = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const int lastX = source.width() - 1;
+    const int lastY = source.height() - 1;
+    QImage result((source.width() + 1) / 2, (source.height() + 1) / 2, QImage::Format_ARGB32_Premultiplied);
+
+    for (int y = 0; y < result.height(); ++y) {
+        const quint32 *top = reinterpret_cast<const quint32*>(source.constScanLine(2 * y));
+        const quint32 *bottom = reinterpret_cast<const quint32*>(source.constScanLine(qMin(2 * y + 1, lastY)));
+        quint32 *out = reinterpret_cast<quint32*>(result.scanLine(y));
+        for (int x = 0; x < result.width(); ++x) {
+            const int left = 2 * x;
+            const int right = qMin(left + 1, lastX);
+            out[x] = fromLanes((redBlue(top[left]) + redBlue(top[right]) +
+                                redBlue(bottom[left]) + redBlue(bottom[right]) + 0x00020002) >> 2,
+                               (alphaGreen(top[left]) + alphaGreen(top[right]) +
+                                alphaGreen(bottom[left]) + alphaGreen(bottom[right]) + 0x00020002) >> 2);
+        }
+    }
+    return result;
+}
+
+QImage CpuBlur::upsample(const QImage &image, const QSize &size)
+{
+    if (image.isNull() || size.isEmpty()) {
+        return QImage();
+    }
+    // bilinear with the pixel centers of the small image between two pixels of the large one
+    const QImage source = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const int lastX = source.width() - 1;
+    const int lastY = source.height() - 1;
+
+    QImage wide(size.width(), source.height(), QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < source.height(); ++y) {
+        const quint32 *in = reinterpret_cast<const quint32*>(source.constScanLine(y));
+        quint32 *out = reinterpret_cast<quint32*>(wide.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            const int nearest = qMin(x / 2, lastX);
+            const int next = (x & 1) ? qMin(nearest + 1, lastX) : qMax(nearest - 1, 0);
+            out[x] = mix31(in[nearest], in[next]);
+        }
+    }
+
+    QImage result(size, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < size.height(); ++y) {
+        const int nearest = qMin(y / 2, lastY);
+        const int next = (y & 1) ? qMin(nearest + 1, lastY) : qMax(nearest - 1, 0);
+        const quint32 *a = reinterpret_cast<const quint32*>(wide.constScanLine(nearest));
+        const quint32 *b = reinterpret_cast<const quint32*>(wide.constScanLine(next));
+        quint32 *out = reinterpret_cast<quint32*>(result.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            out[x] = mix31(a[x], b[x]);
+        }
+    }
+    return result;
+}
+
+} // namespace KWin
@@ -0,0 +1,61 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CPUBLUR_H
+#define CPUBLUR_H
+
+#include <QImage>
+
+namespace KWin
+{
+
+// Blurs images on the CPU, for compositing without OpenGL.
+//
+// The gaussian blur is approximated by up to three separable box blurs, larger
+// radii are blurred on a copy downsampled by two. A blurred pixel only depends
+// on the pixels within radius() in both directions, so that parts of an image
+// can be blurred again from the same neighbourhood.
+class CpuBlur
+{
+public:
+    explicit CpuBlur(int radius = 12);
+
+    // Sets the radius in pixels
+    void setRadius(int radius);
+    int radius() const {
+        return m_radius;
+    }
+
+    // Returns a blurred copy of the image in ARGB32_Premultiplied, the pixels
+    // beyond the borders are taken to be the ones at the border
+    QImage blur(const QImage &image) const;
+
+    // Box blurs the image in place horizontally and vertically
+    static void boxBlur(QImage &image, int boxRadius, int passes);
+    static QImage downsample(const QImage &image);
+    static QImage upsample(const QImage &image, const QSize &size);
+
+private:
+    int m_radius;
+    int m_boxRadius;
+    int m_passes;
+    bool m_downsample;
+};
+
+} // namespace KWin
+
+#endif
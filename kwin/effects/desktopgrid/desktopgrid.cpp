@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "../presentwindows/presentwindows_proxy.h"
 
+#include <kwinglutils.h>
+
 #include <math.h>
 
 #include <QAction>
@@ -36,6 +38,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QEvent>
 #include <QMouseEvent>
 #include <QtGui/QVector2D>
+#include <QtMath>
 #include <QQmlContext>
 #include <QQmlEngine>
 #include <QQuickItem>
@@ -45,6 +48,10 @@ namespace KWin
 
 // WARNING, TODO: This effect relies on the desktop layout being EWMH-compliant.
 
+// Video memory all offscreen copies of the desktops may take together, including their mipmaps.
+// Beyond that every desktop is painted directly, which integrated graphics can afford better.
+static const qint64 s_desktopCacheBudget = 64 * 1024 * 1024;
+
 DesktopGridEffect::DesktopGridEffect()
     : activated(false)
     , timeline()
@@ -62,6 +69,7 @@ DesktopGridEffect::DesktopGridEffect()
     , scaledSize()
     , scaledOffset()
     , m_proxy(0)
+    , m_renderingDesktopCache(false)
 {
     // Load shortcuts
     QAction* a = new QAction(this);
@@ -79,6 +87,25 @@ DesktopGridEffect::DesktopGridEffect()
     connect(effects, SIGNAL(numberDesktopsChanged(uint)), this, SLOT(slotNumberDesktopsChanged(uint)));
     connect(effects, SIGNAL(windowGeometryShapeChanged(KWin::EffectWindow*,QRect)), this, SLOT(slotWindowGeometryShapeChanged(KWin::EffectWindow*,QRect)));
 
+    // invalidation of the cached desktops
+    connect(effects, SIGNAL(windowDamaged(KWin::EffectWindow*,QRect)), this, SLOT(slotWindowContentChanged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowAdded(KWin::EffectWindow*)), this, SLOT(slotWindowContentChanged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowClosed(KWin::EffectWindow*)), this, SLOT(slotWindowContentChanged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowGeometryShapeChanged(KWin::EffectWindow*,QRect)), this, SLOT(slotWindowContentChanged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowMinimized(KWin::EffectWindow*)), this, SLOT(slotWindowContentChanged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowUnminimized(KWin::EffectWindow*)), this, SLOT(slotWindowContentChanged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowOpacityChanged(KWin::EffectWindow*,qreal,qreal)), this, SLOT(slotWindowContentChanged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(desktopPresenceChanged(KWin::EffectWindow*,int,int)), this, SLOT(slotDesktopPresenceChanged(KWin::EffectWindow*,int,int)));
+    connect(effects, SIGNAL(stackingOrderChanged()), this, SLOT(slotStackingOrderChanged()));
+    connect(effects, &EffectsHandler::virtualScreenGeometryChanged, this,
+        [this] {
+            if (!m_desktopCache.isEmpty()) {
+                // the offscreen copies are scaled from the virtual screen
+                setupDesktopCache();
+            }
+        }
+    );
+
     // Load all other configuration details
     reconfigure(ReconfigureAll);
 }
@@ -91,6 +118,8 @@ DesktopGridEffect::~DesktopGridEffect()
         i = m_desktopButtonsViews.erase(i);
         view->deleteLater();
     }
+    m_desktopButtonsWindows.clear();
+    discardDesktopCache();
 }
 
 void DesktopGridEffect::reconfigure(ReconfigureFlags)
@@ -155,10 +184,19 @@ void DesktopGridEffect::paintScreen(int mask, QRegion region, ScreenPaintData& d
         effects->paintScreen(mask, region, data);
         return;
     }
+    const bool useCache = isUsingDesktopCache();
     for (int desktop = 1; desktop <= effects->numberOfDesktops(); desktop++) {
+        if (useCache && desktop != effects->currentDesktop()) {
+            paintCachedDesktop(desktop, region);
+            continue;
+        }
         ScreenPaintData d = data;
         paintingDesktop = desktop;
         effects->paintScreen(mask, region, d);
+        if (desktop <= m_desktopCache.count()) {
+            // changes to a desktop painted directly are not tracked
+            m_desktopCache[desktop - 1].dirty = true;
+        }
     }
 
     // paint the add desktop button
@@ -169,6 +207,7 @@ void DesktopGridEffect::paintScreen(int mask, QRegion region, ScreenPaintData& d
             if (view) {
                 view->setData(WindowForceBlurRole, QVariant(true));
                 it.value() = view;
+                m_desktopButtonsWindows.insert(view);
             }
         }
         if (it.value()) {
@@ -243,6 +282,15 @@ void DesktopGridEffect::postPaintScreen()
 
 void DesktopGridEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int time)
 {
+    if (m_renderingDesktopCache) {
+        // the cached desktop is rendered untransformed, it gets scaled when painting the texture
+        if (w->isOnDesktop(paintingDesktop))
+            w->enablePainting(EffectWindow::PAINT_DISABLED_BY_DESKTOP);
+        else
+            w->disablePainting(EffectWindow::PAINT_DISABLED_BY_DESKTOP);
+        effects->prePaintWindow(w, data, time);
+        return;
+    }
     if (timeline.currentValue() != 0 || (isUsingPresentWindows() && isMotionManagerMovingWindows())) {
         if (w->isOnDesktop(paintingDesktop)) {
             w->enablePainting(EffectWindow::PAINT_DISABLED_BY_DESKTOP);
@@ -272,11 +320,16 @@ void DesktopGridEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data
 
 void DesktopGridEffect::paintWindow(EffectWindow* w, int mask, QRegion region, WindowPaintData& data)
 {
+    if (m_renderingDesktopCache) {
+        if (!m_desktopButtonsWindows.contains(w))
+            effects->paintWindow(w, mask, region, data);
+        return;
+    }
     if (timeline.currentValue() != 0 || (isUsingPresentWindows() && isMotionManagerMovingWindows())) {
         if (isUsingPresentWindows() && w == windowMove && wasWindowMove) {
             return; // will be painted on top of all other windows
         }
-        if (m_desktopButtonsViews.values().contains(w))
+        if (m_desktopButtonsWindows.contains(w))
             return; // will be painted on top of all other windows
 
         qreal xScale = data.xScale();
@@ -433,6 +486,7 @@ void DesktopGridEffect::slotWindowDeleted(EffectWindow* w)
         if (it.value() && it.value() == w) {
             it.key()->deleteLater();
             m_desktopButtonsViews.erase(it);
+            m_desktopButtonsWindows.remove(w);
             break;
         }
     }
@@ -458,6 +512,27 @@ void DesktopGridEffect::slotWindowGeometryShapeChanged(EffectWindow* w, const QR
     }
 }
 
+void DesktopGridEffect::slotWindowContentChanged(EffectWindow* w)
+{
+    if (m_desktopCache.isEmpty())
+        return;
+    invalidateDesktopCache(w->isOnAllDesktops() ? NET::OnAllDesktops : w->desktop());
+}
+
+void DesktopGridEffect::slotDesktopPresenceChanged(EffectWindow* w, int oldDesktop, int newDesktop)
+{
+    Q_UNUSED(w)
+    if (m_desktopCache.isEmpty())
+        return;
+    invalidateDesktopCache(oldDesktop);
+    invalidateDesktopCache(newDesktop);
+}
+
+void DesktopGridEffect::slotStackingOrderChanged()
+{
+    invalidateDesktopCache(NET::OnAllDesktops);
+}
+
 void DesktopGridEffect::windowInputMouseEvent(QEvent* e)
 {
     if ((e->type() != QEvent::MouseMove
@@ -1122,6 +1197,7 @@ void DesktopGridEffect::setup()
         view->show();
         m_desktopButtonsViews.insert(view, NULL);
     }
+    setupDesktopCache();
 }
 
 void DesktopGridEffect::setupGrid()
@@ -1209,6 +1285,8 @@ void DesktopGridEffect::finish()
         i = m_desktopButtonsViews.erase(i);
         view->deleteLater();
     }
+    m_desktopButtonsWindows.clear();
+    discardDesktopCache();
 }
 
 void DesktopGridEffect::globalShortcutChanged(QAction *action, const QKeySequence& seq)
@@ -1328,6 +1406,8 @@ void DesktopGridEffect::desktopsAdded(int old)
     }
 
     setupGrid();
+    // the cells changed their size, and the new desktops may not fit into the budget
+    setupDesktopCache();
 
     // and repaint
     effects->addRepaintFull();
@@ -1366,6 +1446,8 @@ void DesktopGridEffect::desktopsRemoved(int old)
     }
 
     setupGrid();
+    // the cells changed their size, and fewer desktops may fit into the budget again
+    setupDesktopCache();
 
     // and repaint
     effects->addRepaintFull();
@@ -1425,6 +1507,145 @@ void DesktopButtonsView::setRemoveDesktopEnabled(bool enable)
     rootContext()->setContextProperty(QStringLiteral("remove"), QVariant(enable));
 }
 
+//-----------------------------------------------------------------------------
+// Desktop cache
+
+void DesktopGridEffect::setupDesktopCache()
+{
+    discardDesktopCache();
+    // the cached desktops are scaled as a whole, which present windows mode cannot do
+    if (!effects->isOpenGLCompositing() || isUsingPresentWindows())
+        return;
+    if (!GLTexture::NPOTTextureSupported() || !GLRenderTarget::supported())
+        return;
+
+    // a desktop is never shown larger than its cell once the grid is up, the copies are
+    // rendered at that scale, the zoom animation scales them up a bit while it starts
+    qreal cacheScale = 0.0;
+    foreach (double screenScale, scale)
+        cacheScale = qMax(cacheScale, screenScale);
+    cacheScale = qMin(cacheScale, 1.0);
+    const QSize virtualSize = effects->virtualScreenSize();
+    const QSize size(qCeil(virtualSize.width() * cacheScale), qCeil(virtualSize.height() * cacheScale));
+    if (size.isEmpty())
+        return;
+    // 4 bytes per pixel, and a third more for the mipmaps
+    const qint64 desktopBytes = qint64(size.width()) * size.height() * 4 * 4 / 3;
+    if (desktopBytes * effects->numberOfDesktops() > s_desktopCacheBudget)
+        return;
+
+    for (int i = 0; i < effects->numberOfDesktops(); i++) {
+        if (!appendDesktopCache(size)) {
+            discardDesktopCache();
+            return;
+        }
+    }
+}
+
+bool DesktopGridEffect::appendDesktopCache(const QSize &size)
+{
+    DesktopCache cache;
+    // the viewport of the render target is the size of the texture, so the
+    // scene painted with the projection of the screen is scaled down into it
+    cache.texture = new GLTexture(size);
+    cache.texture->setFilter(GL_LINEAR_MIPMAP_LINEAR);
+    cache.texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    cache.target = new GLRenderTarget(*cache.texture);
+    cache.dirty = true;
+    if (!cache.target->valid()) {
+        delete cache.target;
+        delete cache.texture;
+        return false;
+    }
+    m_desktopCache.append(cache);
+    return true;
+}
+
+void DesktopGridEffect::discardDesktopCache()
+{
+    foreach (const DesktopCache &cache, m_desktopCache) {
+        delete cache.target;
+        delete cache.texture;
+    }
+    m_desktopCache.clear();
+}
+
+bool DesktopGridEffect::isUsingDesktopCache() const
+{
+    // the moving window has to follow the cursor on every desktop
+    return !m_desktopCache.isEmpty() && !(windowMove && wasWindowMove);
+}
+
+void DesktopGridEffect::invalidateDesktopCache(int desktop)
+{
+    if (desktop == NET::OnAllDesktops) {
+        for (int i = 0; i < m_desktopCache.count(); i++)
+            m_desktopCache[i].dirty = true;
+    } else if (desktop > 0 && desktop <= m_desktopCache.count()) {
+        m_desktopCache[desktop - 1].dirty = true;
+    }
+}
+
+void DesktopGridEffect::paintCachedDesktop(int desktop, const QRegion &region)
+{
+    DesktopCache &cache = m_desktopCache[desktop - 1];
+    if (cache.dirty) {
+        GLRenderTarget::pushRenderTarget(cache.target);
+        glClearColor(0.0, 0.0, 0.0, 0.0);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glClearColor(0.0, 0.0, 0.0, 1.0);
+        m_renderingDesktopCache = true;
+        paintingDesktop = desktop;
+        ScreenPaintData d;
+        effects->paintScreen(PAINT_SCREEN_TRANSFORMED | PAINT_SCREEN_BACKGROUND_FIRST, infiniteRegion(), d);
+        m_renderingDesktopCache = false;
+        GLRenderTarget::popRenderTarget();
+        // regenerates the mipmaps the scaled down desktop is sampled from
+        cache.texture->setDirty();
+        cache.dirty = false;
+    }
+
+    const double progress = timeline.currentValue();
+    const float brightness = 1.0 - (0.3 * (1.0 - hoverTimeline[desktop - 1]->currentValue()));
+    const QSize virtualSize = effects->virtualScreenSize();
+
+    ShaderBinder binder(ShaderManager::SimpleShader);
+    GLShader *shader = binder.shader();
+    shader->setUniform(GLShader::Offset, QVector2D(0, 0));
+    shader->setUniform(GLShader::ModulationConstant, QVector4D(brightness, brightness, brightness, 1.0));
+    shader->setUniform(GLShader::Saturation, 1.0f);
+    cache.texture->bind();
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    for (int screen = 0; screen < effects->numScreens(); screen++) {
+        const QRect screenGeom = effects->clientArea(ScreenArea, screen, 0);
+        const QPointF topLeft = scalePos(screenGeom.topLeft(), desktop, screen);
+        const QPointF bottomRight = topLeft + QPointF(
+            interpolate(screenGeom.width(), scaledSize[screen].width(), progress),
+            interpolate(screenGeom.height(), scaledSize[screen].height(), progress));
+        const float verts[ 4 * 2 ] = {
+            float(topLeft.x()), float(topLeft.y()),
+            float(topLeft.x()), float(bottomRight.y()),
+            float(bottomRight.x()), float(topLeft.y()),
+            float(bottomRight.x()), float(bottomRight.y())
+        };
+        // the content of the render target is upside down
+        const float left = float(screenGeom.x()) / virtualSize.width();
+        const float right = float(screenGeom.x() + screenGeom.width()) / virtualSize.width();
+        const float top = 1.0f - float(screenGeom.y()) / virtualSize.height();
+        const float bottom = 1.0f - float(screenGeom.y() + screenGeom.height()) / virtualSize.height();
+        const float texcoords[ 4 * 2 ] = {
+            left, top,
+            left, bottom,
+            right, top,
+            right, bottom
+        };
+        vbo->reset();
+        vbo->setData(4, 2, verts, texcoords);
+        vbo->render(region, GL_TRIANGLE_STRIP);
+    }
+    cache.texture->unbind();
+}
+
 } // namespace
 
 #include "desktopgrid.moc"
@@ -24,12 +24,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <kwineffects.h>
 #include <QObject>
+#include <QSet>
 #include <QTimeLine>
 #include <QQuickView>
 
 namespace KWin
 {
 
+class GLRenderTarget;
+class GLTexture;
 class PresentWindowsEffectProxy;
 
 class DesktopButtonsView : public QQuickView
@@ -107,6 +110,9 @@ private Q_SLOTS:
     void slotWindowDeleted(KWin::EffectWindow *w);
     void slotNumberDesktopsChanged(uint old);
     void slotWindowGeometryShapeChanged(KWin::EffectWindow *w, const QRect &old);
+    void slotWindowContentChanged(KWin::EffectWindow *w);
+    void slotDesktopPresenceChanged(KWin::EffectWindow *w, int oldDesktop, int newDesktop);
+    void slotStackingOrderChanged();
 
 private:
     QPointF scalePos(const QPoint& pos, int desktop, int screen = -1) const;
@@ -129,6 +135,12 @@ private:
     QRectF moveGeometryToDesktop(int desktop) const;
     void desktopsAdded(int old);
     void desktopsRemoved(int old);
+    void setupDesktopCache();
+    bool appendDesktopCache(const QSize &size);
+    void discardDesktopCache();
+    bool isUsingDesktopCache() const;
+    void invalidateDesktopCache(int desktop);
+    void paintCachedDesktop(int desktop, const QRegion &region);
 
     QList<ElectricBorder> borderActivate;
     int zoomDuration;
@@ -172,6 +184,17 @@ private:
     QPoint m_windowMoveStartPoint;
 
     QHash< DesktopButtonsView*, EffectWindow* > m_desktopButtonsViews;
+    // the windows of m_desktopButtonsViews, looked up for every painted window
+    QSet< EffectWindow* > m_desktopButtonsWindows;
+
+    // Offscreen copies of the desktops, only re-rendered when their content got damaged
+    struct DesktopCache {
+        GLTexture *texture;
+        GLRenderTarget *target;
+        bool dirty;
+    };
+    QList<DesktopCache> m_desktopCache;
+    bool m_renderingDesktopCache;
 
 };
 
@@ -64,6 +64,9 @@ namespace KWin
 
 extern int currentRefreshRate();
 
+// Minimum time in ms between two caption updates caused by property changes of a client
+static const int CAPTION_UPDATE_INTERVAL = 200;
+
 // ****************************************
 // Workspace
 // ****************************************
@@ -234,16 +237,8 @@ bool Workspace::workspaceEvent(xcb_generic_event_t *e)
 
     const xcb_window_t eventWindow = findEventWindow(e);
     if (eventWindow != XCB_WINDOW_NONE) {
-        if (Client* c = findClient(Predicate::WindowMatch, eventWindow)) {
-            if (c->windowEvent(e))
-                return true;
-        } else if (Client* c = findClient(Predicate::WrapperIdMatch, eventWindow)) {
-            if (c->windowEvent(e))
-                return true;
-        } else if (Client* c = findClient(Predicate::FrameIdMatch, eventWindow)) {
-            if (c->windowEvent(e))
-                return true;
-        } else if (Client *c = findClient(Predicate::InputIdMatch, eventWindow)) {
+        // Client, wrapper, frame and input windows of a client all dispatch to the client
+        if (Client *c = m_clientWindows.find(eventWindow)) {
             if (c->windowEvent(e))
                 return true;
         } else if (Unmanaged* c = findUnmanaged(eventWindow)) {
@@ -489,15 +484,15 @@ bool Client::windowEvent(xcb_generic_event_t *e)
         info->event(e, &dirtyProperties, &dirtyProperties2);   // pass through the NET stuff
 
         if ((dirtyProperties & NET::WMName) != 0)
-            fetchName();
+            schedulePropertyFetch(FetchName);
         if ((dirtyProperties & NET::WMIconName) != 0)
-            fetchIconicName();
+            schedulePropertyFetch(FetchIconicName);
         if ((dirtyProperties & NET::WMStrut) != 0
                 || (dirtyProperties2 & NET::WM2ExtendedStrut) != 0) {
             workspace()->updateClientArea();
         }
         if ((dirtyProperties & NET::WMIcon) != 0)
-            getIcons();
+            schedulePropertyFetch(FetchIcons);
         // Note there's a difference between userTime() and info->userTime()
         // info->userTime() is the value of the property, userTime() also includes
         // updates of the time done by KWin (ButtonPress on windowrapper etc.).
@@ -639,6 +634,10 @@ bool Client::mapRequestEvent(xcb_map_request_event_t *e)
             return false;
         return true; // no messing with frame etc.
     }
+    // the request depends on the size hints, the transient parent and the input hints,
+    // so their changes from the same batch of events are read first
+    if (m_pendingPropertyFetches & ~FetchCaption)
+        fetchPendingProperties();
     // also copied in clientMessage()
     if (isMinimized())
         unminimize();
@@ -729,6 +728,10 @@ void Client::configureRequestEvent(xcb_configure_request_event_t *e)
 {
     if (e->window != window())
         return; // ignore frame/wrapper
+    // the request depends on the size hints, the transient parent and the input hints,
+    // so their changes from the same batch of events are read first
+    if (m_pendingPropertyFetches & ~FetchCaption)
+        fetchPendingProperties();
     if (isResize() || isMove())
         return; // we have better things to do right now
 
@@ -775,28 +778,27 @@ void Client::propertyNotifyEvent(xcb_property_notify_event_t *e)
         return; // ignore frame/wrapper
     switch(e->atom) {
     case XCB_ATOM_WM_NORMAL_HINTS:
-        getWmNormalHints();
+        schedulePropertyFetch(FetchNormalHints);
         break;
     case XCB_ATOM_WM_NAME:
-        fetchName();
+        schedulePropertyFetch(FetchName);
         break;
     case XCB_ATOM_WM_ICON_NAME:
-        fetchIconicName();
+        schedulePropertyFetch(FetchIconicName);
         break;
     case XCB_ATOM_WM_TRANSIENT_FOR:
-        readTransient();
+        schedulePropertyFetch(FetchTransient);
         break;
     case XCB_ATOM_WM_HINTS:
-        getWMHints();
-        getIcons(); // because KWin::icon() uses WMHints as fallback
+        schedulePropertyFetch(FetchWMHints | FetchIcons); // because KWin::icon() uses WMHints as fallback
         break;
     default:
         if (e->atom == atoms->wm_protocols)
-            getWindowProtocols();
+            schedulePropertyFetch(FetchWindowProtocols);
         else if (e->atom == atoms->motif_wm_hints)
-            getMotifHints();
+            schedulePropertyFetch(FetchMotifHints);
         else if (e->atom == atoms->net_wm_sync_request_counter)
-            getSyncCounter();
+            schedulePropertyFetch(FetchSyncCounter);
         else if (e->atom == atoms->activities)
             checkActivities();
         else if (e->atom == atoms->kde_net_wm_block_compositing)
@@ -811,6 +813,65 @@ void Client::propertyNotifyEvent(xcb_property_notify_event_t *e)
     }
 }
 
+void Client::schedulePropertyFetch(uint fetches)
+{
+    m_pendingPropertyFetches |= fetches;
+    if (!m_propertyFetchTimer) {
+        m_propertyFetchTimer = new QTimer(this);
+        m_propertyFetchTimer->setSingleShot(true);
+        connect(m_propertyFetchTimer, &QTimer::timeout, this, &Client::fetchPendingProperties);
+    }
+    // a delayed caption update must not hold back the other properties
+    if (!m_propertyFetchTimer->isActive() || (fetches & ~FetchCaption))
+        m_propertyFetchTimer->start(0);
+}
+
+void Client::fetchPendingProperties()
+{
+    if (deleting || window() == XCB_WINDOW_NONE) {
+        m_pendingPropertyFetches = 0;
+        return;
+    }
+    uint fetches = m_pendingPropertyFetches;
+    // Clients rewriting their title many times a second would otherwise cause just as many
+    // decoration, tabbox and taskbar updates
+    if ((fetches & FetchCaption) && m_lastCaptionUpdate.isValid()
+            && !m_lastCaptionUpdate.hasExpired(CAPTION_UPDATE_INTERVAL)) {
+        fetches &= ~FetchCaption;
+        m_propertyFetchTimer->start(CAPTION_UPDATE_INTERVAL - m_lastCaptionUpdate.elapsed());
+    }
+    m_pendingPropertyFetches &= ~fetches;
+    if (!fetches)
+        return;
+
+    // Send all requests before reading any reply, so that they share one round trip
+    Xcb::TransientFor transientFor = (fetches & FetchTransient) ? fetchTransient() : Xcb::TransientFor();
+    Xcb::WMHints wmHints = (fetches & FetchWMHints) ? fetchWMHints() : Xcb::WMHints();
+    Xcb::Property protocols = (fetches & FetchWindowProtocols) ? fetchWindowProtocols() : Xcb::Property();
+    Xcb::Property motifHints = (fetches & FetchMotifHints) ? fetchMotifHints() : Xcb::Property();
+    Xcb::Property syncCounter = (fetches & FetchSyncCounter) ? fetchSyncCounter() : Xcb::Property();
+
+    if (fetches & FetchNormalHints)
+        getWmNormalHints();
+    if (fetches & FetchName)
+        fetchName();
+    if (fetches & FetchIconicName)
+        fetchIconicName();
+    if (fetches & FetchCaption)
+        m_lastCaptionUpdate.start();
+    if (fetches & FetchTransient)
+        readTransientProperty(transientFor);
+    if (fetches & FetchWMHints)
+        readWMHints(wmHints);
+    if (fetches & FetchIcons)
+        getIcons();
+    if (fetches & FetchWindowProtocols)
+        readWindowProtocols(protocols);
+    if (fetches & FetchMotifHints)
+        readMotifHints(motifHints);
+    if (fetches & FetchSyncCounter)
+        readSyncCounter(syncCounter);
+}
 
 void Client::enterNotifyEvent(xcb_enter_notify_event_t *e)
 {
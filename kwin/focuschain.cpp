@@ -18,8 +18,13 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "focuschain.h"
+#ifdef KWIN_UNIT_TEST
+#include "autotests/mock_client.h"
+#include "autotests/mock_screens.h"
+#else
 #include "client.h"
 #include "screens.h"
+#endif
 
 namespace KWin
 {
@@ -44,15 +49,15 @@ void FocusChain::remove(Client *client)
     for (DesktopChains::iterator it = m_desktopFocusChains.begin();
             it != m_desktopFocusChains.end();
             ++it) {
-        it.value().removeAll(client);
+        it.value().remove(client);
     }
-    m_mostRecentlyUsed.removeAll(client);
+    m_mostRecentlyUsed.remove(client);
 }
 
 void FocusChain::resize(uint previousSize, uint newSize)
 {
     for (uint i = previousSize + 1; i <= newSize; ++i) {
-        m_desktopFocusChains.insert(i, QList<Client*>());
+        m_desktopFocusChains.insert(i, FocusChainList());
     }
     for (uint i = previousSize; i > newSize; --i) {
         m_desktopFocusChains.remove(i);
@@ -70,9 +75,8 @@ Client *FocusChain::getForActivation(uint desktop, int screen) const
     if (it == m_desktopFocusChains.constEnd()) {
         return NULL;
     }
-    const QList<Client*> &chain = it.value();
-    for (int i = chain.size() - 1; i >= 0; --i) {
-        Client *tmp = chain.at(i);
+    const FocusChainList &chain = it.value();
+    for (Client *tmp = chain.last(); tmp; tmp = chain.previous(tmp)) {
         // TODO: move the check into Client
         if (tmp->isShown(false) && tmp->isOnCurrentActivity()
             && ( !m_separateScreenFocus || tmp->screen() == screen)) {
@@ -95,7 +99,7 @@ void FocusChain::update(Client *client, FocusChain::Change change)
         for (DesktopChains::iterator it = m_desktopFocusChains.begin();
                 it != m_desktopFocusChains.end();
                 ++it) {
-            QList<Client*> &chain = it.value();
+            FocusChainList &chain = it.value();
             // Making first/last works only on current desktop, don't affect all desktops
             if (it.key() == m_currentDesktop
                     && (change == MakeFirst || change == MakeLast)) {
@@ -113,11 +117,11 @@ void FocusChain::update(Client *client, FocusChain::Change change)
         for (DesktopChains::iterator it = m_desktopFocusChains.begin();
                 it != m_desktopFocusChains.end();
                 ++it) {
-            QList<Client*> &chain = it.value();
+            FocusChainList &chain = it.value();
             if (client->isOnDesktop(it.key())) {
                 updateClientInChain(client, change, chain);
             } else {
-                chain.removeAll(client);
+                chain.remove(client);
             }
         }
     }
@@ -126,7 +130,7 @@ void FocusChain::update(Client *client, FocusChain::Change change)
     updateClientInChain(client, change, m_mostRecentlyUsed);
 }
 
-void FocusChain::updateClientInChain(Client *client, FocusChain::Change change, QList< Client * >& chain)
+void FocusChain::updateClientInChain(Client *client, FocusChain::Change change, FocusChainList &chain)
 {
     if (change == MakeFirst) {
         makeFirstInChain(client, chain);
@@ -137,15 +141,15 @@ void FocusChain::updateClientInChain(Client *client, FocusChain::Change change,
     }
 }
 
-void FocusChain::insertClientIntoChain(Client *client, QList< Client * >& chain)
+void FocusChain::insertClientIntoChain(Client *client, FocusChainList &chain)
 {
     if (chain.contains(client)) {
         return;
     }
     if (m_activeClient && m_activeClient != client &&
-            !chain.empty() && chain.last() == m_activeClient) {
+            !chain.isEmpty() && chain.last() == m_activeClient) {
         // Add it after the active client
-        chain.insert(chain.size() - 1, client);
+        chain.insertBefore(m_activeClient, client);
     } else {
         // Otherwise add as the first one
         chain.append(client);
@@ -169,19 +173,19 @@ void FocusChain::moveAfterClient(Client *client, Client *reference)
     moveAfterClientInChain(client, reference, m_mostRecentlyUsed);
 }
 
-void FocusChain::moveAfterClientInChain(Client *client, Client *reference, QList<Client *> &chain)
+void FocusChain::moveAfterClientInChain(Client *client, Client *reference, FocusChainList &chain)
 {
     if (!chain.contains(reference)) {
         return;
     }
     if (Client::belongToSameApplication(reference, client)) {
-        chain.removeAll(client);
-        chain.insert(chain.indexOf(reference), client);
+        chain.remove(client);
+        chain.insertBefore(reference, client);
     } else {
-        chain.removeAll(client);
-        for (int i = chain.size() - 1; i >= 0; --i) {
-            if (Client::belongToSameApplication(reference, chain.at(i))) {
-                chain.insert(i, client);
+        chain.remove(client);
+        for (Client *c = chain.last(); c; c = chain.previous(c)) {
+            if (Client::belongToSameApplication(reference, c)) {
+                chain.insertBefore(c, client);
                 break;
             }
         }
@@ -201,11 +205,10 @@ Client *FocusChain::nextMostRecentlyUsed(Client *reference) const
     if (m_mostRecentlyUsed.isEmpty()) {
         return NULL;
     }
-    const int index = m_mostRecentlyUsed.indexOf(reference);
-    if (index == -1 || index == 0) {
+    if (!m_mostRecentlyUsed.contains(reference) || reference == m_mostRecentlyUsed.first()) {
         return m_mostRecentlyUsed.last();
     }
-    return m_mostRecentlyUsed.at(index - 1);
+    return m_mostRecentlyUsed.previous(reference);
 }
 
 // copied from activation.cpp
@@ -222,9 +225,8 @@ Client *FocusChain::nextForDesktop(Client *reference, uint desktop) const
     if (it == m_desktopFocusChains.end()) {
         return NULL;
     }
-    const QList<Client*> &chain = it.value();
-    for (int i = chain.size() - 1; i >= 0; --i) {
-        Client* client = chain.at(i);
+    const FocusChainList &chain = it.value();
+    for (Client *client = chain.last(); client; client = chain.previous(client)) {
         if (isUsableFocusCandidate(client, reference)) {
             return client;
         }
@@ -232,13 +234,13 @@ Client *FocusChain::nextForDesktop(Client *reference, uint desktop) const
     return NULL;
 }
 
-void FocusChain::makeFirstInChain(Client *client, QList< Client * >& chain)
+void FocusChain::makeFirstInChain(Client *client, FocusChainList &chain)
 {
-    chain.removeAll(client);
+    chain.remove(client);
     if (client->isMinimized()) { // add it before the first minimized ...
-        for (int i = chain.count()-1; i >= 0; --i) {
-            if (chain.at(i)->isMinimized()) {
-                chain.insert(i+1, client);
+        for (Client *c = chain.last(); c; c = chain.previous(c)) {
+            if (c->isMinimized()) {
+                chain.insertAfter(c, client);
                 return;
             }
         }
@@ -248,9 +250,9 @@ void FocusChain::makeFirstInChain(Client *client, QList< Client * >& chain)
     }
 }
 
-void FocusChain::makeLastInChain(Client *client, QList< Client * >& chain)
+void FocusChain::makeLastInChain(Client *client, FocusChainList &chain)
 {
-    chain.removeAll(client);
+    chain.remove(client);
     chain.prepend(client);
 }
 
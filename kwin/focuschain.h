@@ -30,6 +30,127 @@ namespace KWin
 // forward declarations
 class Client;
 
+/**
+ * @brief Ordered list of Clients used for a single focus chain.
+ *
+ * The list is doubly linked through an index from each Client to its neighbours, so looking up,
+ * inserting and removing a Client are constant time operations, independent of the length of
+ * the chain. Apart from that it behaves like a QList: first() is the item at the front and last()
+ * the one at the back. The Clients are only stored, never dereferenced.
+ **/
+class FocusChainList
+{
+public:
+    FocusChainList()
+        : m_first(nullptr)
+        , m_last(nullptr)
+    {
+    }
+
+    bool isEmpty() const {
+        return m_first == nullptr;
+    }
+    int count() const {
+        return m_links.count();
+    }
+    bool contains(Client *client) const {
+        return m_links.contains(client);
+    }
+    Client *first() const {
+        return m_first;
+    }
+    Client *last() const {
+        return m_last;
+    }
+    /**
+     * @returns The Client in front of @p client or @c null if @p client is the first one.
+     **/
+    Client *previous(Client *client) const {
+        return m_links.value(client).previous;
+    }
+    /**
+     * @returns The Client behind @p client or @c null if @p client is the last one.
+     **/
+    Client *next(Client *client) const {
+        return m_links.value(client).next;
+    }
+    void append(Client *client) {
+        insertAfter(m_last, client);
+    }
+    void prepend(Client *client) {
+        insertBefore(m_first, client);
+    }
+    /**
+     * Inserts @p client in front of @p reference, which has to be in the list. If @p reference
+     * is @c null, @p client is appended.
+     **/
+    void insertBefore(Client *reference, Client *client) {
+        Q_ASSERT(!contains(client));
+        Links links;
+        links.next = reference;
+        links.previous = reference ? m_links.value(reference).previous : m_last;
+        m_links.insert(client, links);
+        link(client, links);
+    }
+    /**
+     * Inserts @p client behind @p reference, which has to be in the list. If @p reference
+     * is @c null, @p client is prepended.
+     **/
+    void insertAfter(Client *reference, Client *client) {
+        Q_ASSERT(!contains(client));
+        Links links;
+        links.previous = reference;
+        links.next = reference ? m_links.value(reference).next : m_first;
+        m_links.insert(client, links);
+        link(client, links);
+    }
+    /**
+     * Removes @p client from the list.
+     * @returns @c true if @p client was in the list.
+     **/
+    bool remove(Client *client) {
+        const auto it = m_links.constFind(client);
+        if (it == m_links.constEnd()) {
+            return false;
+        }
+        const Links links = it.value();
+        m_links.erase(it);
+        if (links.previous) {
+            m_links[links.previous].next = links.next;
+        } else {
+            m_first = links.next;
+        }
+        if (links.next) {
+            m_links[links.next].previous = links.previous;
+        } else {
+            m_last = links.previous;
+        }
+        return true;
+    }
+
+private:
+    struct Links {
+        Links() : previous(nullptr), next(nullptr) {}
+        Client *previous;
+        Client *next;
+    };
+    void link(Client *client, const Links &links) {
+        if (links.previous) {
+            m_links[links.previous].next = client;
+        } else {
+            m_first = client;
+        }
+        if (links.next) {
+            m_links[links.next].previous = client;
+        } else {
+            m_last = client;
+        }
+    }
+    QHash<Client*, Links> m_links;
+    Client *m_first;
+    Client *m_last;
+};
+
 /**
  * @brief Singleton class to handle the various focus chains.
  *
@@ -37,7 +158,7 @@ class Client;
  *
  * Internally this FocusChain holds multiple independent chains. There is one chain of most recently
  * used Clients which is primarily used by TabBox to build up the list of Clients for navigation.
- * The chains are organized as a normal QList of Clients with the most recently used Client being the
+ * The chains are organized as a FocusChainList of Clients with the most recently used Client being the
  * last item of the list, that is a LIFO like structure.
  *
  * In addition there is one chain for each virtual desktop which is used to determine which Client
@@ -199,7 +320,7 @@ private:
      * @param chain The focus chain to operate on
      * @return void
      **/
-    void makeFirstInChain(Client *client, QList<Client*> &chain);
+    void makeFirstInChain(Client *client, FocusChainList &chain);
     /**
      * @brief Makes @p client the last Client in the given focus @p chain.
      *
@@ -210,12 +331,12 @@ private:
      * @param chain The focus chain to operate on
      * @return void
      **/
-    void makeLastInChain(Client *client, QList<Client*> &chain);
-    void moveAfterClientInChain(Client *client, Client *reference, QList<Client*> &chain);
-    void updateClientInChain(Client *client, Change change, QList<Client*> &chain);
-    void insertClientIntoChain(Client *client, QList<Client*> &chain);
-    typedef QHash<uint, QList<Client*> > DesktopChains;
-    QList<Client*> m_mostRecentlyUsed;
+    void makeLastInChain(Client *client, FocusChainList &chain);
+    void moveAfterClientInChain(Client *client, Client *reference, FocusChainList &chain);
+    void updateClientInChain(Client *client, Change change, FocusChainList &chain);
+    void insertClientIntoChain(Client *client, FocusChainList &chain);
+    typedef QHash<uint, FocusChainList> DesktopChains;
+    FocusChainList m_mostRecentlyUsed;
     DesktopChains m_desktopFocusChains;
     bool m_separateScreenFocus;
     Client *m_activeClient;
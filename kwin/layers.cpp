@@ -85,6 +85,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "group.h"
 #include "rules.h"
 #include "screens.h"
+#include "stackingorder.h"
 #include "unmanaged.h"
 #include "deleted.h"
 #include "effects.h"
@@ -118,6 +119,10 @@ void Workspace::updateStackingOrder(bool propagate_new_clients)
     }
     ToplevelList new_stacking_order = constrainedStackingOrder();
     bool changed = (force_restacking || new_stacking_order != stacking_order);
+    if (force_restacking) {
+        // restack all windows instead of only the ones which moved
+        propagated_window_stack.clear();
+    }
     force_restacking = false;
     stacking_order = new_stacking_order;
 #if 0
@@ -175,6 +180,8 @@ void Workspace::propagateClients(bool propagate_new_clients)
 #ifdef KWIN_BUILD_SCREENEDGES
     newWindowStack << ScreenEdges::self()->windows();
 #endif
+    // effects may raise the screen edges, so they are always restacked
+    const int fixedWindows = newWindowStack.size();
 
     newWindowStack.reserve(newWindowStack.size() + 2*stacking_order.size()); // *2 for inputWindow
 
@@ -200,10 +207,16 @@ void Workspace::propagateClients(bool propagate_new_clients)
             continue;
         newWindowStack << client->frameId();
     }
-    // TODO isn't it too inefficient to restack always all clients?
     // TODO don't restack not visible windows?
     assert(newWindowStack.at(0) == rootInfo()->supportWindow());
-    Xcb::restackWindows(newWindowStack);
+    if (propagated_window_stack.isEmpty()) {
+        Xcb::restackWindows(newWindowStack);
+    } else {
+        // only restack the windows which moved relative to the others, raising a window
+        // thus results in a single request instead of one for every window
+        Xcb::restackWindows(newWindowStack, restackDelta(propagated_window_stack, newWindowStack, fixedWindows));
+    }
+    propagated_window_stack = newWindowStack;
 
     int pos = 0;
     xcb_window_t *cl(nullptr);
@@ -537,64 +550,45 @@ ToplevelList Workspace::constrainedStackingOrder()
         qDebug() << (void*)(*it) << *it << ":" << (*it)->layer();
 #endif
     // now keep transients above their mainwindows
-    // TODO this could(?) use some optimization
-    for (int i = stacking.size() - 1;
-            i >= 0;
-       ) {
-        Client *current = qobject_cast<Client*>(stacking[i]);
+    QHash<Toplevel*, int> indices;
+    indices.reserve(stacking.size());
+    for (int i = 0; i < stacking.size(); ++i) {
+        indices.insert(stacking.at(i), i);
+    }
+    TransientStacking transients(stacking.size());
+    for (int i = 0; i < stacking.size(); ++i) {
+        Client *current = qobject_cast<Client*>(stacking.at(i));
         if (!current || !current->isTransient()) {
-            --i;
             continue;
         }
-        int i2 = -1;
         if (current->groupTransient()) {
-            if (current->group()->members().count() > 0) {
-                // find topmost client this one is transient for
-                for (i2 = stacking.size() - 1;
-                        i2 >= 0;
-                        --i2) {
-                    if (stacking[ i2 ] == stacking[ i ]) {
-                        i2 = -1; // don't reorder, already the topmost in the group
-                        break;
-                    }
-                    Client *c2 = qobject_cast<Client*>(stacking[ i2 ]);
-                    if (!c2) {
-                        continue;
-                    }
-                    if (c2->hasTransient(current, true)
-                            && keepTransientAbove(c2, current))
-                        break;
-                }
-            } // else i2 remains pointing at -1
-        } else {
-            for (i2 = stacking.size() - 1;
-                    i2 >= 0;
-                    --i2) {
-                Client *c2 = qobject_cast<Client*>(stacking[ i2 ]);
-                if (!c2) {
+            // group transients stay above the topmost client they are transient for
+            foreach (Client *c2, current->group()->members()) {
+                if (c2 == current || !keepTransientAbove(c2, current) || !c2->hasTransient(current, true)) {
                     continue;
                 }
-                if (c2 == current) {
-                    i2 = -1; // don't reorder, already on top of its mainwindow
-                    break;
+                const auto it = indices.constFind(c2);
+                if (it != indices.constEnd()) {
+                    transients.addMainWindow(i, it.value());
                 }
-                if (c2 == current->transientFor()
-                        && keepTransientAbove(c2, current))
-                    break;
+            }
+        } else if (Client *mainwindow = current->transientFor()) {
+            if (!keepTransientAbove(mainwindow, current)) {
+                continue;
+            }
+            const auto it = indices.constFind(mainwindow);
+            if (it != indices.constEnd()) {
+                transients.addMainWindow(i, it.value());
             }
         }
-        if (i2 == -1) {
-            --i;
-            continue;
-        }
-        stacking.removeAt(i);
-        --i; // move onto the next item (for next for () iteration)
-        --i2; // adjust index of the mainwindow after the remove above
-        if (!current->transients().isEmpty())   // this one now can be possibly above its transients,
-            i = i2; // so go again higher in the stack order and possibly move those transients again
-        ++i2; // insert after (on top of) the mainwindow, it's ok if it2 is now stacking.end()
-        stacking.insert(i2, current);
     }
+    const QVector<int> order = transients.order();
+    ToplevelList constrained;
+    constrained.reserve(order.size());
+    for (int i : order) {
+        constrained.append(stacking.at(i));
+    }
+    stacking = constrained;
 #if 0
     qDebug() << "stacking3:";
     for (ClientList::ConstIterator it = stacking.begin();
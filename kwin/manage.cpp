@@ -69,14 +69,22 @@ bool Client::manage(xcb_window_t w, bool isMapped)
     vis = attr.visual;
     bit_depth = attr.depth;
 
+    // Send all property requests up front and only read the replies when they are needed,
+    // so that managing a window costs one round trip instead of one per property
+    Xcb::Property resourceClassCookie = fetchResourceClass();
+    Xcb::Property windowRoleCookie = fetchWindowRole();
+    Xcb::Property wmClientLeaderCookie = fetchWmClientLeader();
+    Xcb::Property syncCounterCookie = fetchSyncCounter();
+    Xcb::WMHints wmHintsCookie = fetchWMHints();
+    Xcb::TransientFor transientCookie = fetchTransient();
+    Xcb::Property protocolsCookie = fetchWindowProtocols();
+    Xcb::Property motifHintsCookie = fetchMotifHints();
+    Xcb::Property opaqueRegionCookie = fetchWmOpaqueRegion();
+    Xcb::Property skipCloseAnimationCookie = fetchSkipCloseAnimation();
+
     // SELI TODO: Order all these things in some sane manner
 
-    bool init_minimize = false;
-    XWMHints* hints = XGetWMHints(display(), w);
-    if (hints && (hints->flags & StateHint) && hints->initial_state == IconicState)
-        init_minimize = true;
-    if (hints)
-        XFree(hints);
+    bool init_minimize = wmHintsCookie.isInitiallyIconic();
     if (isMapped)
         init_minimize = false; // If it's already mapped, ignore hint
 
@@ -102,11 +110,11 @@ bool Client::manage(xcb_window_t w, bool isMapped)
 
     m_colormap = attr.colormap;
 
-    getResourceClass();
-    getWindowRole();
-    getWmClientLeader();
+    readResourceClass(resourceClassCookie);
+    readWindowRole(windowRoleCookie);
+    readWmClientLeader(wmClientLeaderCookie);
     getWmClientMachine();
-    getSyncCounter();
+    readSyncCounter(syncCounterCookie);
     // First only read the caption text, so that setupWindowRules() can use it for matching,
     // and only then really set the caption using setCaption(), which checks for duplicates etc.
     // and also relies on rules already existing
@@ -119,15 +127,15 @@ bool Client::manage(xcb_window_t w, bool isMapped)
     detectShape(window());
     detectNoBorder();
     fetchIconicName();
-    getWMHints(); // Needs to be done before readTransient() because of reading the group
+    readWMHints(wmHintsCookie); // Needs to be done before readTransient() because of reading the group
     modal = (info->state() & NET::Modal) != 0;   // Needs to be valid before handling groups
-    readTransient();
+    readTransientProperty(transientCookie);
     getIcons();
-    getWindowProtocols();
+    readWindowProtocols(protocolsCookie);
     getWmNormalHints(); // Get xSizeHint
-    getMotifHints();
-    getWmOpaqueRegion();
-    getSkipCloseAnimation();
+    readMotifHints(motifHintsCookie);
+    readWmOpaqueRegion(opaqueRegionCookie);
+    readSkipCloseAnimation(skipCloseAnimationCookie);
 
     // TODO: Try to obey all state information from info->state()
 
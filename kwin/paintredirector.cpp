@@ -85,6 +85,7 @@ void PaintRedirector::performPendingPaint()
         return;
     }
     //qDebug() << "### performing paint, pending:" << pending.boundingRect();
+    pending = paintRegion(pending);
     const QSize size = pending.boundingRect().size();
     QPaintDevice *scratch = this->scratch();
     if (scratch->width() < size.width() || scratch->height() < size.height()) {
@@ -94,7 +95,8 @@ void PaintRedirector::performPendingPaint()
     }
     fillScratch(Qt::transparent);
     recursionCheck = true;
-    m_decoration->render(scratch, pending.boundingRect());
+    // only the damaged parts, e.g. the caption or a button, get repainted
+    m_decoration->render(scratch, pending);
     recursionCheck = false;
     cleanupTimer.start(2000, this);
 }
@@ -394,14 +396,15 @@ void OpenGLPaintRedirector::updatePixmaps(const QRect *rects, const QRegion &reg
     QPoint offsets[4] = { QPoint(0, 0), QPoint(leftWidth, 0), QPoint(0, topHeight), QPoint(0, 0) };
 
     for (int i = 0; i < 4; i++) {
-        const QRect dirty = (region & rects[i]).boundingRect();
-        if (!textures[i] || dirty.isEmpty())
+        if (!textures[i])
             continue;
 
-        const QPoint dst = dirty.topLeft() - rects[i].topLeft() + offsets[i];
-        const QRect src(dirty.topLeft() - bounding.topLeft(), dirty.size());
+        foreach (const QRect &dirty, (region & rects[i]).rects()) {
+            const QPoint dst = dirty.topLeft() - rects[i].topLeft() + offsets[i];
+            const QRect src(dirty.topLeft() - bounding.topLeft(), dirty.size());
 
-        textures[i]->update(image, dst, src);
+            textures[i]->update(image, dst, src);
+        }
     }
 }
 
@@ -465,17 +468,18 @@ void RasterXRenderPaintRedirector::preparePaint(const QPixmap &pending)
 
 void RasterXRenderPaintRedirector::paint(PaintRedirector::DecorationPixmap border, const QRect &r, const QRect &b, const QRegion &reg)
 {
-    // clip the sub area
-    const QRect bounding = reg.boundingRect();
-    const QPoint offset = bounding.topLeft() - r.topLeft();
     if (m_gc == 0) {
         m_gc = xcb_generate_id(connection());
         xcb_create_gc(connection(), m_gc, m_pixmaps[border], 0, NULL);
     }
 
-    const QImage img(scratchImage().copy(QRect(bounding.topLeft() - b.topLeft(), bounding.size())));
-    xcb_put_image(connection(), XCB_IMAGE_FORMAT_Z_PIXMAP, m_pixmaps[border], m_gc,
-                  img.width(), img.height(), offset.x(), offset.y(), 0, 32, img.byteCount(), img.constBits());
+    // clip the sub areas
+    foreach (const QRect &dirty, reg.rects()) {
+        const QPoint offset = dirty.topLeft() - r.topLeft();
+        const QImage img(scratchImage().copy(QRect(dirty.topLeft() - b.topLeft(), dirty.size())));
+        xcb_put_image(connection(), XCB_IMAGE_FORMAT_Z_PIXMAP, m_pixmaps[border], m_gc,
+                      img.width(), img.height(), offset.x(), offset.y(), 0, 32, img.byteCount(), img.constBits());
+    }
 }
 
 QImagePaintRedirector::QImagePaintRedirector(Client *c, KDecoration *deco)
@@ -490,13 +494,13 @@ QImagePaintRedirector::~QImagePaintRedirector()
 
 void QImagePaintRedirector::paint(PaintRedirector::DecorationPixmap border, const QRect &r, const QRect &b, const QRegion &reg)
 {
-    // clip the sub area
-    const QRect bounding = reg.boundingRect();
-    const QPoint offset = bounding.topLeft() - r.topLeft();
-
     QPainter painter(&m_images[border]);
     painter.setCompositionMode(QPainter::CompositionMode_Source);
-    painter.drawImage(offset, scratchImage(), QRect(bounding.topLeft() - b.topLeft(), bounding.size()));
+    // clip the sub areas
+    foreach (const QRect &dirty, reg.rects()) {
+        const QPoint offset = dirty.topLeft() - r.topLeft();
+        painter.drawImage(offset, scratchImage(), QRect(dirty.topLeft() - b.topLeft(), dirty.size()));
+    }
 }
 
 void QImagePaintRedirector::resize(PaintRedirector::DecorationPixmap border, const QSize &size)
@@ -90,6 +90,16 @@ public:
 
     void addRepaint(const QRegion &region);
 
+    enum { MaxPendingRects = 8 };
+    /**
+     * The region the decoration gets repainted in for the @p damage: the damage itself, or its
+     * bounding rect once it consists of more than MaxPendingRects rects. Each rect gets uploaded
+     * or blitted on its own, so this bounds the per rect overhead.
+     **/
+    static QRegion paintRegion(const QRegion &damage) {
+        return damage.rectCount() > MaxPendingRects ? QRegion(damage.boundingRect()) : damage;
+    }
+
 public Q_SLOTS:
     void ensurePixmapsPainted();
 protected:
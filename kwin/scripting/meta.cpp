@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 
 #include "meta.h"
+#include "scripting.h"
 #include "client.h"
 
 #include <QtScript/QScriptEngine>
@@ -124,6 +125,22 @@ void Toplevel::fromScriptValue(const QScriptValue &value, KToplevelRef &client)
     client = qobject_cast<KWin::Toplevel*>(value.toQObject());
 }
 
+QScriptValue ClientList::toScriptValue(QScriptEngine *eng, const QList<KWin::Client*> &clients)
+{
+    // scripts keep the wrappers of the clients around, engines of effects just look them up
+    KWin::Script *script = qobject_cast<KWin::Script*>(eng->parent());
+    QScriptValue array = eng->newArray(clients.count());
+    for (int i = 0; i < clients.count(); ++i) {
+        array.setProperty(i, script ? script->clientWrapper(clients.at(i)) : Client::toScriptValue(eng, clients.at(i)));
+    }
+    return array;
+}
+
+void ClientList::fromScriptValue(const QScriptValue &value, QList<KWin::Client*> &clients)
+{
+    qScriptValueToSequence(value, clients);
+}
+
 // Other helper functions
 void KWin::MetaScripting::registration(QScriptEngine* eng)
 {
@@ -134,7 +151,7 @@ void KWin::MetaScripting::registration(QScriptEngine* eng)
     qScriptRegisterMetaType<KToplevelRef>(eng, Toplevel::toScriptValue, Toplevel::fromScriptValue);
 
     qScriptRegisterSequenceMetaType<QStringList>(eng);
-    qScriptRegisterSequenceMetaType< QList<KWin::Client*> >(eng);
+    qScriptRegisterMetaType< QList<KWin::Client*> >(eng, ClientList::toScriptValue, ClientList::fromScriptValue);
 }
 
 QScriptValue KWin::MetaScripting::configExists(QScriptContext* ctx, QScriptEngine* eng)
@@ -87,6 +87,15 @@ QScriptValue toScriptValue(QScriptEngine *eng, const KToplevelRef &client);
 void fromScriptValue(const QScriptValue &value, KToplevelRef& client);
 }
 
+/**
+  * Conversion functions for the list of Clients, reusing the wrappers cached by the Script.
+  */
+namespace ClientList
+{
+QScriptValue toScriptValue(QScriptEngine *eng, const QList<KWin::Client*> &clients);
+void fromScriptValue(const QScriptValue &value, QList<KWin::Client*> &clients);
+}
+
 /**
   * Merges the second QScriptValue in the first one.
   */
@@ -430,9 +430,18 @@ KWin::Script::Script(int id, QString scriptName, QString pluginName, QObject* pa
     : AbstractScript(id, scriptName, pluginName, parent)
     , m_engine(new QScriptEngine(this))
     , m_starting(false)
-    , m_agent(new ScriptUnloaderAgent(this))
+    , m_agent(new ScriptAgent(this))
+    , m_invocations(0)
+    , m_abortedInvocations(0)
+    , m_totalTime(0)
+    , m_maximumTime(0)
 {
     QDBusConnection::sessionBus().registerObject(QStringLiteral("/") + QString::number(scriptId()), this, QDBusConnection::ExportScriptableContents | QDBusConnection::ExportScriptableInvokables);
+    connect(Workspace::self(), &Workspace::clientRemoved, this,
+        [this](KWin::Client *client) {
+            m_clientWrappers.remove(client);
+        }
+    );
 }
 
 KWin::Script::~Script()
@@ -512,19 +521,104 @@ void KWin::Script::sigException(const QScriptValue& exception)
     stop();
 }
 
-KWin::ScriptUnloaderAgent::ScriptUnloaderAgent(KWin::Script *script)
+QScriptValue KWin::Script::clientWrapper(KWin::Client *client)
+{
+    QHash<KWin::Client*, QScriptValue>::const_iterator it = m_clientWrappers.constFind(client);
+    if (it != m_clientWrappers.constEnd()) {
+        return it.value();
+    }
+    const QScriptValue wrapper = MetaScripting::Client::toScriptValue(m_engine, client);
+    m_clientWrappers.insert(client, wrapper);
+    return wrapper;
+}
+
+void KWin::Script::addInvocation(qint64 nsecs)
+{
+    ++m_invocations;
+    m_totalTime += nsecs;
+    m_maximumTime = qMax(m_maximumTime, nsecs);
+}
+
+void KWin::Script::watchdogTriggered(qint64 msecs)
+{
+    ++m_abortedInvocations;
+    const QString message = QStringLiteral("Script aborted after %1 msec, exceeding the execution budget").arg(msecs);
+    qDebug() << scriptFile().fileName() << ":" << message;
+    emit printError(message);
+    stop();
+}
+
+QVariantMap KWin::Script::profile() const
+{
+    QVariantMap profile;
+    profile.insert(QStringLiteral("invocations"), m_invocations);
+    profile.insert(QStringLiteral("totalTime"), m_totalTime / 1000);
+    profile.insert(QStringLiteral("maximumTime"), m_maximumTime / 1000);
+    profile.insert(QStringLiteral("abortedInvocations"), m_abortedInvocations);
+    return profile;
+}
+
+void KWin::Script::resetProfile()
+{
+    m_invocations = 0;
+    m_abortedInvocations = 0;
+    m_totalTime = 0;
+    m_maximumTime = 0;
+}
+
+KWin::ScriptAgent::ScriptAgent(KWin::Script *script)
     : QScriptEngineAgent(script->engine())
     , m_script(script)
+    , m_depth(0)
+    , m_budget(KSharedConfig::openConfig()->group("Scripting").readEntry("WatchdogBudget", 0))
+    , m_aborted(false)
 {
     script->engine()->setAgent(this);
 }
 
-void KWin::ScriptUnloaderAgent::scriptUnload(qint64 id)
+void KWin::ScriptAgent::scriptUnload(qint64 id)
 {
     Q_UNUSED(id)
     m_script->stop();
 }
 
+void KWin::ScriptAgent::functionEntry(qint64 scriptId)
+{
+    Q_UNUSED(scriptId)
+    if (m_depth++ == 0) {
+        m_timer.start();
+    }
+}
+
+void KWin::ScriptAgent::functionExit(qint64 scriptId, const QScriptValue &returnValue)
+{
+    Q_UNUSED(scriptId)
+    Q_UNUSED(returnValue)
+    if (m_depth == 0) {
+        return;
+    }
+    if (--m_depth == 0) {
+        m_script->addInvocation(m_timer.nsecsElapsed());
+    }
+}
+
+void KWin::ScriptAgent::positionChange(qint64 scriptId, int lineNumber, int columnNumber)
+{
+    Q_UNUSED(scriptId)
+    Q_UNUSED(lineNumber)
+    Q_UNUSED(columnNumber)
+    // loading the script is not limited, only the calls from the compositor
+    if (m_budget <= 0 || m_depth == 0 || m_aborted) {
+        return;
+    }
+    const qint64 elapsed = m_timer.elapsed();
+    if (elapsed > m_budget) {
+        m_aborted = true;
+        engine()->abortEvaluation();
+        m_script->watchdogTriggered(elapsed);
+    }
+}
+
 KWin::DeclarativeScript::DeclarativeScript(int id, QString scriptName, QString pluginName, QObject* parent)
     : AbstractScript(id, scriptName, pluginName, parent)
     , m_context(new QQmlContext(Scripting::self()->qmlEngine(), this))
@@ -739,6 +833,28 @@ bool KWin::Scripting::unloadScript(const QString &pluginName)
     return false;
 }
 
+QVariantMap KWin::Scripting::profile() const
+{
+    QMutexLocker locker(m_scriptsLock.data());
+    QVariantMap profile;
+    foreach (AbstractScript *script, scripts) {
+        if (Script *s = qobject_cast<Script*>(script)) {
+            profile.insert(s->pluginName(), s->profile());
+        }
+    }
+    return profile;
+}
+
+void KWin::Scripting::resetProfile()
+{
+    QMutexLocker locker(m_scriptsLock.data());
+    foreach (AbstractScript *script, scripts) {
+        if (Script *s = qobject_cast<Script*>(script)) {
+            s->resetProfile();
+        }
+    }
+}
+
 void KWin::Scripting::runScripts()
 {
     QMutexLocker locker(m_scriptsLock.data());
@@ -25,9 +25,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <kwinglobals.h>
 #include <kservice.h>
 
+#include <QElapsedTimer>
 #include <QFile>
 #include <QHash>
 #include <QStringList>
+#include <QVariantMap>
 #include <QtScript/QScriptEngineAgent>
 
 class QQmlComponent;
@@ -49,7 +51,7 @@ typedef QList< QPair<bool, QPair<QString, QString > > > LoadScriptList;
 namespace KWin
 {
 class Client;
-class ScriptUnloaderAgent;
+class ScriptAgent;
 class WorkspaceWrapper;
 
 class AbstractScript : public QObject
@@ -222,9 +224,33 @@ public:
     QScriptEngine *engine() {
         return m_engine;
     }
+    /**
+     * @brief The wrapper object of @p client in this Script's engine.
+     *
+     * The wrappers are created on first use and kept until the Client is removed, so that
+     * converting the client list does not need to look them up again for each call.
+     **/
+    QScriptValue clientWrapper(KWin::Client *client);
+
+    /**
+     * @brief Accounts one invocation of the script from the compositor taking @p nsecs.
+     **/
+    void addInvocation(qint64 nsecs);
+    /**
+     * @brief Called when an invocation exceeded the configured watchdog budget and got aborted.
+     **/
+    void watchdogTriggered(qint64 msecs);
 
 public Q_SLOTS:
     Q_SCRIPTABLE void run();
+    /**
+     * @brief Execution time statistics of this script.
+     *
+     * The map contains the number of @c invocations from the compositor, their @c totalTime and
+     * @c maximumTime in microseconds and the number of @c abortedInvocations.
+     **/
+    Q_SCRIPTABLE QVariantMap profile() const;
+    Q_SCRIPTABLE void resetProfile();
 
 Q_SIGNALS:
     Q_SCRIPTABLE void printError(const QString &text);
@@ -249,17 +275,36 @@ private:
     QByteArray loadScriptFromFile();
     QScriptEngine *m_engine;
     bool m_starting;
-    QScopedPointer<ScriptUnloaderAgent> m_agent;
+    QScopedPointer<ScriptAgent> m_agent;
+    QHash<KWin::Client*, QScriptValue> m_clientWrappers;
+    quint64 m_invocations;
+    quint64 m_abortedInvocations;
+    qint64 m_totalTime;
+    qint64 m_maximumTime;
 };
 
-class ScriptUnloaderAgent : public QScriptEngineAgent
+/**
+ * Agent installed on the engine of each Script.
+ *
+ * Stops the Script once the engine unloads it and measures how long each call into the script -
+ * a signal handler, timer or callback - takes. If a watchdog budget is configured in the
+ * "Scripting" group, a call exceeding it gets aborted and the Script is stopped.
+ **/
+class ScriptAgent : public QScriptEngineAgent
 {
 public:
-    explicit ScriptUnloaderAgent(Script *script);
+    explicit ScriptAgent(Script *script);
     virtual void scriptUnload(qint64 id);
+    virtual void functionEntry(qint64 scriptId);
+    virtual void functionExit(qint64 scriptId, const QScriptValue &returnValue);
+    virtual void positionChange(qint64 scriptId, int lineNumber, int columnNumber);
 
 private:
     Script *m_script;
+    QElapsedTimer m_timer;
+    int m_depth;
+    qint64 m_budget;
+    bool m_aborted;
 };
 
 class DeclarativeScript : public AbstractScript
@@ -343,6 +388,13 @@ public:
     Q_SCRIPTABLE Q_INVOKABLE int loadDeclarativeScript(const QString &filePath, const QString &pluginName = QString());
     Q_SCRIPTABLE Q_INVOKABLE bool isScriptLoaded(const QString &pluginName) const;
     Q_SCRIPTABLE Q_INVOKABLE bool unloadScript(const QString &pluginName);
+    /**
+     * @brief Execution time statistics of all running JavaScript scripts, indexed by plugin name.
+     *
+     * @see Script::profile
+     **/
+    Q_SCRIPTABLE Q_INVOKABLE QVariantMap profile() const;
+    Q_SCRIPTABLE Q_INVOKABLE void resetProfile();
 
     /**
      * @brief Invokes all registered callbacks to add actions to the UserActionsMenu.
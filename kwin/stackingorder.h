@@ -0,0 +1,202 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_STACKINGORDER_H
+#define KWIN_STACKINGORDER_H
+
+#include <QHash>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @brief Moves transient windows above their main windows.
+ *
+ * The windows are identified by their index in a stacking order (bottom to top), which is the
+ * layered stacking order in Workspace::constrainedStackingOrder(). Each transient which is below
+ * any of its main windows gets attached directly above the topmost one of them. Transients attached
+ * to the same main window keep their relative order and a transient is directly followed by its own
+ * attached transients. Transients which are already above all their main windows are not moved.
+ *
+ * Instead of repeatedly moving windows in the list this builds the tree of attached transients once,
+ * so computing the order is linear in the number of windows and main window relations times the
+ * depth of the transient chains. Loops in the relations are ignored.
+ **/
+class TransientStacking
+{
+public:
+    explicit TransientStacking(int count)
+        : m_mainWindows(count)
+    {
+    }
+
+    int count() const {
+        return m_mainWindows.count();
+    }
+    /**
+     * Adds the constraint that the window at @p transient has to be above the one at @p mainWindow.
+     **/
+    void addMainWindow(int transient, int mainWindow) {
+        if (transient != mainWindow) {
+            m_mainWindows[transient].append(mainWindow);
+        }
+    }
+    /**
+     * @returns The indices of the windows in the constrained stacking order, bottom to top.
+     **/
+    QVector<int> order() const;
+
+private:
+    enum State {
+        Unresolved,
+        Resolving,
+        Resolved
+    };
+    void resolve(int window, QVector<State> &states, QVector<QVector<int> > &keys, QVector<int> &parents) const;
+    QVector<QVector<int> > m_mainWindows;
+};
+
+inline QVector<int> TransientStacking::order() const
+{
+    const int windows = count();
+    // the key of a window is the path of indices from its root window down to the window, the
+    // final order is the lexicographic order of the keys, which is a pre-order walk of the tree
+    QVector<State> states(windows, Unresolved);
+    QVector<QVector<int> > keys(windows);
+    QVector<int> parents(windows, -1);
+    for (int i = 0; i < windows; ++i) {
+        resolve(i, states, keys, parents);
+    }
+
+    // children in ascending index order keep their relative stacking order
+    QVector<QVector<int> > children(windows);
+    QVector<int> stack;
+    for (int i = windows - 1; i >= 0; --i) {
+        if (parents.at(i) == -1) {
+            stack.append(i);
+        } else {
+            children[parents.at(i)].append(i);
+        }
+    }
+
+    QVector<int> result;
+    result.reserve(windows);
+    while (!stack.isEmpty()) {
+        const int window = stack.takeLast();
+        result.append(window);
+        const QVector<int> &attached = children.at(window);
+        for (int i = attached.count() - 1; i >= 0; --i) {
+            stack.append(attached.at(i));
+        }
+    }
+    return result;
+}
+
+inline void TransientStacking::resolve(int window, QVector<State> &states, QVector<QVector<int> > &keys, QVector<int> &parents) const
+{
+    if (states.at(window) != Unresolved) {
+        return;
+    }
+    states[window] = Resolving;
+    int topmost = -1;
+    for (int mainWindow : m_mainWindows.at(window)) {
+        resolve(mainWindow, states, keys, parents);
+        if (states.at(mainWindow) != Resolved) {
+            // a loop in the transient relations
+            continue;
+        }
+        if (topmost == -1 || keys.at(topmost) < keys.at(mainWindow)) {
+            topmost = mainWindow;
+        }
+    }
+    // a root window is above the complete tree of the topmost main window if its index is higher
+    // than that of the tree's root, the same index would mean it is its own main window
+    if (topmost != -1 && window < keys.at(topmost).first()) {
+        parents[window] = topmost;
+        keys[window] = keys.at(topmost);
+    }
+    keys[window].append(window);
+    states[window] = Resolved;
+}
+
+/**
+ * Computes which windows of @p stack have to be restacked if the windows have been stacked like
+ * @p previous before, both ordered from top to bottom. The windows in the longest sequence which
+ * is in the same order in both stacks keep their position, restacking the returned windows below
+ * their predecessor in the given order results in @p stack. Windows of @p previous which are no
+ * longer in @p stack are ignored.
+ *
+ * The first @p fixed windows and the one directly below them are always restacked.
+ *
+ * @returns The indices into @p stack of the windows to restack.
+ **/
+template <typename T>
+QVector<int> restackDelta(const QVector<T> &previous, const QVector<T> &stack, int fixed = 0)
+{
+    QHash<T, int> previousIndex;
+    previousIndex.reserve(previous.count());
+    for (int i = 0; i < previous.count(); ++i) {
+        previousIndex.insert(previous.at(i), i);
+    }
+    QVector<int> keys(stack.count(), -1);
+    for (int i = fixed + 1; i < stack.count(); ++i) {
+        keys[i] = previousIndex.value(stack.at(i), -1);
+    }
+
+    // longest increasing subsequence of the previous positions: tails[k] is the window ending the
+    // sequence of length k + 1 with the lowest previous position, links the window before it
+    QVector<int> tails;
+    QVector<int> links(stack.count(), -1);
+    for (int i = fixed + 1; i < stack.count(); ++i) {
+        if (keys.at(i) == -1) {
+            continue;
+        }
+        int low = 0;
+        int high = tails.count();
+        while (low < high) {
+            const int middle = (low + high) / 2;
+            if (keys.at(tails.at(middle)) < keys.at(i)) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        links[i] = low > 0 ? tails.at(low - 1) : -1;
+        if (low == tails.count()) {
+            tails.append(i);
+        } else {
+            tails[low] = i;
+        }
+    }
+    QVector<bool> kept(stack.count(), false);
+    for (int i = tails.isEmpty() ? -1 : tails.last(); i != -1; i = links.at(i)) {
+        kept[i] = true;
+    }
+
+    QVector<int> delta;
+    for (int i = 1; i < stack.count(); ++i) {
+        if (!kept.at(i)) {
+            delta.append(i);
+        }
+    }
+    return delta;
+}
+
+} // namespace
+
+#endif
@@ -0,0 +1,155 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+// KWin
+#include "../../focuschain.h"
+
+#include <QTest>
+
+using namespace KWin;
+
+// FocusChainList never dereferences the Clients, so fake pointers are sufficient
+static Client *fakeClient(quintptr id)
+{
+    return reinterpret_cast<Client*>(id);
+}
+
+class TestFocusChainList : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void empty();
+    void appendPrepend();
+    void insert();
+    void remove();
+    void benchmarkUpdate_data();
+    void benchmarkUpdate();
+private:
+    QList<Client*> toList(const FocusChainList &chain) const;
+};
+
+QList<Client*> TestFocusChainList::toList(const FocusChainList &chain) const
+{
+    QList<Client*> list;
+    for (Client *c = chain.first(); c; c = chain.next(c)) {
+        list << c;
+    }
+    return list;
+}
+
+void TestFocusChainList::empty()
+{
+    FocusChainList chain;
+    QVERIFY(chain.isEmpty());
+    QCOMPARE(chain.count(), 0);
+    QVERIFY(!chain.first());
+    QVERIFY(!chain.last());
+    QVERIFY(!chain.contains(fakeClient(1)));
+    QVERIFY(!chain.remove(fakeClient(1)));
+}
+
+void TestFocusChainList::appendPrepend()
+{
+    FocusChainList chain;
+    chain.append(fakeClient(2));
+    QCOMPARE(chain.first(), fakeClient(2));
+    QCOMPARE(chain.last(), fakeClient(2));
+    chain.append(fakeClient(3));
+    chain.prepend(fakeClient(1));
+    QCOMPARE(chain.count(), 3);
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(1) << fakeClient(2) << fakeClient(3));
+    QCOMPARE(chain.previous(fakeClient(1)), static_cast<Client*>(nullptr));
+    QCOMPARE(chain.previous(fakeClient(3)), fakeClient(2));
+    QCOMPARE(chain.next(fakeClient(3)), static_cast<Client*>(nullptr));
+}
+
+void TestFocusChainList::insert()
+{
+    FocusChainList chain;
+    chain.append(fakeClient(1));
+    chain.append(fakeClient(3));
+    chain.insertBefore(fakeClient(3), fakeClient(2));
+    chain.insertBefore(fakeClient(1), fakeClient(0));
+    chain.insertAfter(fakeClient(3), fakeClient(5));
+    chain.insertAfter(fakeClient(3), fakeClient(4));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(0) << fakeClient(1) << fakeClient(2)
+                                             << fakeClient(3) << fakeClient(4) << fakeClient(5));
+    QCOMPARE(chain.first(), fakeClient(0));
+    QCOMPARE(chain.last(), fakeClient(5));
+    // null reference appends respectively prepends
+    chain.insertBefore(nullptr, fakeClient(6));
+    chain.insertAfter(nullptr, fakeClient(7));
+    QCOMPARE(chain.first(), fakeClient(7));
+    QCOMPARE(chain.last(), fakeClient(6));
+}
+
+void TestFocusChainList::remove()
+{
+    FocusChainList chain;
+    for (quintptr i = 1; i <= 4; ++i) {
+        chain.append(fakeClient(i));
+    }
+    QVERIFY(chain.remove(fakeClient(1)));
+    QVERIFY(!chain.contains(fakeClient(1)));
+    QCOMPARE(chain.first(), fakeClient(2));
+    QVERIFY(chain.remove(fakeClient(4)));
+    QCOMPARE(chain.last(), fakeClient(3));
+    QVERIFY(chain.remove(fakeClient(2)));
+    QVERIFY(!chain.remove(fakeClient(2)));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(3));
+    QVERIFY(chain.remove(fakeClient(3)));
+    QVERIFY(chain.isEmpty());
+    QVERIFY(!chain.last());
+}
+
+void TestFocusChainList::benchmarkUpdate_data()
+{
+    QTest::addColumn<int>("desktops");
+    QTest::addColumn<int>("clients");
+
+    QTest::newRow("4/50") << 4 << 50;
+    QTest::newRow("16/200") << 16 << 200;
+    QTest::newRow("16/1000") << 16 << 1000;
+}
+
+void TestFocusChainList::benchmarkUpdate()
+{
+    // moves every client to the front of all desktop chains, like FocusChain::update does
+    // for a window on all desktops
+    QFETCH(int, desktops);
+    QFETCH(int, clients);
+    QVector<FocusChainList> chains(desktops);
+    for (FocusChainList &chain : chains) {
+        for (int i = 1; i <= clients; ++i) {
+            chain.append(fakeClient(i));
+        }
+    }
+
+    QBENCHMARK {
+        for (int i = 1; i <= clients; ++i) {
+            for (FocusChainList &chain : chains) {
+                chain.remove(fakeClient(i));
+                chain.append(fakeClient(i));
+            }
+        }
+    }
+    QCOMPARE(chains.first().count(), clients);
+}
+
+QTEST_MAIN(TestFocusChainList)
+#include "test_focuschainlist.moc"
@@ -148,7 +148,18 @@ QRect Toplevel::visibleRect() const
 
 void Toplevel::getWindowRole()
 {
-    window_role = getStringProperty(window(), atoms->wm_window_role).toLower();
+    Xcb::Property prop = fetchWindowRole();
+    readWindowRole(prop);
+}
+
+Xcb::Property Toplevel::fetchWindowRole() const
+{
+    return Xcb::Property(window(), atoms->wm_window_role, XCB_ATOM_STRING, 10000);
+}
+
+void Toplevel::readWindowRole(Xcb::Property &prop)
+{
+    window_role = prop.toByteArray().toLower();
 }
 
 /*!
@@ -184,7 +195,19 @@ xcb_window_t Toplevel::staticWmClientLeader(xcb_window_t w)
 
 void Toplevel::getWmClientLeader()
 {
-    wmClientLeaderWin = staticWmClientLeader(window());
+    Xcb::Property prop = fetchWmClientLeader();
+    readWmClientLeader(prop);
+}
+
+Xcb::Property Toplevel::fetchWmClientLeader() const
+{
+    return Xcb::Property(window(), atoms->wm_client_leader, XCB_ATOM_WINDOW, 10000);
+}
+
+void Toplevel::readWmClientLeader(Xcb::Property &prop)
+{
+    const xcb_window_t *leader = prop.value<const xcb_window_t>();
+    wmClientLeaderWin = leader ? leader[0] : window();
 }
 
 /*!
@@ -246,16 +269,28 @@ Window Toplevel::wmClientLeader() const
 
 void Toplevel::getResourceClass()
 {
-    XClassHint classHint;
-    if (XGetClassHint(display(), window(), &classHint)) {
-        // Qt3.2 and older had this all lowercase, Qt3.3 capitalized resource class.
-        // Force lowercase, so that workarounds listing resource classes still work.
-        resource_name = QByteArray(classHint.res_name).toLower();
-        resource_class = QByteArray(classHint.res_class).toLower();
-        XFree(classHint.res_name);
-        XFree(classHint.res_class);
+    Xcb::Property prop = fetchResourceClass();
+    readResourceClass(prop);
+}
+
+Xcb::Property Toplevel::fetchResourceClass() const
+{
+    return Xcb::Property(window(), XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 2048);
+}
+
+void Toplevel::readResourceClass(Xcb::Property &prop)
+{
+    // WM_CLASS consists of two consecutive null terminated strings: the name and the class
+    const QByteArray classHint = prop.toByteArray();
+    const int separator = classHint.indexOf('\0');
+    // Qt3.2 and older had this all lowercase, Qt3.3 capitalized resource class.
+    // Force lowercase, so that workarounds listing resource classes still work.
+    if (separator < 0) {
+        resource_name = classHint.toLower();
+        resource_class = QByteArray();
     } else {
-        resource_name = resource_class = QByteArray();
+        resource_name = classHint.left(separator).toLower();
+        resource_class = QByteArray(classHint.constData() + separator + 1).toLower();
     }
 }
 
@@ -392,38 +427,32 @@ const Shadow *Toplevel::shadow() const
 
 void Toplevel::getWmOpaqueRegion()
 {
-    const int length=32768;
-    unsigned long bytes_after_return=0;
-    QRegion new_opaque_region;
-    do {
-        unsigned long* data;
-        Atom type;
-        int rformat;
-        unsigned long nitems;
-        if (XGetWindowProperty(display(), m_client,
-                               atoms->net_wm_opaque_region, 0, length, false, XCB_ATOM_CARDINAL,
-                               &type, &rformat, &nitems, &bytes_after_return,
-                               reinterpret_cast< unsigned char** >(&data)) == Success) {
-            if (type != XCB_ATOM_CARDINAL || rformat != 32 || nitems%4) {
-                // it can happen, that the window does not provide this property
-                XFree(data);
-                break;
-            }
+    Xcb::Property prop = fetchWmOpaqueRegion();
+    readWmOpaqueRegion(prop);
+}
 
-            for (unsigned int i = 0; i < nitems;) {
-                const int x = data[i++];
-                const int y = data[i++];
-                const int w = data[i++];
-                const int h = data[i++];
+Xcb::Property Toplevel::fetchWmOpaqueRegion() const
+{
+    // length is in 32 bit units, large enough for any sensible region
+    return Xcb::Property(m_client, atoms->net_wm_opaque_region, XCB_ATOM_CARDINAL, 0x1FFFFFFF);
+}
 
-                new_opaque_region += QRect(x,y,w,h);
-            }
-            XFree(data);
-        } else {
-            qWarning() << "XGetWindowProperty failed";
-            break;
+void Toplevel::readWmOpaqueRegion(Xcb::Property &prop)
+{
+    QRegion new_opaque_region;
+    uint32_t nitems = 0;
+    // it can happen, that the window does not provide this property
+    const int32_t *data = prop.value<const int32_t>(32, &nitems);
+    if (data && nitems % 4 == 0) {
+        for (uint32_t i = 0; i < nitems;) {
+            const int x = data[i++];
+            const int y = data[i++];
+            const int w = data[i++];
+            const int h = data[i++];
+
+            new_opaque_region += QRect(x,y,w,h);
         }
-    } while (bytes_after_return > 0);
+    }
 
     opaque_region = new_opaque_region;
 }
@@ -468,16 +497,20 @@ xcb_window_t Toplevel::frameId() const
 
 void Toplevel::getSkipCloseAnimation()
 {
-    auto cookie = xcb_get_property_unchecked(connection(), false, window(), atoms->kde_skip_close_animation, XCB_ATOM_CARDINAL, 0, 1);
-    ScopedCPointer<xcb_get_property_reply_t> reply(xcb_get_property_reply(connection(), cookie, nullptr));
-    bool newValue = false;
-    if (!reply.isNull()) {
-        if (reply->format == 32 && reply->type == XCB_ATOM_CARDINAL && reply->value_len == 1) {
-            const uint32_t value = *reinterpret_cast<uint32_t*>(xcb_get_property_value(reply.data()));
-            newValue = (value != 0);
-        }
-    }
-    setSkipCloseAnimation(newValue);
+    Xcb::Property prop = fetchSkipCloseAnimation();
+    readSkipCloseAnimation(prop);
+}
+
+Xcb::Property Toplevel::fetchSkipCloseAnimation() const
+{
+    return Xcb::Property(window(), atoms->kde_skip_close_animation, XCB_ATOM_CARDINAL, 1);
+}
+
+void Toplevel::readSkipCloseAnimation(Xcb::Property &prop)
+{
+    uint32_t count = 0;
+    const uint32_t *value = prop.value<const uint32_t>(32, &count);
+    setSkipCloseAnimation(value && count == 1 && value[0] != 0);
 }
 
 bool Toplevel::skipsCloseAnimation() const
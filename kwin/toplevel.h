@@ -387,6 +387,8 @@ protected:
     void discardWindowPixmap();
     void addDamageFull();
     void getWmClientLeader();
+    Xcb::Property fetchWmClientLeader() const;
+    void readWmClientLeader(Xcb::Property &prop);
     void getWmClientMachine();
     /**
      * @returns Whether there is a compositor and it is active.
@@ -398,10 +400,23 @@ protected:
      * Will only be called on corresponding property changes and for initialization.
      **/
     void getWmOpaqueRegion();
+    Xcb::Property fetchWmOpaqueRegion() const;
+    void readWmOpaqueRegion(Xcb::Property &prop);
 
+    /**
+     * The get* methods read a property with a blocking round trip. To read several properties
+     * at once, e.g. when managing a window, issue all fetch* requests first and pass the
+     * results to the corresponding read* methods afterwards.
+     **/
     void getResourceClass();
+    Xcb::Property fetchResourceClass() const;
+    void readResourceClass(Xcb::Property &prop);
     void getWindowRole();
+    Xcb::Property fetchWindowRole() const;
+    void readWindowRole(Xcb::Property &prop);
     void getSkipCloseAnimation();
+    Xcb::Property fetchSkipCloseAnimation() const;
+    void readSkipCloseAnimation(Xcb::Property &prop);
     virtual void debug(QDebug& stream) const = 0;
     void copyToDeleted(Toplevel* c);
     void disownDataPassedToDeleted();
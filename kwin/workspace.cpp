@@ -437,8 +437,10 @@ Workspace::~Workspace()
         clients.removeAll(c);
         desktops.removeAll(c);
     }
+    m_clientWindows.clear();
     for (UnmanagedList::iterator it = unmanaged.begin(), end = unmanaged.end(); it != end; ++it)
         (*it)->release(true);
+    m_unmanagedWindows.clear();
     xcb_delete_property(connection(), rootWindow(), atoms->kwin_running);
 
     delete RuleBook::self();
@@ -505,6 +507,7 @@ void Workspace::addClient(Client* c)
     if (grp != NULL)
         grp->gotLeader(c);
 
+    indexClientWindows(c);
     if (c->isDesktop()) {
         desktops.append(c);
         if (active_client == NULL && should_get_focus.isEmpty() && c->isOnCurrentDesktop())
@@ -545,9 +548,38 @@ void Workspace::addClient(Client* c)
 void Workspace::addUnmanaged(Unmanaged* c)
 {
     unmanaged.append(c);
+    m_unmanagedWindows.insert(c->window(), c);
     x_stacking_dirty = true;
 }
 
+void Workspace::indexClientWindows(Client *c)
+{
+    m_clientWindows.insert(c->window(), c, Predicate::WindowMatch);
+    m_clientWindows.insert(c->wrapperId(), c, Predicate::WrapperIdMatch);
+    m_clientWindows.insert(c->frameId(), c, Predicate::FrameIdMatch);
+    m_clientWindows.insert(c->inputId(), c, Predicate::InputIdMatch);
+}
+
+void Workspace::unindexClientWindows(Client *c)
+{
+    // Called from Client::releaseWindow() and destroyClient() before the windows get reset,
+    // the input window was already removed together with the decoration
+    m_clientWindows.remove(c->window(), c);
+    m_clientWindows.remove(c->wrapperId(), c);
+    m_clientWindows.remove(c->frameId(), c);
+    m_clientWindows.remove(c->inputId(), c);
+}
+
+void Workspace::clientInputWindowChanged(Client *c, xcb_window_t oldInputWindow)
+{
+    // Clients get indexed once they are added, until then the input window is not of interest
+    if (!m_clientWindows.contains(c->window(), c)) {
+        return;
+    }
+    m_clientWindows.remove(oldInputWindow, c);
+    m_clientWindows.insert(c->inputId(), c, Predicate::InputIdMatch);
+}
+
 /**
  * Destroys the client \a c
  */
@@ -580,6 +612,7 @@ void Workspace::removeClient(Client* c)
     // TODO: if marked client is removed, notify the marked list
     clients.removeAll(c);
     desktops.removeAll(c);
+    unindexClientWindows(c);
     x_stacking_dirty = true;
     attention_chain.removeAll(c);
     showing_desktop_clients.removeAll(c);
@@ -610,6 +643,7 @@ void Workspace::removeUnmanaged(Unmanaged* c)
 {
     assert(unmanaged.contains(c));
     unmanaged.removeAll(c);
+    m_unmanagedWindows.remove(c->window());
     emit unmanagedRemoved(c);
     x_stacking_dirty = true;
 }
@@ -1548,32 +1582,12 @@ Unmanaged *Workspace::findUnmanaged(std::function<bool (const Unmanaged*)> func)
 
 Unmanaged *Workspace::findUnmanaged(xcb_window_t w) const
 {
-    return findUnmanaged([w](const Unmanaged *u) {
-        return u->window() == w;
-    });
+    return m_unmanagedWindows.value(w);
 }
 
 Client *Workspace::findClient(Predicate predicate, xcb_window_t w) const
 {
-    switch (predicate) {
-    case Predicate::WindowMatch:
-        return findClient([w](const Client *c) {
-            return c->window() == w;
-        });
-    case Predicate::WrapperIdMatch:
-        return findClient([w](const Client *c) {
-            return c->wrapperId() == w;
-        });
-    case Predicate::FrameIdMatch:
-        return findClient([w](const Client *c) {
-            return c->frameId() == w;
-        });
-    case Predicate::InputIdMatch:
-        return findClient([w](const Client *c) {
-            return c->inputId() == w;
-        });
-    }
-    return nullptr;
+    return m_clientWindows.find(predicate, w);
 }
 
 } // namespace
@@ -25,9 +25,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 // kwin
 #include <kdecoration.h>
+#include "clientwindowindex.h"
 #include "sm.h"
 #include "utils.h"
 // Qt
+#include <QHash>
 #include <QTimer>
 #include <QVector>
 // std
@@ -55,7 +57,6 @@ class KillWindow;
 class ShortcutDialog;
 class UserActionsMenu;
 class Compositor;
-enum class Predicate;
 
 class Workspace : public QObject, public KDecorationDefines
 {
@@ -105,6 +106,9 @@ public:
     /**
      * @brief Finds the Client matching the given match @p predicate for the given window.
      *
+     * The lookup uses an index of the windows of all managed Clients and does not depend
+     * on the number of Clients.
+     *
      * @param predicate Which window should be compared
      * @param w The window id to test against
      * @return KWin::Client* The found Client or @c null
@@ -290,6 +294,7 @@ public:
     Group* findClientLeaderGroup(const Client* c) const;
 
     void removeUnmanaged(Unmanaged*);   // Only called from Unmanaged::release()
+    void clientInputWindowChanged(Client *c, xcb_window_t oldInputWindow);   // Only called from Client
     void removeDeleted(Deleted*);
     void addDeleted(Deleted*, Toplevel*);
 
@@ -477,6 +482,8 @@ private:
     void addClient(Client* c);
     Unmanaged* createUnmanaged(xcb_window_t w);
     void addUnmanaged(Unmanaged* c);
+    void indexClientWindows(Client *c);
+    void unindexClientWindows(Client *c);
 
     //---------------------------------------------------------------------
 
@@ -513,9 +520,15 @@ private:
     UnmanagedList unmanaged;
     DeletedList deleted;
 
+    // Index of all windows owned by the managed clients and of the unmanaged windows, so that
+    // mapping the window of an X event to its Toplevel doesn't need to walk the lists
+    ClientWindowIndex<Client> m_clientWindows;
+    QHash<xcb_window_t, Unmanaged*> m_unmanagedWindows;
+
     ToplevelList unconstrained_stacking_order; // Topmost last
     ToplevelList stacking_order; // Topmost last
     bool force_restacking;
+    QVector<xcb_window_t> propagated_window_stack; // Last restacked windows, topmost first
     mutable ToplevelList x_stacking; // From XQueryTree()
     mutable bool x_stacking_dirty;
     ClientList should_get_focus; // Last is most recent
@@ -264,6 +264,7 @@ inline xcb_get_property_cookie_t get_transient_for(xcb_connection_t *c, xcb_wind
 class TransientFor : public Wrapper<xcb_get_property_reply_t, xcb_get_property_cookie_t, &xcb_get_property_reply, &get_transient_for>
 {
 public:
+    TransientFor() : Wrapper<xcb_get_property_reply_t, xcb_get_property_cookie_t, &xcb_get_property_reply, &get_transient_for>() {}
     explicit TransientFor(WindowId window) : Wrapper<xcb_get_property_reply_t, xcb_get_property_cookie_t, &xcb_get_property_reply, &get_transient_for>(window) {}
 
     /**
@@ -285,6 +286,176 @@ public:
     }
 };
 
+/**
+ * @brief Wrapper for a GetProperty request.
+ *
+ * Unlike the generic Wrapper the request needs the property, type and length besides the
+ * window, so the cookie is created directly. As with the other wrappers the request is sent
+ * on construction and the reply is only waited for on first access, so creating several
+ * Property objects before reading any of them needs only a single round trip.
+ *
+ * The object can be moved, but not copied.
+ **/
+class Property
+{
+public:
+    Property()
+        : m_retrieved(false)
+        , m_window(XCB_WINDOW_NONE)
+        , m_type(XCB_ATOM_NONE)
+        , m_reply(nullptr)
+    {
+        m_cookie.sequence = 0;
+    }
+    Property(WindowId window, xcb_atom_t property, xcb_atom_t type, uint32_t length)
+        : m_retrieved(false)
+        , m_cookie(xcb_get_property_unchecked(connection(), false, window, property, type, 0, length))
+        , m_window(window)
+        , m_type(type)
+        , m_reply(nullptr)
+    {
+    }
+    Property(Property &&other)
+        : m_retrieved(other.m_retrieved)
+        , m_cookie(other.m_cookie)
+        , m_window(other.m_window)
+        , m_type(other.m_type)
+        , m_reply(other.m_reply)
+    {
+        other.m_retrieved = true;
+        other.m_window = XCB_WINDOW_NONE;
+        other.m_reply = nullptr;
+    }
+    Property(const Property &) = delete;
+    Property &operator=(const Property &) = delete;
+    virtual ~Property() {
+        if (!m_retrieved && m_cookie.sequence) {
+            xcb_discard_reply(connection(), m_cookie.sequence);
+        } else if (m_reply) {
+            free(m_reply);
+        }
+    }
+
+    inline const xcb_get_property_reply_t *data() {
+        getReply();
+        return m_reply;
+    }
+    inline bool isNull() {
+        getReply();
+        return m_reply == nullptr;
+    }
+    inline WindowId window() const {
+        return m_window;
+    }
+    inline bool isRetrieved() const {
+        return m_retrieved;
+    }
+    /**
+     * @brief Returns the property value as an array of @p T.
+     *
+     * The value is only returned if the reply has the requested type and @p format.
+     * @param format The expected number of bits per item: 8, 16 or 32.
+     * @param count Set to the number of items in the returned array, if not null.
+     * @returns Pointer to the property data owned by this object, or @c null.
+     **/
+    template <typename T>
+    inline T *value(uint8_t format = 32, uint32_t *count = nullptr) {
+        if (count) {
+            *count = 0;
+        }
+        getReply();
+        if (!m_reply || m_reply->format != format || m_reply->value_len == 0) {
+            return nullptr;
+        }
+        if (m_type != XCB_GET_PROPERTY_TYPE_ANY && m_reply->type != m_type) {
+            return nullptr;
+        }
+        if (count) {
+            *count = m_reply->value_len;
+        }
+        return reinterpret_cast<T*>(xcb_get_property_value(m_reply));
+    }
+    /**
+     * @returns The value of an 8 bit property, e.g. a string, or an empty array.
+     **/
+    inline QByteArray toByteArray() {
+        uint32_t length = 0;
+        const char *data = value<const char>(8, &length);
+        if (!data) {
+            return QByteArray();
+        }
+        return QByteArray(data, length);
+    }
+
+protected:
+    void getReply() {
+        if (m_retrieved || !m_cookie.sequence) {
+            return;
+        }
+        m_reply = xcb_get_property_reply(connection(), m_cookie, nullptr);
+        m_retrieved = true;
+    }
+
+private:
+    bool m_retrieved;
+    xcb_get_property_cookie_t m_cookie;
+    WindowId m_window;
+    xcb_atom_t m_type;
+    xcb_get_property_reply_t *m_reply;
+};
+
+/**
+ * @brief The ICCCM WM_HINTS of a window.
+ **/
+class WMHints : public Property
+{
+public:
+    WMHints() : Property() {}
+    explicit WMHints(WindowId window) : Property(window, XCB_ATOM_WM_HINTS, XCB_ATOM_WM_HINTS, 9) {}
+    WMHints(WMHints &&other) : Property(std::move(other)) {}
+
+    inline bool input() {
+        return hasFlag(InputFlag) ? field(InputField) != 0 : true;
+    }
+    inline bool isInitiallyIconic() {
+        return hasFlag(StateFlag) && field(InitialStateField) == IconicStateValue;
+    }
+    inline xcb_window_t windowGroup() {
+        return hasFlag(WindowGroupFlag) ? field(WindowGroupField) : XCB_WINDOW_NONE;
+    }
+    inline bool urgency() {
+        return hasFlag(UrgencyFlag);
+    }
+
+private:
+    enum Flags {
+        InputFlag = (1 << 0),
+        StateFlag = (1 << 1),
+        WindowGroupFlag = (1 << 6),
+        UrgencyFlag = (1 << 8)
+    };
+    enum Fields {
+        FlagsField = 0,
+        InputField = 1,
+        InitialStateField = 2,
+        WindowGroupField = 8
+    };
+    enum {
+        IconicStateValue = 3
+    };
+    inline uint32_t field(int index) {
+        uint32_t count = 0;
+        const uint32_t *hints = value<const uint32_t>(32, &count);
+        if (!hints || uint32_t(index) >= count) {
+            return 0;
+        }
+        return hints[index];
+    }
+    inline bool hasFlag(Flags flag) {
+        return field(FlagsField) & flag;
+    }
+};
+
 namespace RandR
 {
 typedef Wrapper<xcb_randr_get_screen_info_reply_t, xcb_randr_get_screen_info_cookie_t, &xcb_randr_get_screen_info_reply, &xcb_randr_get_screen_info_unchecked> ScreenInfo;
@@ -830,6 +1001,22 @@ static inline void restackWindows(const QVector<xcb_window_t> &windows)
     }
 }
 
+/**
+ * Restacks only the windows at the given @p indices of @p windows below their predecessor,
+ * the indices have to be ascending. The other windows are expected to be stacked already.
+ **/
+static inline void restackWindows(const QVector<xcb_window_t> &windows, const QVector<int> &indices)
+{
+    for (int i : indices) {
+        const uint16_t mask = XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE;
+        const uint32_t stackingValues[] = {
+            windows.at(i-1),
+            XCB_STACK_MODE_BELOW
+        };
+        xcb_configure_window(connection(), windows.at(i), mask, stackingValues);
+    }
+}
+
 static inline void restackWindowsWithRaise(const QVector<xcb_window_t> &windows)
 {
     if (windows.isEmpty()) {
@@ -0,0 +1,142 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "oxygendecohelper.h"
+
+#include <QFontDatabase>
+#include <QPainter>
+#include <QStandardPaths>
+#include <QStyle>
+#include <QTest>
+
+namespace Oxygen
+{
+
+    class TestDecoHelper : public QObject
+    {
+
+        Q_OBJECT
+
+        private Q_SLOTS:
+
+        void initTestCase( void );
+        void titleText( void );
+        void benchmarkTitleText_data( void );
+        void benchmarkTitleText( void );
+        void benchmarkButton_data( void );
+        void benchmarkButton( void );
+
+        private:
+
+        QScopedPointer<DecoHelper> _helper;
+
+    };
+
+    //___________________________________________________
+    void TestDecoHelper::initTestCase( void )
+    {
+        QStandardPaths::setTestModeEnabled( true );
+        _helper.reset( new DecoHelper( KSharedConfig::openConfig( QStringLiteral( "oxygenrc" ) ) ) );
+    }
+
+    //___________________________________________________
+    void TestDecoHelper::titleText( void )
+    {
+        const QFont font( QFontDatabase::systemFont( QFontDatabase::TitleFont ) );
+        const QString caption( QStringLiteral( "A long caption of a window, elided to the title bar - Application" ) );
+
+        const QStaticText text( _helper->windecoTitleText( caption, font, 100 ) );
+        QCOMPARE( text.textFormat(), Qt::PlainText );
+        QCOMPARE( text.text(), QFontMetrics( font ).elidedText( caption, Qt::ElideRight, 100 ) );
+        QVERIFY( text.size().width() <= 100 );
+
+        // captions are never interpreted as markup
+        const QString markup( QStringLiteral( "<b>bold</b>" ) );
+        QCOMPARE( _helper->windecoTitleText( markup, font, 500 ).text(), markup );
+        QCOMPARE( _helper->windecoTitleText( markup, font, 500 ).textFormat(), Qt::PlainText );
+
+        // another width gets another elision
+        QVERIFY( _helper->windecoTitleText( caption, font, 2000 ).text() != text.text() );
+    }
+
+    //___________________________________________________
+    void TestDecoHelper::benchmarkTitleText_data( void )
+    {
+        QTest::addColumn<bool>( "warm" );
+
+        QTest::newRow( "cold" ) << false;
+        QTest::newRow( "warm" ) << true;
+    }
+
+    //___________________________________________________
+    void TestDecoHelper::benchmarkTitleText( void )
+    {
+        QFETCH( bool, warm );
+
+        const QFont font( QFontDatabase::systemFont( QFontDatabase::TitleFont ) );
+        const QString caption( QStringLiteral( "testdecohelper.cpp - oxygen/kwin-decoration/autotests - Text Editor" ) );
+        const QRect rect( 0, 0, 300, 20 );
+        const QColor color( Qt::black );
+        const QColor contrast( Qt::white );
+
+        // what the client does for a repaint of its title, including the drawing onto the title bar
+        QImage image( rect.size(), QImage::Format_RGB32 );
+        image.fill( Qt::lightGray );
+        QPainter painter( &image );
+        painter.setFont( font );
+        _helper->invalidateCaches();
+        QBENCHMARK
+        {
+            if( !warm ) _helper->invalidateCaches();
+            const QStaticText text( _helper->windecoTitleText( caption, font, rect.width() ) );
+            const QPoint position( QStyle::alignedRect( Qt::LeftToRight, Qt::AlignCenter, text.size().toSize(), rect ).topLeft() );
+            painter.setPen( contrast );
+            painter.drawStaticText( position + QPoint( 0, 1 ), text );
+            painter.setPen( color );
+            painter.drawStaticText( position, text );
+        }
+    }
+
+    //___________________________________________________
+    void TestDecoHelper::benchmarkButton_data( void )
+    {
+        QTest::addColumn<bool>( "warm" );
+
+        QTest::newRow( "cold" ) << false;
+        QTest::newRow( "warm" ) << true;
+    }
+
+    //___________________________________________________
+    void TestDecoHelper::benchmarkButton( void )
+    {
+        QFETCH( bool, warm );
+
+        const QColor color( 0xd6, 0xd2, 0xd0 );
+        const QColor glow( 0x6e, 0xc1, 0xff );
+        _helper->invalidateCaches();
+        QBENCHMARK
+        {
+            if( !warm ) _helper->invalidateCaches();
+            // a button, and the same button hovered
+            _helper->windecoButton( color, QColor(), false, 21 );
+            _helper->windecoButton( color, glow, false, 21 );
+        }
+    }
+
+}
+
+QTEST_MAIN(Oxygen::TestDecoHelper)
+#include "testdecohelper.moc"
@@ -193,19 +193,42 @@ namespace Oxygen
 
         } else {
 
-            painter.setRenderHints(QPainter::Antialiasing);
-            qreal width( 1.2 );
-
-            // contrast
-            painter.setBrush(Qt::NoBrush);
-            painter.setPen(QPen( _helper.calcLightColor( base ), width, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
-            drawIcon(&painter);
-
-            // main
-            painter.translate(0,-1.5);
-            painter.setBrush(Qt::NoBrush);
-            painter.setPen(QPen(color, width, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
-            drawIcon(&painter);
+            // glyphs are shared by all buttons with same type, state, size and colors
+            const QColor contrast( _helper.calcLightColor( base ) );
+            quint64 variant( _type );
+            if( _type == ButtonMax && _client.maximizeMode() == Client::MaximizeFull ) variant |= 1<<6;
+            if( _type == ButtonShade && isChecked() ) variant |= 1<<7;
+            const quint64 key( ( quint64( contrast.rgba() ) << 32 ) | ( variant << 24 ) | ( ( width() & 0xfff ) << 12 ) | ( height() & 0xfff ) );
+
+            Oxygen::Cache<QPixmap>::Value* cache( _helper.windecoGlyphCache( color ) );
+            QPixmap *pixmap = cache->object( key );
+            if( !pixmap )
+            {
+
+                pixmap = new QPixmap( size() );
+                pixmap->fill( Qt::transparent );
+
+                QPainter p( pixmap );
+                p.setRenderHints(QPainter::Antialiasing);
+                qreal width( 1.2 );
+
+                // contrast
+                p.setBrush(Qt::NoBrush);
+                p.setPen(QPen( contrast, width, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+                drawIcon(&p);
+
+                // main
+                p.translate(0,-1.5);
+                p.setBrush(Qt::NoBrush);
+                p.setPen(QPen(color, width, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+                drawIcon(&p);
+
+                p.end();
+                cache->insert( key, pixmap );
+
+            }
+
+            painter.drawPixmap( 0, 0, *pixmap );
 
         }
 
@@ -45,6 +45,7 @@
 #include <QBitmap>
 #include <QObjectList>
 #include <QMimeData>
+#include <QStyle>
 
 namespace Oxygen
 {
@@ -953,21 +954,40 @@ namespace Oxygen
     {
 
         const Qt::Alignment alignment( titleAlignment() | Qt::AlignVCenter );
-        const QString local( elide ? QFontMetrics( painter->font() ).elidedText( caption, Qt::ElideRight, rect.width() ):caption );
 
         // translate title down in case of maximized window
         if( isMaximized() ) painter->translate( 0, 2 );
 
-        if( contrast.isValid() )
+        if( elide )
         {
-            painter->setPen( contrast );
-            painter->translate( 0, 1 );
-            painter->drawText( rect, alignment, local );
-            painter->translate( 0, -1 );
-        }
 
-        painter->setPen( color );
-        painter->drawText( rect, alignment, local );
+            // elided text fits the rect, so that its layout can be shared with other clients.
+            // It is still drawn onto the title bar, for subpixel antialiasing
+            const QStaticText text( helper().windecoTitleText( caption, painter->font(), rect.width() ) );
+            const QPoint position( QStyle::alignedRect( painter->layoutDirection(), alignment, text.size().toSize(), rect ).topLeft() );
+            if( contrast.isValid() )
+            {
+                painter->setPen( contrast );
+                painter->drawStaticText( position + QPoint( 0, 1 ), text );
+            }
+
+            painter->setPen( color );
+            painter->drawStaticText( position, text );
+
+        } else {
+
+            if( contrast.isValid() )
+            {
+                painter->setPen( contrast );
+                painter->translate( 0, 1 );
+                painter->drawText( rect, alignment, caption );
+                painter->translate( 0, -1 );
+            }
+
+            painter->setPen( color );
+            painter->drawText( rect, alignment, caption );
+
+        }
 
         // translate back
         if( isMaximized() ) painter->translate( 0, -2 );
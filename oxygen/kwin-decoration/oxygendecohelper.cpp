@@ -31,7 +31,8 @@ namespace Oxygen
 
     //______________________________________________________________________________
     DecoHelper::DecoHelper(KSharedConfigPtr config):
-        Helper(config)
+        Helper(config),
+        _titleTextCache( 256 )
     {}
 
     //______________________________________________________________________________
@@ -42,6 +43,8 @@ namespace Oxygen
 
         // local caches
         _windecoButtonCache.clear();
+        _windecoGlyphCache.clear();
+        _titleTextCache.clear();
         _titleBarTextColorCache.clear();
         _buttonTextColorCache.clear();
 
@@ -131,6 +134,30 @@ namespace Oxygen
         return *pixmap;
     }
 
+    //______________________________________________________________________________
+    QStaticText DecoHelper::windecoTitleText( const QString& caption, const QFont& font, int width )
+    {
+
+        // the same caption is typically shown by several clients at once,
+        // and again in the other color when the active window changes
+        const QString key(
+            font.key() + QLatin1Char( ':' ) +
+            QString::number( width ) + QLatin1Char( ':' ) +
+            caption );
+
+        if( QStaticText* text = _titleTextCache.object( key ) )
+        { return *text; }
+
+        QStaticText text( QFontMetrics( font ).elidedText( caption, Qt::ElideRight, width ) );
+        text.setTextFormat( Qt::PlainText );
+        text.setPerformanceHint( QStaticText::AggressiveCaching );
+        text.prepare( QTransform(), font );
+
+        _titleTextCache.insert( key, new QStaticText( text ) );
+        return text;
+
+    }
+
     //_______________________________________________________________________
     QRegion DecoHelper::decoRoundedMask( const QRect& r, int left, int right, int top, int bottom ) const
     {
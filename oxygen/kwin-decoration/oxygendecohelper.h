@@ -25,6 +25,9 @@
 #include "oxygenhelper.h"
 #include <ksharedconfig.h>
 
+#include <QCache>
+#include <QStaticText>
+
 //! helper class
 /*! contains utility functions used at multiple places in oxygen style */
 namespace Oxygen
@@ -49,6 +52,14 @@ namespace Oxygen
         //!
         //@{
         virtual QPixmap windecoButton(const QColor &color, const QColor& glow, bool sunken, int size = 21);
+
+        //! button glyphs, rendered by the buttons themselves and shared among all clients
+        Cache<QPixmap>::Value* windecoGlyphCache( const QColor& color )
+        { return _windecoGlyphCache.get( color ); }
+
+        //! title text elided to width, laid out once for all clients
+        /*! it is drawn by the clients onto their title bar, which keeps subpixel antialiasing */
+        QStaticText windecoTitleText( const QString& caption, const QFont& font, int width );
         //@}
 
         //
@@ -70,6 +81,12 @@ namespace Oxygen
         //! windeco buttons
         Cache<QPixmap> _windecoButtonCache;
 
+        //! windeco button glyphs
+        Cache<QPixmap> _windecoGlyphCache;
+
+        //! title texts
+        QCache<QString, QStaticText> _titleTextCache;
+
         //! titleBar text color cache
         ColorCache _titleBarTextColorCache;
 
@@ -23,6 +23,7 @@
 
 // Qt
 #include <QtCore/QtAlgorithms>
+#include <QtCore/QSet>
 #include <QDebug>
 
 // KDE
@@ -109,12 +110,13 @@ public:
 //               primaryNamePolicy(ApplicationModel::GenericNamePrimary),
               displayOrder(NameAfterDescription),
               allowSeparators(_allowSeparators),
-              showRecentlyInstalled(true)
+              showRecentlyInstalled(true),
+              seenProgramsLoaded(false)
     {
         systemApplications = Kickoff::systemApplicationList();
         reloadTimer = new QTimer(qq);
         reloadTimer->setSingleShot(true);
-        QObject::connect(reloadTimer, SIGNAL(timeout()), qq, SLOT(delayedReloadMenu()));
+        QObject::connect(reloadTimer, SIGNAL(timeout()), qq, SLOT(updateMenu()));
     }
 
     ~ApplicationModelPrivate()
@@ -123,6 +125,11 @@ public:
     }
 
     void fillNode(const QString &relPath, AppNode *node);
+    QList<AppNode *> createChildren(const QString &relPath);
+    void updateChildren(AppNode *node, const QModelIndex &parent);
+    KConfigGroup seenProgramsConfig() const;
+    bool isRecentlyInstalled(const QString &storageId, bool *seenProgramsChanged);
+    static QStringList childKeys(const QList<AppNode *> &children);
     static QHash<QString, QString> iconNameMap();
 
     ApplicationModel *q;
@@ -138,33 +145,57 @@ public:
 
     QStringList newInstalledPrograms;
     QHash<QString, QDate> seenPrograms;
+    // the entries of seenPrograms to write back, the others are already stored
+    QSet<QString> changedPrograms;
+    bool seenProgramsLoaded;
+
+    // what the last scan for recently installed programs found in a menu group,
+    // the group is only read again once the number of programs in it changes
+    struct ScannedGroup {
+        int childCount;
+        // the recently installed programs of the group and its subgroups
+        QStringList recentPrograms;
+    };
+    QHash<QString, ScannedGroup> scannedGroups;
 };
 
-void ApplicationModelPrivate::fillNode(const QString &_relPath, AppNode *node)
+void ApplicationModelPrivate::fillNode(const QString &relPath, AppNode *node)
 {
-     if (_relPath=="new/") {
+    const QList<AppNode *> children = createChildren(relPath);
+    foreach (AppNode *child, children) {
+        child->parent = node;
+    }
+    node->children += children;
+}
+
+QList<AppNode *> ApplicationModelPrivate::createChildren(const QString &_relPath)
+{
+    // the nodes only get their parent once they are added to the tree, and
+    // their icons are only loaded when they are first shown
+    QList<AppNode *> children;
+
+    if (_relPath=="new/") {
         Q_FOREACH (const QString &it, newInstalledPrograms) {
             KService::Ptr p = KService::serviceByStorageId(it);
 
-            if (p->noDisplay()) {
+            if (!p || p->noDisplay()) {
                 continue;
             }
 
             AppNode *newnode = new AppNode();
-            newnode->icon = KIcon(p->icon());
+            newnode->iconName = p->icon();
             newnode->appName = p->name();
             newnode->genericName = p->genericName();
             newnode->desktopEntry = p->entryPath();
-            newnode->parent = node;
-            node->children.append(newnode);
+            children.append(newnode);
         }
-        return;
+        return children;
     }
 
     KServiceGroup::Ptr root = KServiceGroup::group(_relPath);
 
     if (!root || !root->isValid()) {
-        return;
+        return children;
     }
 
     const KServiceGroup::List list = root->entries(true /* sorted */,
@@ -208,12 +239,12 @@ void ApplicationModelPrivate::fillNode(const QString &_relPath, AppNode *node)
                     continue;
                 } else {
                     // find and remove the existing entry with the same name
-                    for (int i = node->children.count() - 1; i >= 0; --i) {
-                        AppNode *app = node->children.at(i);
+                    for (int i = children.count() - 1; i >= 0; --i) {
+                        AppNode *app = children.at(i);
                         if (app->appName == appName &&
                             app->genericName == genericName &&
                             app->iconName == icon) {
-                            app = node->children.takeAt(i);
+                            app = children.takeAt(i);
                             const QString s = app->genericName.toLower();
                             if (genericNames.contains(s)) {
                                 QList<AppNode*> list = genericNames[s];
@@ -266,15 +297,13 @@ void ApplicationModelPrivate::fillNode(const QString &_relPath, AppNode *node)
 
         AppNode *newnode = new AppNode();
         newnode->iconName = icon;
-        newnode->icon = KIcon(icon);
         newnode->appName = appName;
         newnode->genericName = genericName;
         newnode->relPath = relPath;
         newnode->desktopEntry = desktopEntry;
         newnode->isDir = isDir;
         newnode->isSeparator = isSeparator;
-        newnode->parent = node;
-        node->children.append(newnode);
+        children.append(newnode);
 
         if (p->isType(KST_KService)) {
             const QString s = genericName.toLower();
@@ -286,12 +315,11 @@ void ApplicationModelPrivate::fillNode(const QString &_relPath, AppNode *node)
 
     if (showRecentlyInstalled && _relPath.isEmpty() && !newInstalledPrograms.isEmpty()) {
         AppNode *newnode = new AppNode();
-        newnode->icon = KIcon("chronometer");
+        newnode->iconName = "chronometer";
         newnode->appName = i18n("Recently Installed");
         newnode->relPath = "new/";
         newnode->isDir = true;
-        newnode->parent = node;
-        node->children.prepend(newnode);
+        children.prepend(newnode);
     }
 
     // set the subTitleMandatory field for nodes that do not provide a unique generic
@@ -304,6 +332,88 @@ void ApplicationModelPrivate::fillNode(const QString &_relPath, AppNode *node)
             }
         }
     }
+
+    return children;
+}
+
+QStringList ApplicationModelPrivate::childKeys(const QList<AppNode *> &children)
+{
+    // identifies the nodes across updates, separators by their position among separators
+    QStringList keys;
+    QHash<QString, int> occurrences;
+    foreach (const AppNode *child, children) {
+        QString key;
+        if (child->isSeparator) {
+            key = QLatin1String("s");
+        } else if (child->isDir) {
+            key = QLatin1String("d") + child->relPath;
+        } else {
+            key = QLatin1String("a") + child->desktopEntry;
+        }
+        keys.append(key + QLatin1Char('#') + QString::number(occurrences[key]++));
+    }
+    return keys;
+}
+
+void ApplicationModelPrivate::updateChildren(AppNode *node, const QModelIndex &parent)
+{
+    const QList<AppNode *> children = createChildren(node->relPath);
+    const QStringList newKeys = childKeys(children);
+    const QSet<QString> newKeySet = newKeys.toSet();
+    QStringList oldKeys = childKeys(node->children);
+
+    for (int i = node->children.count() - 1; i >= 0; --i) {
+        if (!newKeySet.contains(oldKeys.at(i))) {
+            q->beginRemoveRows(parent, i, i);
+            delete node->children.takeAt(i);
+            oldKeys.removeAt(i);
+            q->endRemoveRows();
+        }
+    }
+
+    // every remaining node is in the new list, the rows before i are already in place
+    for (int i = 0; i < children.count(); ++i) {
+        AppNode *child = children.at(i);
+        const int row = oldKeys.indexOf(newKeys.at(i), i);
+
+        if (row < 0) {
+            q->beginInsertRows(parent, i, i);
+            child->parent = node;
+            node->children.insert(i, child);
+            oldKeys.insert(i, newKeys.at(i));
+            q->endInsertRows();
+            continue;
+        }
+
+        if (row != i) {
+            q->beginMoveRows(parent, row, row, parent, i);
+            node->children.move(row, i);
+            oldKeys.move(row, i);
+            q->endMoveRows();
+        }
+
+        AppNode *existing = node->children.at(i);
+        if (existing->iconName != child->iconName ||
+            existing->appName != child->appName ||
+            existing->genericName != child->genericName ||
+            existing->subTitleMandatory != child->subTitleMandatory) {
+            if (existing->iconName != child->iconName) {
+                existing->iconName = child->iconName;
+                existing->icon = QIcon();
+            }
+            existing->appName = child->appName;
+            existing->genericName = child->genericName;
+            existing->subTitleMandatory = child->subTitleMandatory;
+            const QModelIndex index = q->createIndex(i, 0, existing);
+            emit q->dataChanged(index, index);
+        }
+        delete child;
+
+        // the categories that were never opened are filled when they are
+        if (existing->isDir && existing->fetched) {
+            updateChildren(existing, q->createIndex(i, 0, existing));
+        }
+    }
 }
 
 ApplicationModel::ApplicationModel(QObject *parent, bool allowSeparators)
@@ -405,6 +515,9 @@ QVariant ApplicationModel::data(const QModelIndex &index, int role) const
         return node->isSeparator;
         break;
     case Qt::DecorationRole:
+        if (node->icon.isNull() && !node->iconName.isEmpty()) {
+            node->icon = KIcon(node->iconName);
+        }
         return node->icon;
         break;
     case Kickoff::RelPathRole:
@@ -540,15 +653,24 @@ void ApplicationModel::reloadMenu()
     beginResetModel();
     delete d->root;
     d->root = new AppNode();
+    d->scannedGroups.clear();
     createNewProgramList();
     d->fillNode(QString(), d->root);
     endResetModel();
 }
 
+void ApplicationModel::updateMenu()
+{
+    createNewProgramList();
+    d->updateChildren(d->root, QModelIndex());
+}
+
 void ApplicationModel::checkSycocaChange(const QStringList &changes)
 {
+    // package upgrades change the database many times in a row, only apply
+    // what changed once they settle
     if (changes.contains("services") || changes.contains("apps")) {
-        reloadMenu();
+        delayedReloadMenu();
     }
 }
 
@@ -566,30 +688,51 @@ void ApplicationModel::setApplet(Plasma::Applet *applet)
 {
     if (d->applet.data() != applet) {
         d->applet = applet;
+        d->seenPrograms.clear();
+        d->seenProgramsLoaded = false;
+        d->scannedGroups.clear();
         createNewProgramList();
     }
 }
 
-void ApplicationModel::createNewProgramList()
+KConfigGroup ApplicationModelPrivate::seenProgramsConfig() const
 {
-    if (!d->applet) {
-        return;
+    if (applet) {
+        return applet.data()->config();
     }
+    return componentData().config()->group("SeenPrograms");
+}
 
+void ApplicationModel::createNewProgramList()
+{
     d->newInstalledPrograms.clear();
     if (!d->showRecentlyInstalled) {
         return;
     }
 
-    //FIXME
-    KConfigGroup kickoffrc = d->applet.data()->config();
-    foreach (const QString &it, kickoffrc.keyList()) {
-        d->seenPrograms.insert(it, QDate::fromString(kickoffrc.readEntry(it), Qt::ISODate));
+    // the stored list is only read once, afterwards only the changes are written back
+    KConfigGroup kickoffrc = d->seenProgramsConfig();
+    if (!d->seenProgramsLoaded) {
+        foreach (const QString &it, kickoffrc.keyList()) {
+            d->seenPrograms.insert(it, QDate::fromString(kickoffrc.readEntry(it), Qt::ISODate));
+        }
+        d->seenProgramsLoaded = true;
     }
 
     bool initialize = (d->seenPrograms.isEmpty());
 
-    bool seenProgramsChanged = createNewProgramListForPath(QString());
+    d->changedPrograms.clear();
+    bool seenProgramsChanged = false;
+    KServiceGroup::Ptr root = KServiceGroup::root();
+    if (root && root->isValid()) {
+        QStringList recentPrograms;
+        seenProgramsChanged = createNewProgramListForPath(QString(), root->childCount(), &recentPrograms);
+        foreach (const QString &it, recentPrograms) {
+            if (!d->newInstalledPrograms.contains(it)) {
+                d->newInstalledPrograms += it;
+            }
+        }
+    }
 
     if (initialize) {
         // on first start, set all entries' dates to empty (means: they are not new)
@@ -597,26 +740,45 @@ void ApplicationModel::createNewProgramList()
             *it = QDate();
 
         d->newInstalledPrograms.clear();
+        for (QHash<QString, ApplicationModelPrivate::ScannedGroup>::Iterator it = d->scannedGroups.begin(); it != d->scannedGroups.end(); ++it)
+            it->recentPrograms.clear();
     }
 
     if (seenProgramsChanged) {
-        for (QHash<QString, QDate>::Iterator it = d->seenPrograms.begin(); it != d->seenPrograms.end(); ++it) {
-            kickoffrc.writeEntry(it.key(), it.value().toString(Qt::ISODate));
+        foreach (const QString &it, d->changedPrograms) {
+            kickoffrc.writeEntry(it, d->seenPrograms.value(it).toString(Qt::ISODate));
         }
         kickoffrc.sync();
     }
+    d->changedPrograms.clear();
 }
 
-bool ApplicationModel::createNewProgramListForPath(const QString &relPath)
+bool ApplicationModel::createNewProgramListForPath(const QString &relPath, int childCount, QStringList *recentPrograms)
 {
     bool seenProgramsChanged = false;
 
+    // nothing was installed into or removed from the group since it was last
+    // read, only the programs that were new then can have become old
+    QHash<QString, ApplicationModelPrivate::ScannedGroup>::Iterator scanned = d->scannedGroups.find(relPath);
+    if (scanned != d->scannedGroups.end() && scanned->childCount == childCount) {
+        QStringList stillRecent;
+        foreach (const QString &it, scanned->recentPrograms) {
+            if (d->isRecentlyInstalled(it, &seenProgramsChanged)) {
+                stillRecent += it;
+            }
+        }
+        scanned->recentPrograms = stillRecent;
+        *recentPrograms += stillRecent;
+        return seenProgramsChanged;
+    }
+
     KServiceGroup::Ptr group = KServiceGroup::group(relPath);
     if (!group || !group->isValid()) {
         return false;
     }
 
     const KServiceGroup::List list = group->entries();
+    QStringList groupRecentPrograms;
 
     KServiceGroup::List::ConstIterator it = list.begin();
     for (; it != list.end(); ++it) {
@@ -625,41 +787,53 @@ bool ApplicationModel::createNewProgramListForPath(const QString &relPath)
         if (e->isType(KST_KServiceGroup)) {
             KServiceGroup::Ptr g(e);
             if (!g->noDisplay()) {
-                if (createNewProgramListForPath(g->relPath()))
+                if (createNewProgramListForPath(g->relPath(), g->childCount(), &groupRecentPrograms))
                     seenProgramsChanged = true;
             }
         } else if (e->isType(KST_KService)) {
             KService::Ptr s(e);
             if (s->isApplication() && !s->noDisplay()) {
-                QString shortStorageId = s->storageId().remove(".desktop");
-                QHash<QString, QDate>::Iterator it_find = d->seenPrograms.find(shortStorageId);
-                if (it_find == d->seenPrograms.end()) {
-                    seenProgramsChanged = true;
-                    d->seenPrograms.insert(shortStorageId, QDate::currentDate());
-                    if (!d->newInstalledPrograms.contains(s->storageId())) {
-                        d->newInstalledPrograms += s->storageId();
-                    }
-                }
-                else {
-                    QDate date = it_find.value();
-                    if (date.isValid()) {
-                        if (date.daysTo(QDate::currentDate()) < 3) {
-                            if (!d->newInstalledPrograms.contains(s->storageId())) {
-                                 d->newInstalledPrograms += s->storageId();
-                            }
-                        }
-                        else {
-                            seenProgramsChanged = true;
-                            (*it_find) = QDate(); // this entry is not new anymore
-                        }
-                    }
+                if (d->isRecentlyInstalled(s->storageId(), &seenProgramsChanged)) {
+                    groupRecentPrograms += s->storageId();
                 }
             }
         }
     }
+
+    // the recursion may have added groups, scanned is not valid anymore
+    ApplicationModelPrivate::ScannedGroup result;
+    result.childCount = childCount;
+    result.recentPrograms = groupRecentPrograms;
+    d->scannedGroups.insert(relPath, result);
+    *recentPrograms += groupRecentPrograms;
     return seenProgramsChanged;
 }
 
+bool ApplicationModelPrivate::isRecentlyInstalled(const QString &storageId, bool *seenProgramsChanged)
+{
+    QString shortStorageId = storageId;
+    shortStorageId.remove(".desktop");
+    QHash<QString, QDate>::Iterator it_find = seenPrograms.find(shortStorageId);
+    if (it_find == seenPrograms.end()) {
+        *seenProgramsChanged = true;
+        seenPrograms.insert(shortStorageId, QDate::currentDate());
+        changedPrograms.insert(shortStorageId);
+        return true;
+    }
+
+    QDate date = it_find.value();
+    if (!date.isValid()) {
+        return false;
+    }
+    if (date.daysTo(QDate::currentDate()) < 3) {
+        return true;
+    }
+    *seenProgramsChanged = true;
+    (*it_find) = QDate(); // this entry is not new anymore
+    changedPrograms.insert(shortStorageId);
+    return false;
+}
+
 /**
  * FIXME This is a temporary workaround to map the icon names found
  * in the desktop directory files (from /usr/share/desktop-directories)
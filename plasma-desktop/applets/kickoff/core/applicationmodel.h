@@ -116,12 +116,16 @@ public Q_SLOTS:
     void delayedReloadMenu();
     void checkSycocaChange(const QStringList &changes);
 
+private Q_SLOTS:
+    /** Applies the changes of the menu to the tree, instead of rebuilding it */
+    void updateMenu();
+
 private:
     friend class ApplicationModelPrivate;
     ApplicationModelPrivate *const d;
 
     void createNewProgramList();
-    bool createNewProgramListForPath(const QString &relPath);
+    bool createNewProgramListForPath(const QString &relPath, int childCount, QStringList *recentPrograms);
 
     Q_DISABLE_COPY(ApplicationModel)
 };
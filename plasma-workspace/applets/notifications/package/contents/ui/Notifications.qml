@@ -144,6 +144,10 @@ Column {
         interval: 0
 
         onSourceAdded: {
+            // the statistics aren't a notification
+            if (source.indexOf("notification ") != 0) {
+                return;
+            }
             print(" +++++++++ connecting " + source);
             connectSource(source);
         }
@@ -384,7 +384,9 @@ uint Applet::interval()
 
 void Applet::setInterval(uint interval)
 {
-    m_interval = interval;
+    // the systemmonitor engine requests its sensors on ticks of a quarter second
+    // anyway, and the applets using the same interval share the polling of a source
+    m_interval = qMax(1u, (interval + 125) / 250) * 250;
 }
 
 QString Applet::title()
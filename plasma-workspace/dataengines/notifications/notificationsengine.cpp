@@ -29,13 +29,25 @@
 #include <Plasma/DataContainer>
 #include <Plasma/Service>
 
+#include <QDateTime>
+#include <QFileInfo>
 #include <QImage>
+#include <QImageReader>
 
 #include <kiconloader.h>
 
+// images are shown as large icons, this leaves room for high dpi screens
+static const int s_imageSize = KIconLoader::SizeEnormous;
+
+// an application may show this many notifications at once, then one per interval
+static const int s_rateBurst = 10;
+static const int s_rateInterval = 2000;
+
 NotificationsEngine::NotificationsEngine( QObject* parent, const QVariantList& args )
-    : Plasma::DataEngine( parent, args ), m_nextId( 1 )
+    : Plasma::DataEngine( parent, args ), m_nextId( 1 ), m_rateLimitsPruned( 0 ), m_droppedCount( 0 ), m_coalescedCount( 0 )
 {
+    m_clock.start();
+
     new NotificationsAdaptor(this);
 
     QDBusConnection dbus = QDBusConnection::sessionBus();
@@ -54,34 +66,40 @@ void NotificationsEngine::init()
 {
 }
 
-inline void copyLineRGB32(QRgb* dst, const char* src, int width)
+// Copies every step-th pixel of a line
+inline void copyLineRGB32(QRgb* dst, const char* src, int width, int step)
 {
-    const char* end = src + width * 3;
-    for (; src != end; ++dst, src+=3) {
+    const QRgb* end = dst + width;
+    for (; dst != end; ++dst, src += 3 * step) {
         *dst = qRgb(src[0], src[1], src[2]);
     }
 }
 
-inline void copyLineARGB32(QRgb* dst, const char* src, int width)
+inline void copyLineARGB32(QRgb* dst, const char* src, int width, int step)
 {
-    const char* end = src + width * 4;
-    for (; src != end; ++dst, src+=4) {
+    const QRgb* end = dst + width;
+    for (; dst != end; ++dst, src += 4 * step) {
         *dst = qRgba(src[0], src[1], src[2], src[3]);
     }
 }
 
-static QImage decodeNotificationSpecImageHint(const QDBusArgument& arg)
+static QImage decodeNotificationSpecImageHint(const QDBusArgument& arg, uint *key)
 {
     int width, height, rowStride, hasAlpha, bitsPerSample, channels;
     QByteArray pixels;
-    char* ptr;
-    char* end;
 
     arg.beginStructure();
     arg >> width >> height >> rowStride >> hasAlpha >> bitsPerSample >> channels >> pixels;
     arg.endStructure();
     //qDebug() << width << height << rowStride << hasAlpha << bitsPerSample << channels;
 
+    const uint hintKey = qHash(pixels, width) ^ (height << 16) ^ channels;
+    if (*key == hintKey) {
+        // the caller already has this image
+        return QImage();
+    }
+    *key = hintKey;
+
     #define SANITY_CHECK(condition) \
     if (!(condition)) { \
         qWarning() << "Sanity check failed on" << #condition; \
@@ -97,7 +115,7 @@ static QImage decodeNotificationSpecImageHint(const QDBusArgument& arg)
     #undef SANITY_CHECK
 
     QImage::Format format = QImage::Format_Invalid;
-    void (*fcn)(QRgb*, const char*, int) = 0;
+    void (*fcn)(QRgb*, const char*, int, int) = 0;
     if (bitsPerSample == 8) {
         if (channels == 4) {
             format = QImage::Format_ARGB32;
@@ -112,20 +130,36 @@ static QImage decodeNotificationSpecImageHint(const QDBusArgument& arg)
         return QImage();
     }
 
-    QImage image(width, height, format);
-    ptr = pixels.data();
-    end = ptr + pixels.length();
-    for (int y=0; y<height; ++y, ptr += rowStride) {
-        if (ptr + channels * width > end) {
-            qWarning() << "Image data is incomplete. y:" << y << "height:" << height;
+    // only decode every step-th pixel of large images, the rest is scaled smoothly
+    const int step = qMax(1, qMax(width, height) / (2 * s_imageSize));
+    QImage image((width + step - 1) / step, (height + step - 1) / step, format);
+    const char* ptr = pixels.constData();
+    for (int y=0; y<image.height(); ++y) {
+        const qint64 offset = qint64(y) * step * rowStride;
+        if (offset + channels * width > pixels.length()) {
+            qWarning() << "Image data is incomplete. y:" << y * step << "height:" << height;
             break;
         }
-        fcn((QRgb*)image.scanLine(y), ptr, width);
+        fcn((QRgb*)image.scanLine(y), ptr + offset, image.width(), step);
     }
 
+    if (image.width() > s_imageSize || image.height() > s_imageSize) {
+        image = image.scaled(s_imageSize, s_imageSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
     return image;
 }
 
+static QImage loadImage(const QString &path)
+{
+    // large images are scaled down while decoding
+    QImageReader reader(path);
+    const QSize size = reader.size();
+    if (size.width() > s_imageSize || size.height() > s_imageSize) {
+        reader.setScaledSize(size.scaled(s_imageSize, s_imageSize, Qt::KeepAspectRatio));
+    }
+    return reader.read();
+}
+
 static QString findImageForSpecImagePath(const QString &_path)
 {
     QString path = _path;
@@ -154,22 +188,41 @@ uint NotificationsEngine::Notify(const QString &app_name, uint replaces_id,
     qDebug() << " New Notification: " << summary << body << timeout << "& Part of:" << partOf;
     QString _body;
 
+    Plasma::DataContainer *partOfContainer = 0;
     if (partOf > 0) {
-        const QString source = QString("notification %1").arg(partOf);
-        Plasma::DataContainer *container = containerForSource(source);
-        if (container) {
-            // append the body text
-            _body = container->data()["body"].toString();
-            if (_body != body) {
-                _body.append("\n").append(body);
-            } else {
-                _body = body;
-            }
+        partOfContainer = containerForSource(QString("notification %1").arg(partOf));
+        if (partOfContainer && !replaces_id && partOfContainer->data()["body"].toString() == body) {
+            // the very same notification is still shown, this doesn't count against the rate limit
+            ++m_coalescedCount;
+            updateStatistics();
+            return partOf;
+        }
+    }
 
-            // remove the old notification and replace it with the new one
-            // TODO: maybe just update the current notification?
-            CloseNotification(partOf);
+    const QString replacedSource = QString("notification %1").arg(replaces_id);
+    const bool replacing = replaces_id && m_activeNotifications.contains(replacedSource);
+    if (!replacing && !allowNotification(app_name)) {
+        // still hand out an id, so that the application can refer to it
+        const uint id = m_nextId++;
+        ++m_droppedCount;
+        updateStatistics();
+        qDebug() << "Dropping notification" << id << "of" << app_name << ": too many notifications";
+        QMetaObject::invokeMethod(this, "NotificationClosed", Qt::QueuedConnection, Q_ARG(uint, id), Q_ARG(uint, 4));
+        return id;
+    }
+
+    if (partOfContainer) {
+        // append the body text
+        _body = partOfContainer->data()["body"].toString();
+        if (_body != body) {
+            _body.append("\n").append(body);
+        } else {
+            _body = body;
         }
+
+        // remove the old notification and replace it with the new one
+        // TODO: maybe just update the current notification?
+        CloseNotification(partOf);
     }
 
     uint id = 0;
@@ -213,21 +266,47 @@ uint NotificationsEngine::Notify(const QString &app_name, uint replaces_id,
     notificationData.insert("appRealName", appRealName);
     notificationData.insert("configurable", configurable);
 
+    // a replaced notification keeps its image if it is sent again
+    uint imageKey = m_imageKeys.value(source);
+    const uint previousImageKey = imageKey;
     QImage image;
     if (hints.contains("image_data")) {
         QDBusArgument arg = hints["image_data"].value<QDBusArgument>();
-        image = decodeNotificationSpecImageHint(arg);
+        image = decodeNotificationSpecImageHint(arg, &imageKey);
     } else if (hints.contains("image_path")) {
         QString path = findImageForSpecImagePath(hints["image_path"].toString());
-        if (!path.isEmpty()) {
-            image.load(path);
+        if (path.isEmpty()) {
+            imageKey = 0;
+        } else {
+            // the file may have been rewritten in place, e.g. with the cover of the next song
+            const QFileInfo info(path);
+            const uint pathKey = qHash(QString("%1\n%2\n%3").arg(path)
+                                       .arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size()));
+            if (pathKey != imageKey) {
+                imageKey = pathKey;
+                image = loadImage(path);
+            }
         }
     } else if (hints.contains("icon_data")) {
         // This hint was in use in version 1.0 of the spec but has been
         // replaced by "image_data" in version 1.1. We need to support it for
         // users of the 1.0 version of the spec.
         QDBusArgument arg = hints["icon_data"].value<QDBusArgument>();
-        image = decodeNotificationSpecImageHint(arg);
+        image = decodeNotificationSpecImageHint(arg, &imageKey);
+    } else {
+        imageKey = 0;
+    }
+
+    Plasma::DataContainer *container = replacing ? containerForSource(source) : 0;
+    if (container && imageKey && imageKey == previousImageKey) {
+        image = container->data()["image"].value<QImage>();
+        ++m_coalescedCount;
+        updateStatistics();
+    }
+    if (imageKey) {
+        m_imageKeys.insert(source, imageKey);
+    } else {
+        m_imageKeys.remove(source);
     }
     notificationData.insert("image", image);
 
@@ -248,6 +327,7 @@ void NotificationsEngine::CloseNotification(uint id)
     // if we don't have that notification in our list,
     // it was already closed, so don't emit
     if (m_activeNotifications.remove(source)) {
+        m_imageKeys.remove(source);
         removeSource(source);
         emit NotificationClosed(id, 3);
     }
@@ -259,11 +339,72 @@ void NotificationsEngine::userClosedNotification(uint id)
     // if we don't have that notification in our list,
     // it was already closed, so don't emit
     if (m_activeNotifications.remove(source) > 0) {
+        m_imageKeys.remove(source);
         removeSource(source);
         emit NotificationClosed(id, 2);
     }
 }
 
+bool NotificationsEngine::allowNotification(const QString &appName)
+{
+    const qint64 now = m_clock.elapsed();
+    if (now - m_rateLimitsPruned > s_rateBurst * s_rateInterval) {
+        pruneRateLimits(now);
+    }
+
+    QHash<QString, RateLimit>::iterator it = m_rateLimits.find(appName);
+    if (it == m_rateLimits.end()) {
+        RateLimit rate;
+        rate.tokens = s_rateBurst;
+        rate.refilled = now;
+        it = m_rateLimits.insert(appName, rate);
+    }
+
+    const qint64 refills = (now - it->refilled) / s_rateInterval;
+    it->tokens = qMin<qint64>(s_rateBurst, it->tokens + refills);
+    it->refilled = it->tokens == s_rateBurst ? now : it->refilled + refills * s_rateInterval;
+
+    if (it->tokens == 0) {
+        return false;
+    }
+    --it->tokens;
+    return true;
+}
+
+void NotificationsEngine::pruneRateLimits(qint64 now)
+{
+    // a full bucket is the same as none, this forgets the applications which went quiet
+    QHash<QString, RateLimit>::iterator it = m_rateLimits.begin();
+    while (it != m_rateLimits.end()) {
+        if (it->tokens + (now - it->refilled) / s_rateInterval >= s_rateBurst) {
+            it = m_rateLimits.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_rateLimitsPruned = now;
+}
+
+bool NotificationsEngine::sourceRequestEvent(const QString &source)
+{
+    if (source == QLatin1String("statistics")) {
+        setData(source, "dropped", m_droppedCount);
+        setData(source, "coalesced", m_coalescedCount);
+        return true;
+    }
+    return false;
+}
+
+void NotificationsEngine::updateStatistics()
+{
+    // only kept up to date once somebody asked for it
+    if (!containerForSource("statistics")) {
+        return;
+    }
+    setData("statistics", "dropped", m_droppedCount);
+    setData("statistics", "coalesced", m_coalescedCount);
+}
+
 Plasma::Service* NotificationsEngine::serviceForSource(const QString& source)
 {
     return new NotificationService(this, source);
@@ -23,11 +23,17 @@
 
 #include <Plasma/DataEngine>
 
+#include <QElapsedTimer>
+
 class QTimer;
 
 /**
  *  Engine which provides data sources for notifications.
  *  Each notification is represented by one source.
+ *
+ *  The "statistics" source, which is only created on request, counts the
+ *  notifications dropped by the rate limit and the ones coalesced into
+ *  an identical or replaced notification.
  */
 class NotificationsEngine : public Plasma::DataEngine
 {
@@ -64,7 +70,26 @@ Q_SIGNALS:
     void NotificationClosed( uint id, uint reason );
     void ActionInvoked( uint id, const QString& actionKey );
 
+protected:
+    bool sourceRequestEvent(const QString &source);
+
 private:
+    /**
+     * Takes a notification from the rate limit of @p appName
+     * @return false if the application sent too many notifications lately
+     */
+    bool allowNotification(const QString &appName);
+    void pruneRateLimits(qint64 now);
+    void updateStatistics();
+
+    /**
+     * Token bucket of an application, refilled by one notification per interval
+     */
+    struct RateLimit {
+        int tokens;
+        qint64 refilled;
+    };
+
     /**
      * Holds the id that will be assigned to the next notification source
      * that will be created
@@ -73,6 +98,14 @@ private:
 
     QHash<QString, QString> m_activeNotifications;
 
+    QHash<QString, RateLimit> m_rateLimits;
+    QElapsedTimer m_clock;
+    qint64 m_rateLimitsPruned;
+    // the hash of the image hint of each notification, so replacing it with the same image doesn't decode it again
+    QHash<QString, uint> m_imageKeys;
+    uint m_droppedCount;
+    uint m_coalescedCount;
+
     friend class NotificationAction;
 };
 
@@ -40,8 +40,11 @@
 #include <QMenu>
 #include <QPixmap>
 #include <QSysInfo>
+#include <QtEndian>
 
-#include <netinet/in.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include <dbusmenuimporter.h>
 #ifndef DBUSMENUQT_VERSION
@@ -49,6 +52,11 @@
 #define DBUSMENUQT_VERSION 0x000305
 #endif
 
+// the updates of animated icons are limited to this interval
+static const int s_iconUpdateInterval = 100;
+// in pixels, enough for a few dozen frames of an animation
+static const int s_pixmapCacheSize = 64 * 64 * 32;
+
 class PlasmaDBusMenuImporter : public DBusMenuImporter
 {
 public:
@@ -71,11 +79,11 @@ StatusNotifierItemSource::StatusNotifierItemSource(const QString &notifierItemId
     : Plasma::DataContainer(parent),
       m_customIconLoader(0),
       m_menuImporter(0),
+      m_pixmapCache(s_pixmapCacheSize),
+      m_pendingUpdates(FullUpdate),
+      m_requestedUpdates(0),
+      m_pendingReplies(0),
       m_refreshing(false),
-      m_needsReRefreshing(false),
-      m_titleUpdate(true),
-      m_iconUpdate(true),
-      m_tooltipUpdate(true),
       m_statusUpdate(true)
 {
     setObjectName(notifierItemId);
@@ -100,15 +108,14 @@ StatusNotifierItemSource::StatusNotifierItemSource(const QString &notifierItemId
                                                                      QDBusConnection::sessionBus(), this);
 
     m_refreshTimer.setSingleShot(true);
-    m_refreshTimer.setInterval(10);
     connect(&m_refreshTimer, SIGNAL(timeout()), this, SLOT(performRefresh()));
 
     m_valid = !service.isEmpty() && m_statusNotifierItemInterface->isValid();
     if (m_valid) {
         connect(m_statusNotifierItemInterface, SIGNAL(NewTitle()), this, SLOT(refreshTitle()));
         connect(m_statusNotifierItemInterface, SIGNAL(NewIcon()), this, SLOT(refreshIcons()));
-        connect(m_statusNotifierItemInterface, SIGNAL(NewAttentionIcon()), this, SLOT(refreshIcons()));
-        connect(m_statusNotifierItemInterface, SIGNAL(NewOverlayIcon()), this, SLOT(refreshIcons()));
+        connect(m_statusNotifierItemInterface, SIGNAL(NewAttentionIcon()), this, SLOT(refreshAttentionIcon()));
+        connect(m_statusNotifierItemInterface, SIGNAL(NewOverlayIcon()), this, SLOT(refreshOverlayIcon()));
         connect(m_statusNotifierItemInterface, SIGNAL(NewToolTip()), this, SLOT(refreshToolTip()));
         connect(m_statusNotifierItemInterface, SIGNAL(NewStatus(QString)), this, SLOT(syncStatus(QString)));
         refresh();
@@ -142,78 +149,185 @@ void StatusNotifierItemSource::syncStatus(QString status)
 
 void StatusNotifierItemSource::refreshTitle()
 {
-    m_titleUpdate = true;
+    m_pendingUpdates |= TitleUpdate;
     refresh();
 }
 
 void StatusNotifierItemSource::refreshIcons()
 {
-    m_iconUpdate = true;
+    m_pendingUpdates |= IconUpdate;
+    refresh();
+}
+
+void StatusNotifierItemSource::refreshAttentionIcon()
+{
+    m_pendingUpdates |= AttentionIconUpdate;
+    refresh();
+}
+
+void StatusNotifierItemSource::refreshOverlayIcon()
+{
+    m_pendingUpdates |= OverlayIconUpdate;
     refresh();
 }
 
 void StatusNotifierItemSource::refreshToolTip()
 {
-    m_tooltipUpdate = true;
+    m_pendingUpdates |= ToolTipUpdate;
     refresh();
 }
 
 void StatusNotifierItemSource::refresh()
 {
     if (!m_refreshTimer.isActive()) {
-        m_refreshTimer.start();
+        m_refreshTimer.start(10);
     }
 }
 
 void StatusNotifierItemSource::performRefresh()
 {
-    if (m_refreshing) {
-        m_needsReRefreshing = true;
+    // whatever changes meanwhile is fetched once the replies are in
+    if (m_refreshing || !m_pendingUpdates) {
         return;
     }
 
+    if ((m_pendingUpdates & IconUpdates) && !(m_pendingUpdates & FullUpdate) && m_lastIconUpdate.isValid()) {
+        const qint64 remaining = s_iconUpdateInterval - m_lastIconUpdate.elapsed();
+        if (remaining > 0) {
+            m_refreshTimer.start(remaining);
+            return;
+        }
+    }
+
     m_refreshing = true;
-    QDBusMessage message = QDBusMessage::createMethodCall(m_statusNotifierItemInterface->service(),
-                                                          m_statusNotifierItemInterface->path(), "org.freedesktop.DBus.Properties", "GetAll");
+    m_requestedUpdates = m_pendingUpdates;
+    m_pendingUpdates = 0;
 
-    message << m_statusNotifierItemInterface->interface();
-    QDBusPendingCall call = m_statusNotifierItemInterface->connection().asyncCall(message);
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
-    connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(refreshCallback(QDBusPendingCallWatcher*)));
-}
+    if (m_requestedUpdates & FullUpdate) {
+        QDBusMessage message = QDBusMessage::createMethodCall(m_statusNotifierItemInterface->service(),
+                                                              m_statusNotifierItemInterface->path(), "org.freedesktop.DBus.Properties", "GetAll");
 
-/**
-  \todo add a smart pointer to guard call and to automatically delete it at the end of the function
-  */
-void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
-{
-    m_refreshing = false;
-    if (m_needsReRefreshing) {
-        m_needsReRefreshing = false;
-        performRefresh();
-        call->deleteLater();
+        message << m_statusNotifierItemInterface->interface();
+        QDBusPendingCall call = m_statusNotifierItemInterface->connection().asyncCall(message);
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+        connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(refreshCallback(QDBusPendingCallWatcher*)));
         return;
     }
 
+    // only fetch what the item announced as changed, GetAll would send all the pixmaps again
+    QStringList names;
+    if (m_requestedUpdates & TitleUpdate) {
+        names << "Title";
+    }
+    if (m_requestedUpdates & IconUpdate) {
+        names << "IconName" << "IconPixmap";
+    }
+    if (m_requestedUpdates & AttentionIconUpdate) {
+        names << "AttentionIconName" << "AttentionIconPixmap" << "AttentionMovieName";
+    }
+    if (m_requestedUpdates & OverlayIconUpdate) {
+        names << "OverlayIconName" << "OverlayIconPixmap";
+    }
+    if (m_requestedUpdates & ToolTipUpdate) {
+        names << "ToolTip";
+    }
+
+    m_pendingReplies = names.count();
+    Q_FOREACH (const QString &name, names) {
+        QDBusMessage message = QDBusMessage::createMethodCall(m_statusNotifierItemInterface->service(),
+                                                              m_statusNotifierItemInterface->path(), "org.freedesktop.DBus.Properties", "Get");
+
+        message << m_statusNotifierItemInterface->interface() << name;
+        QDBusPendingCall call = m_statusNotifierItemInterface->connection().asyncCall(message);
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+        watcher->setProperty("property", name);
+        connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(propertyCallback(QDBusPendingCallWatcher*)));
+    }
+}
+
+void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
+{
     QDBusPendingReply<QVariantMap> reply = *call;
+    call->deleteLater();
+
     if (reply.isError()) {
         m_valid = false;
     } else {
-        // record what has changed
-        setData("TitleChanged", m_titleUpdate);
-        m_titleUpdate = false;
-        setData("IconsChanged", m_iconUpdate);
-        m_iconUpdate = false;
-        setData("ToolTipChanged", m_tooltipUpdate);
-        m_tooltipUpdate = false;
-        setData("StatusChanged", m_statusUpdate);
-        m_statusUpdate = false;
+        m_properties.clear();
+        const QVariantMap properties = reply.argumentAt<0>();
+        for (QVariantMap::const_iterator it = properties.constBegin(); it != properties.constEnd(); ++it) {
+            storeProperty(it.key(), it.value());
+        }
+    }
 
+    finishRefresh(!reply.isError());
+}
+
+void StatusNotifierItemSource::propertyCallback(QDBusPendingCallWatcher *call)
+{
+    QDBusPendingReply<QDBusVariant> reply = *call;
+    call->deleteLater();
+
+    // optional properties may not be implemented by the item
+    const QString name = call->property("property").toString();
+    if (reply.isError()) {
+        m_properties.remove(name);
+    } else {
+        storeProperty(name, reply.value().variant());
+    }
+
+    if (--m_pendingReplies == 0) {
+        finishRefresh(true);
+    }
+}
+
+void StatusNotifierItemSource::storeProperty(const QString &name, const QVariant &value)
+{
+    // a QDBusArgument can only be read once, keep the structures themselves
+    if (value.userType() != qMetaTypeId<QDBusArgument>()) {
+        m_properties.insert(name, value);
+    } else if (name == QLatin1String("ToolTip")) {
+        KDbusToolTipStruct toolTip;
+        value.value<QDBusArgument>() >> toolTip;
+        m_properties.insert(name, QVariant::fromValue(toolTip));
+    } else if (name.endsWith(QLatin1String("Pixmap"))) {
+        KDbusImageVector image;
+        value.value<QDBusArgument>() >> image;
+        m_properties.insert(name, QVariant::fromValue(image));
+    } else {
+        m_properties.insert(name, value);
+    }
+}
+
+void StatusNotifierItemSource::finishRefresh(bool success)
+{
+    m_refreshing = false;
+    if (success) {
+        updateData(m_requestedUpdates);
+    }
+    m_requestedUpdates = 0;
+    checkForUpdate();
+
+    if (m_pendingUpdates) {
+        refresh();
+    }
+}
+
+void StatusNotifierItemSource::updateData(int updates)
+{
+    const bool full = updates & FullUpdate;
+
+    // record what has changed
+    setData("TitleChanged", full || (updates & TitleUpdate));
+    setData("ToolTipChanged", full || (updates & ToolTipUpdate));
+    setData("StatusChanged", m_statusUpdate);
+    m_statusUpdate = false;
+
+    if (full) {
         //IconThemePath (handle this one first, because it has an impact on
         //others)
-        QVariantMap properties = reply.argumentAt<0>();
         if (!m_customIconLoader) {
-            QString path = properties["IconThemePath"].toString();
+            QString path = m_properties["IconThemePath"].toString();
             if (!path.isEmpty()) {
                 // FIXME: If last part of path is not "icons", this won't work!
                 QStringList tokens = path.split('/', QString::SkipEmptyParts);
@@ -233,126 +347,165 @@ void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
                 }
             }
         }
-        setData("IconThemePath", properties["IconThemePath"]);
-
-        setData("Category", properties["Category"]);
-        setData("Status", properties["Status"]);
-        setData("Title", properties["Title"]);
-        setData("Id", properties["Id"]);
-        setData("WindowId", properties["WindowId"]);
-        setData("ItemIsMenu", properties["ItemIsMenu"]);
-
-        //Attention Movie
-        setData("AttentionMovieName", properties["AttentionMovieName"]);
-
-        QIcon overlay;
-        QStringList overlayNames;
-
-        //Icon
-        {
-            KDbusImageVector image;
-            QIcon icon;
-            QString iconName;
-
-            properties["OverlayIconPixmap"].value<QDBusArgument>() >> image;
-            if (image.isEmpty()) {
-                QString iconName = properties["OverlayIconName"].toString();
-                setData("OverlayIconName", iconName);
-                if (!iconName.isEmpty()) {
-                    overlayNames << iconName;
-                    overlay = KIcon(iconName, iconLoader());
-                }
-            } else {
-                overlay = imageVectorToPixmap(image);
-            }
+        setData("IconThemePath", m_properties["IconThemePath"]);
 
-            properties["IconPixmap"].value<QDBusArgument>() >> image;
-            if (image.isEmpty()) {
-                iconName = properties["IconName"].toString();
-                if (!iconName.isEmpty()) {
-                    icon = KIcon(iconName, iconLoader(), overlayNames);
+        setData("Category", m_properties["Category"]);
+        setData("Status", m_properties["Status"]);
+        setData("Id", m_properties["Id"]);
+        setData("WindowId", m_properties["WindowId"]);
+        setData("ItemIsMenu", m_properties["ItemIsMenu"]);
+    }
 
-                    if (overlayNames.isEmpty() && !overlay.isNull()) {
-                        overlayIcon(&icon, &overlay);
-                    }
-                }
+    if (full || (updates & TitleUpdate)) {
+        setData("Title", m_properties["Title"]);
+    }
+
+    bool iconsChanged = false;
+    if (full || (updates & IconUpdates)) {
+        iconsChanged = updateIcons();
+    }
+    setData("IconsChanged", iconsChanged);
+
+    if (full || (updates & ToolTipUpdate)) {
+        updateToolTip();
+    }
+
+    //Menu
+    if (full && !m_menuImporter) {
+        QString menuObjectPath = m_properties["Menu"].value<QDBusObjectPath>().path();
+        if (!menuObjectPath.isEmpty()) {
+            if (menuObjectPath == "/NO_DBUSMENU") {
+                // This is a hack to make it possible to disable DBusMenu in an
+                // application. The string "/NO_DBUSMENU" must be the same as in
+                // KStatusNotifierItem::setContextMenu().
+                qWarning() << "DBusMenu disabled for this application";
             } else {
-                icon = imageVectorToPixmap(image);
-                if (!icon.isNull() && !overlay.isNull()) {
-                    overlayIcon(&icon, &overlay);
-                }
+                m_menuImporter = new PlasmaDBusMenuImporter(m_statusNotifierItemInterface->service(), menuObjectPath, iconLoader(), this);
+#if DBUSMENUQT_VERSION >= 0x000400
+                connect(m_menuImporter, SIGNAL(menuUpdated()), this, SLOT(contextMenuReady()));
+#endif
             }
-            setData("Icon", icon);
-            setData("IconName", iconName);
         }
+    }
+}
 
-        //Attention icon
-        {
-            KDbusImageVector image;
-            QIcon attentionIcon;
-
-            properties["AttentionIconPixmap"].value<QDBusArgument>() >> image;
-            if (image.isEmpty()) {
-                QString iconName = properties["AttentionIconName"].toString();
-                setData("AttentionIconName", iconName);
-                if (!iconName.isEmpty()) {
-                    attentionIcon = KIcon(iconName, iconLoader(), overlayNames);
-
-                    if (overlayNames.isEmpty() && !overlay.isNull()) {
-                        overlayIcon(&attentionIcon, &overlay);
-                    }
-                }
-            } else {
-                attentionIcon = imageVectorToPixmap(image);
-                if (!attentionIcon.isNull() && !overlay.isNull()) {
-                    overlayIcon(&attentionIcon, &overlay);
-                }
+static quint64 imageHash(const KDbusImageStruct &image)
+{
+    return (quint64(qHash(image.data, image.width)) << 32) | qHash(image.data, image.height);
+}
+
+static QString imageVectorKey(const KDbusImageVector &vector)
+{
+    QString key;
+    Q_FOREACH (const KDbusImageStruct &image, vector) {
+        key += QString::number(imageHash(image), 16) + QLatin1Char(',');
+    }
+    return key;
+}
+
+bool StatusNotifierItemSource::updateIcons()
+{
+    const KDbusImageVector overlayImage = m_properties["OverlayIconPixmap"].value<KDbusImageVector>();
+    const KDbusImageVector iconImage = m_properties["IconPixmap"].value<KDbusImageVector>();
+    const KDbusImageVector attentionImage = m_properties["AttentionIconPixmap"].value<KDbusImageVector>();
+
+    // many items announce a new icon without changing it, or cycle through the same frames
+    const QString iconKey = (QStringList()
+        << m_properties["OverlayIconName"].toString() << imageVectorKey(overlayImage)
+        << m_properties["IconName"].toString() << imageVectorKey(iconImage)
+        << m_properties["AttentionIconName"].toString() << imageVectorKey(attentionImage)
+        << m_properties["AttentionMovieName"].toString()).join(QLatin1Char('\n'));
+    if (iconKey == m_iconKey) {
+        return false;
+    }
+    m_iconKey = iconKey;
+    m_lastIconUpdate.start();
+
+    //Attention Movie
+    setData("AttentionMovieName", m_properties["AttentionMovieName"]);
+
+    QIcon overlay;
+    QStringList overlayNames;
+
+    //Icon
+    {
+        QIcon icon;
+        QString iconName;
+
+        if (overlayImage.isEmpty()) {
+            QString iconName = m_properties["OverlayIconName"].toString();
+            setData("OverlayIconName", iconName);
+            if (!iconName.isEmpty()) {
+                overlayNames << iconName;
+                overlay = KIcon(iconName, iconLoader());
             }
-            setData("AttentionIcon", attentionIcon);
+        } else {
+            overlay = imageVectorToPixmap(overlayImage);
         }
 
-        //ToolTip
-        {
-            KDbusToolTipStruct toolTip;
-            properties["ToolTip"].value<QDBusArgument>() >> toolTip;
-            if (toolTip.title.isEmpty()) {
-                setData("ToolTipTitle", QVariant());
-                setData("ToolTipSubTitle", QVariant());
-                setData("ToolTipIcon", QVariant());
-            } else {
-                QIcon toolTipIcon;
-                if (toolTip.image.size() == 0) {
-                    toolTipIcon = KIcon(toolTip.icon, iconLoader());
-                } else {
-                    toolTipIcon = imageVectorToPixmap(toolTip.image);
+        if (iconImage.isEmpty()) {
+            iconName = m_properties["IconName"].toString();
+            if (!iconName.isEmpty()) {
+                icon = KIcon(iconName, iconLoader(), overlayNames);
+
+                if (overlayNames.isEmpty() && !overlay.isNull()) {
+                    overlayIcon(&icon, &overlay);
                 }
-                setData("ToolTipTitle", toolTip.title);
-                setData("ToolTipSubTitle", toolTip.subTitle);
-                setData("ToolTipIcon", toolTipIcon);
+            }
+        } else {
+            icon = imageVectorToPixmap(iconImage);
+            if (!icon.isNull() && !overlay.isNull()) {
+                overlayIcon(&icon, &overlay);
             }
         }
+        setData("Icon", icon);
+        setData("IconName", iconName);
+    }
 
-        //Menu
-        if (!m_menuImporter) {
-            QString menuObjectPath = properties["Menu"].value<QDBusObjectPath>().path();
-            if (!menuObjectPath.isEmpty()) {
-                if (menuObjectPath == "/NO_DBUSMENU") {
-                    // This is a hack to make it possible to disable DBusMenu in an
-                    // application. The string "/NO_DBUSMENU" must be the same as in
-                    // KStatusNotifierItem::setContextMenu().
-                    qWarning() << "DBusMenu disabled for this application";
-                } else {
-                    m_menuImporter = new PlasmaDBusMenuImporter(m_statusNotifierItemInterface->service(), menuObjectPath, iconLoader(), this);
-#if DBUSMENUQT_VERSION >= 0x000400
-                    connect(m_menuImporter, SIGNAL(menuUpdated()), this, SLOT(contextMenuReady()));
-#endif
+    //Attention icon
+    {
+        QIcon attentionIcon;
+
+        if (attentionImage.isEmpty()) {
+            QString iconName = m_properties["AttentionIconName"].toString();
+            setData("AttentionIconName", iconName);
+            if (!iconName.isEmpty()) {
+                attentionIcon = KIcon(iconName, iconLoader(), overlayNames);
+
+                if (overlayNames.isEmpty() && !overlay.isNull()) {
+                    overlayIcon(&attentionIcon, &overlay);
                 }
             }
+        } else {
+            attentionIcon = imageVectorToPixmap(attentionImage);
+            if (!attentionIcon.isNull() && !overlay.isNull()) {
+                overlayIcon(&attentionIcon, &overlay);
+            }
         }
+        setData("AttentionIcon", attentionIcon);
     }
 
-    checkForUpdate();
-    call->deleteLater();
+    return true;
+}
+
+void StatusNotifierItemSource::updateToolTip()
+{
+    const KDbusToolTipStruct toolTip = m_properties["ToolTip"].value<KDbusToolTipStruct>();
+    if (toolTip.title.isEmpty()) {
+        setData("ToolTipTitle", QVariant());
+        setData("ToolTipSubTitle", QVariant());
+        setData("ToolTipIcon", QVariant());
+    } else {
+        QIcon toolTipIcon;
+        if (toolTip.image.size() == 0) {
+            toolTipIcon = KIcon(toolTip.icon, iconLoader());
+        } else {
+            toolTipIcon = imageVectorToPixmap(toolTip.image);
+        }
+        setData("ToolTipTitle", toolTip.title);
+        setData("ToolTipSubTitle", toolTip.subTitle);
+        setData("ToolTipIcon", toolTipIcon);
+    }
 }
 
 void StatusNotifierItemSource::contextMenuReady()
@@ -366,28 +519,55 @@ void StatusNotifierItemSource::contextMenuReady()
     emit contextMenuReady(m_menuImporter->menu());
 }
 
+// Converts the pixels from network byte order
+static void argbFromBigEndian(const uchar *src, quint32 *dst, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    // swap the 16 bit halves of four pixels at once, then the bytes within the halves
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i));
+        pixels = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        pixels = _mm_or_si128(_mm_slli_epi16(pixels, 8), _mm_srli_epi16(pixels, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), pixels);
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = qFromBigEndian<quint32>(src + 4 * i);
+    }
+}
+
 QPixmap StatusNotifierItemSource::KDbusImageStructToPixmap(const KDbusImageStruct &image) const
 {
-    //swap from network byte order if we are little endian
-    if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
-        uint *uintBuf = (uint *) image.data.data();
-        for (uint i = 0; i < image.data.size()/sizeof(uint); ++i) {
-            *uintBuf = ntohl(*uintBuf);
-            ++uintBuf;
-        }
+    if (image.width <= 0 || image.height <= 0 || image.data.size() / 4 / image.width < image.height) {
+        return QPixmap();
     }
-    QImage iconImage(image.width, image.height, QImage::Format_ARGB32 );
-    memcpy(iconImage.bits(), (uchar*)image.data.data(), iconImage.numBytes());
+
+    // the data is converted into the image directly, instead of swapping the shared bytes in place
+    QImage iconImage(image.width, image.height, QImage::Format_ARGB32);
+    argbFromBigEndian(reinterpret_cast<const uchar *>(image.data.constData()),
+                      reinterpret_cast<quint32 *>(iconImage.bits()), image.width * image.height);
 
     return QPixmap::fromImage(iconImage);
 }
 
-QIcon StatusNotifierItemSource::imageVectorToPixmap(const KDbusImageVector &vector) const
+QIcon StatusNotifierItemSource::imageVectorToPixmap(const KDbusImageVector &vector)
 {
     QIcon icon;
 
     for (int i = 0; i<vector.size(); ++i) {
-        icon.addPixmap(KDbusImageStructToPixmap(vector[i]));
+        const KDbusImageStruct &image = vector[i];
+        const quint64 key = imageHash(image);
+        if (QPixmap *pixmap = m_pixmapCache.object(key)) {
+            icon.addPixmap(*pixmap);
+            continue;
+        }
+
+        const QPixmap pixmap = KDbusImageStructToPixmap(image);
+        if (!pixmap.isNull()) {
+            icon.addPixmap(pixmap);
+            m_pixmapCache.insert(key, new QPixmap(pixmap), image.width * image.height);
+        }
     }
 
     return icon;
@@ -23,6 +23,8 @@
 #define STATUSNOTIFIERITEMSOURCE_H
 
 #include <Plasma/DataContainer>
+#include <QCache>
+#include <QElapsedTimer>
 #include <QString>
 #include <QDBusPendingCallWatcher>
 #include <QtWidgets/QMenu>
@@ -55,16 +57,34 @@ private Q_SLOTS:
     void contextMenuReady();
     void refreshTitle();
     void refreshIcons();
+    void refreshAttentionIcon();
+    void refreshOverlayIcon();
     void refreshToolTip();
     void refresh();
     void performRefresh();
     void syncStatus(QString);
     void refreshCallback(QDBusPendingCallWatcher *);
+    void propertyCallback(QDBusPendingCallWatcher *);
 
 private:
+    enum Update {
+        TitleUpdate = 1,
+        IconUpdate = 2,
+        AttentionIconUpdate = 4,
+        OverlayIconUpdate = 8,
+        ToolTipUpdate = 16,
+        FullUpdate = 32,
+        IconUpdates = IconUpdate | AttentionIconUpdate | OverlayIconUpdate
+    };
+
+    void storeProperty(const QString &name, const QVariant &value);
+    void finishRefresh(bool success);
+    void updateData(int updates);
+    bool updateIcons();
+    void updateToolTip();
 
     QPixmap KDbusImageStructToPixmap(const KDbusImageStruct &image) const;
-    QIcon imageVectorToPixmap(const KDbusImageVector &vector) const;
+    QIcon imageVectorToPixmap(const KDbusImageVector &vector);
     void overlayIcon(QIcon *icon, QIcon *overlay);
     KIconLoader *iconLoader() const;
 
@@ -75,11 +95,16 @@ private:
     KIconLoader *m_customIconLoader;
     DBusMenuImporter *m_menuImporter;
     org::kde::StatusNotifierItem *m_statusNotifierItemInterface;
+    // the last received properties, with the structures demarshalled
+    QVariantMap m_properties;
+    // the pixmaps received recently by their hash, animated icons repeat their frames
+    QCache<quint64, QPixmap> m_pixmapCache;
+    QString m_iconKey;
+    QElapsedTimer m_lastIconUpdate;
+    int m_pendingUpdates;
+    int m_requestedUpdates;
+    int m_pendingReplies;
     bool m_refreshing : 1;
-    bool m_needsReRefreshing : 1;
-    bool m_titleUpdate : 1;
-    bool m_iconUpdate : 1;
-    bool m_tooltipUpdate : 1;
     bool m_statusUpdate : 1;
 };
 
@@ -18,6 +18,7 @@
 
 #include "systemmonitor.h"
 
+#include <QDateTime>
 #include <QTimer>
 #include <QProcess>
 
@@ -28,6 +29,10 @@
 
 #include <ksgrd/SensorManager.h>
 
+// The sensors are requested on the ticks of this period, so that the updates of
+// all the consumers, whatever their intervals, end up in a few batches
+static const int s_tickInterval = 250;
+
 SystemMonitorEngine::SystemMonitorEngine(QObject* parent, const QVariantList& args)
     : Plasma::DataEngine(parent)
 {
@@ -37,6 +42,9 @@ SystemMonitorEngine::SystemMonitorEngine(QObject* parent, const QVariantList& ar
     KSGRD::SensorMgr->engage("localhost", "", "ksysguardd");
 
     m_waitingFor= 0;
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(sendRequests()));
     connect(KSGRD::SensorMgr, SIGNAL(update()), this, SLOT(updateMonitorsList()));
     updateMonitorsList();
 }
@@ -73,16 +81,39 @@ bool SystemMonitorEngine::sourceRequestEvent(const QString &name)
 
 bool SystemMonitorEngine::updateSourceEvent(const QString &sensorName)
 {
-    const int index = m_sensors.indexOf(sensorName);
+    if (!m_sensors.contains(sensorName)) {
+        return false;
+    }
 
-    if (index != -1) {
-        KSGRD::SensorMgr->sendRequest("localhost", sensorName, (KSGRD::SensorClient*)this, index);
-        KSGRD::SensorMgr->sendRequest("localhost", QString("%1?").arg(sensorName), (KSGRD::SensorClient*)this, -(index + 2));
+    // consumers asking for the same sensor before the next tick share one request
+    m_pendingSensors.insert(sensorName);
+    if (!m_timer->isActive()) {
+        m_timer->start(s_tickInterval - QDateTime::currentMSecsSinceEpoch() % s_tickInterval);
     }
 
     return false;
 }
 
+void SystemMonitorEngine::sendRequests()
+{
+    foreach (const QString &sensorName, m_pendingSensors) {
+        const int index = m_sensors.indexOf(sensorName);
+        if (index == -1) {
+            continue;
+        }
+
+        KSGRD::SensorMgr->sendRequest("localhost", sensorName, (KSGRD::SensorClient*)this, index);
+
+        // the sensor info is requested with the monitors list, only ask again if it got lost
+        Plasma::DataContainer *container = containerForSource(sensorName);
+        if (container && !container->data().contains("units")) {
+            KSGRD::SensorMgr->sendRequest("localhost", QString("%1?").arg(sensorName), (KSGRD::SensorClient*)this, -(index + 2));
+        }
+    }
+
+    m_pendingSensors.clear();
+}
+
 void SystemMonitorEngine::updateSensors()
 {
     DataEngine::SourceDict sources = containerDict();
@@ -23,6 +23,7 @@
 
 #include <ksgrd/SensorClient.h>
 
+#include <QSet>
 #include <QStringList>
 
 class QTimer;
@@ -50,9 +51,12 @@ class SystemMonitorEngine : public Plasma::DataEngine, public KSGRD::SensorClien
     protected Q_SLOTS:
         void updateSensors();
         void updateMonitorsList();
+        /** Sends the requests for all the sensors updated since the last tick at once */
+        void sendRequests();
 
     private:
         QStringList m_sensors;
+        QSet<QString> m_pendingSensors;
         QTimer* m_timer;
         int m_waitingFor;
 };
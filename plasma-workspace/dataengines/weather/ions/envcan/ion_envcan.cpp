@@ -29,7 +29,8 @@
 
 // ctor, dtor
 EnvCanadaIon::EnvCanadaIon(QObject *parent, const QVariantList &args)
-        : IonInterface(parent, args)
+        : IonInterface(parent, args),
+        m_catalogue("envcan")
 {
 }
 
@@ -67,8 +68,16 @@ EnvCanadaIon::~EnvCanadaIon()
 // Get the master list of locations to be parsed
 void EnvCanadaIon::init()
 {
+    // The cached list is good enough to start with, it rarely changes
+    if (m_catalogue.load()) {
+        loadPlaces();
+        setInitialized(true);
+    }
+
     // Get the real city XML URL so we can parse this
-    getXMLSetup();
+    if (m_catalogue.isStale()) {
+        getXMLSetup();
+    }
     m_timeEngine = dataEngine("time");
 }
 
@@ -427,13 +436,8 @@ QMap<QString, IonInterface::ConditionIcons> const& EnvCanadaIon::forecastIcons(v
 QStringList EnvCanadaIon::validate(const QString& source) const
 {
     QStringList placeList;
-    QString sourceNormalized = source.toUpper();
-    QHash<QString, EnvCanadaIon::XMLMapInfo>::const_iterator it = m_places.constBegin();
-    while (it != m_places.constEnd()) {
-        if (it.key().toUpper().contains(sourceNormalized)) {
-            placeList.append(QString("place|").append(it.key()));
-        }
-        ++it;
+    foreach (const QString &place, m_catalogue.search(source)) {
+        placeList.append(QString("place|").append(place));
     }
 
     // Check if placeList is empty if so, return nothing.
@@ -493,6 +497,7 @@ void EnvCanadaIon::getXMLSetup()
     // If network is down, we need to spin and wait
 
     KIO::TransferJob *job = KIO::get(KUrl("http://dd.weatheroffice.ec.gc.ca/citypage_weather/xml/siteList.xml"), KIO::NoReload, KIO::HideProgressInfo);
+    m_catalogue.prepareRequest(job);
 
     m_xmlSetup.clear();
     connect(job, SIGNAL(data(KIO::Job*,QByteArray)), this,
@@ -588,16 +593,57 @@ void EnvCanadaIon::slotJobFinished(KJob *job)
 
 void EnvCanadaIon::setup_slotJobFinished(KJob *job)
 {
-    Q_UNUSED(job)
-    const bool success = readXMLSetup();
+    KIO::TransferJob *transferJob = qobject_cast<KIO::TransferJob *>(job);
+    if (transferJob && m_catalogue.handleResponse(transferJob)) {
+        // the cached list is still up to date
+        m_xmlSetup.clear();
+        m_catalogue.save();
+        setInitialized(true);
+        return;
+    }
+
+    bool success = readXMLSetup();
     m_xmlSetup.clear();
+    if (success) {
+        storePlaces();
+    } else {
+        // keep using the cached list while the server can't be reached
+        success = !m_catalogue.isEmpty();
+    }
     //qDebug() << success << m_sourcesToReset;
     setInitialized(success);
 }
 
+void EnvCanadaIon::loadPlaces()
+{
+    m_places.clear();
+    foreach (const QString &place, m_catalogue.places()) {
+        const QStringList fields = m_catalogue.fields(place);
+        if (fields.count() == 3) {
+            EnvCanadaIon::XMLMapInfo info;
+            info.cityCode = fields.at(0);
+            info.territoryName = fields.at(1);
+            info.cityName = fields.at(2);
+            m_places[place] = info;
+        }
+    }
+}
+
+void EnvCanadaIon::storePlaces()
+{
+    m_catalogue.clear();
+    QHash<QString, EnvCanadaIon::XMLMapInfo>::const_iterator it = m_places.constBegin();
+    for (; it != m_places.constEnd(); ++it) {
+        m_catalogue.insert(it.key(), QStringList() << it->cityCode << it->territoryName << it->cityName);
+    }
+    m_catalogue.save();
+}
+
 // Parse the city list and store into a QMap
 bool EnvCanadaIon::readXMLSetup()
 {
+    // The places in use are only replaced by a complete list
+    QHash<QString, EnvCanadaIon::XMLMapInfo> places;
     bool success = false;
     QString territory;
     QString code;
@@ -634,13 +680,17 @@ bool EnvCanadaIon::readXMLSetup()
             info.cityName = cityName;
 
             // Set the string list, we will use for the applet to display the available cities.
-            m_places[tmp] = info;
+            places[tmp] = info;
             success = true;
         }
 
     }
 
-    return (success && !m_xmlSetup.error());
+    if (!success || m_xmlSetup.error()) {
+        return false;
+    }
+    m_places.swap(places);
+    return true;
 }
 
 void EnvCanadaIon::parseWeatherSite(WeatherData& data, QXmlStreamReader& xml)
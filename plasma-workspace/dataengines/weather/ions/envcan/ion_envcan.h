@@ -30,6 +30,7 @@
 
 #include "../ion.h"
 #include "../dataengineconsumer.h"
+#include "../stationcatalogue.h"
 
 class KJob;
 namespace KIO
@@ -201,6 +202,8 @@ private:
     // Load and Parse the place XML listing
     void getXMLSetup(void);
     bool readXMLSetup(void);
+    void loadPlaces(void);
+    void storePlaces(void);
 
     // Load and parse the specific place(s)
     void getXMLData(const QString& source);
@@ -240,6 +243,7 @@ private:
 
     // Key dicts
     QHash<QString, EnvCanadaIon::XMLMapInfo> m_places;
+    StationCatalogue m_catalogue;
 
     // Weather information
     QHash<QString, WeatherData> m_weatherData;
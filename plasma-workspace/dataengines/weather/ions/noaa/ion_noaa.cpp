@@ -62,7 +62,8 @@ QMap<QString, IonInterface::WindDirections> const& NOAAIon::windIcons(void) cons
 
 // ctor, dtor
 NOAAIon::NOAAIon(QObject *parent, const QVariantList &args)
-        : IonInterface(parent, args)
+        : IonInterface(parent, args),
+        m_catalogue("noaa")
 {
     Q_UNUSED(args)
 }
@@ -80,8 +81,16 @@ NOAAIon::~NOAAIon()
 // Get the master list of locations to be parsed
 void NOAAIon::init()
 {
+    // The cached list is good enough to start with, it rarely changes
+    if (m_catalogue.load()) {
+        loadPlaces();
+        setInitialized(true);
+    }
+
     // Get the real city XML URL so we can parse this
-    getXMLSetup();
+    if (m_catalogue.isStale()) {
+        getXMLSetup();
+    }
 
     m_timeEngine = dataEngine("time");
 }
@@ -90,24 +99,25 @@ QStringList NOAAIon::validate(const QString& source) const
 {
     QStringList placeList;
     QString station;
-    QString sourceNormalized = source.toUpper();
 
-    QHash<QString, NOAAIon::XMLMapInfo>::const_iterator it = m_places.constBegin();
-    // If the source name might look like a station ID, check these too and return the name
-    bool checkState = source.count() == 2;
-
-    while (it != m_places.constEnd()) {
-        if (checkState) {
+    // A two letter source name is a state, list all of its stations
+    if (source.count() == 2) {
+        QHash<QString, NOAAIon::XMLMapInfo>::const_iterator it = m_places.constBegin();
+        for (; it != m_places.constEnd(); ++it) {
             if (it.value().stateName == source) {
                 placeList.append(QString("place|").append(it.key()));
             }
-        } else if (it.key().toUpper().contains(sourceNormalized)) {
-            placeList.append(QString("place|").append(it.key()));
-        } else if (it.value().stationID == sourceNormalized) {
-            station = QString("place|").append(it.key());
         }
-
-        ++it;
+    } else {
+        QStringList places = m_catalogue.search(source);
+        // If the source name might look like a station ID, check these too and return the name
+        const QString stationPlace = m_stations.value(source.toUpper());
+        if (!stationPlace.isEmpty() && !places.contains(stationPlace)) {
+            station = QString("place|").append(stationPlace);
+        }
+        foreach (const QString &place, places) {
+            placeList.append(QString("place|").append(place));
+        }
     }
 
     placeList.sort();
@@ -157,11 +167,13 @@ bool NOAAIon::updateIonSource(const QString& source)
 }
 
 // Parses city list and gets the correct city based on ID number
-void NOAAIon::getXMLSetup() const
+void NOAAIon::getXMLSetup()
 {
     KIO::TransferJob *job = KIO::get(KUrl("http://www.weather.gov/data/current_obs/index.xml"), KIO::NoReload, KIO::HideProgressInfo);
 
+    m_xmlSetup.clear();
     if (job) {
+        m_catalogue.prepareRequest(job);
         connect(job, SIGNAL(data(KIO::Job*,QByteArray)), this,
                 SLOT(setup_slotDataArrived(KIO::Job*,QByteArray)));
         connect(job, SIGNAL(result(KJob*)), this, SLOT(setup_slotJobFinished(KJob*)));
@@ -243,8 +255,20 @@ void NOAAIon::slotJobFinished(KJob *job)
 
 void NOAAIon::setup_slotJobFinished(KJob *job)
 {
-    Q_UNUSED(job)
-    const bool success = readXMLSetup();
+    KIO::TransferJob *transferJob = qobject_cast<KIO::TransferJob *>(job);
+    bool success;
+    if (transferJob && m_catalogue.handleResponse(transferJob)) {
+        // the cached list is still up to date
+        m_catalogue.save();
+        success = true;
+    } else if (readXMLSetup()) {
+        storePlaces();
+        success = true;
+    } else {
+        // keep using the cached list while the server can't be reached
+        success = !m_catalogue.isEmpty();
+    }
+    m_xmlSetup.clear();
     setInitialized(success);
 
     foreach (const QString &source, m_sourcesToReset) {
@@ -252,7 +276,35 @@ void NOAAIon::setup_slotJobFinished(KJob *job)
     }
 }
 
-void NOAAIon::parseStationID()
+void NOAAIon::loadPlaces()
+{
+    m_places.clear();
+    m_stations.clear();
+    foreach (const QString &place, m_catalogue.places()) {
+        const QStringList fields = m_catalogue.fields(place);
+        if (fields.count() == 4) {
+            NOAAIon::XMLMapInfo info;
+            info.stateName = fields.at(0);
+            info.stationName = fields.at(1);
+            info.stationID = fields.at(2);
+            info.XMLurl = fields.at(3);
+            m_places[place] = info;
+            m_stations[info.stationID] = place;
+        }
+    }
+}
+
+void NOAAIon::storePlaces()
+{
+    m_catalogue.clear();
+    QHash<QString, NOAAIon::XMLMapInfo>::const_iterator it = m_places.constBegin();
+    for (; it != m_places.constEnd(); ++it) {
+        m_catalogue.insert(it.key(), QStringList() << it->stateName << it->stationName << it->stationID << it->XMLurl);
+    }
+    m_catalogue.save();
+}
+
+void NOAAIon::parseStationID(QHash<QString, NOAAIon::XMLMapInfo>& places)
 {
     QString state;
     QString stationName;
@@ -271,7 +323,7 @@ void NOAAIon::parseStationID()
                 info.XMLurl = xmlurl;
 
                 QString tmp = stationName + ", " + state; // Build the key name.
-                m_places[tmp] = info;
+                places[tmp] = info;
             }
             break;
         }
@@ -292,7 +344,7 @@ void NOAAIon::parseStationID()
     }
 }
 
-void NOAAIon::parseStationList()
+void NOAAIon::parseStationList(QHash<QString, NOAAIon::XMLMapInfo>& places)
 {
     while (!m_xmlSetup.atEnd()) {
         m_xmlSetup.readNext();
@@ -303,7 +355,7 @@ void NOAAIon::parseStationList()
 
         if (m_xmlSetup.isStartElement()) {
             if (m_xmlSetup.name() == "station") {
-                parseStationID();
+                parseStationID(places);
             } else {
                 parseUnknownElement(m_xmlSetup);
             }
@@ -314,18 +366,30 @@ void NOAAIon::parseStationList()
 // Parse the city list and store into a QMap
 bool NOAAIon::readXMLSetup()
 {
+    // The places in use are only replaced by a complete list
+    QHash<QString, NOAAIon::XMLMapInfo> places;
     bool success = false;
     while (!m_xmlSetup.atEnd()) {
         m_xmlSetup.readNext();
 
         if (m_xmlSetup.isStartElement()) {
             if (m_xmlSetup.name() == "wx_station_index") {
-                parseStationList();
+                parseStationList(places);
                 success = true;
             }
         }
     }
-    return (!m_xmlSetup.error() && success);
+    if (m_xmlSetup.error() || !success) {
+        return false;
+    }
+
+    m_places.swap(places);
+    m_stations.clear();
+    QHash<QString, NOAAIon::XMLMapInfo>::const_iterator it = m_places.constBegin();
+    for (; it != m_places.constEnd(); ++it) {
+        m_stations[it->stationID] = it.key();
+    }
+    return true;
 }
 
 void NOAAIon::parseWeatherSite(WeatherData& data, QXmlStreamReader& xml)
@@ -37,6 +37,7 @@ namespace KIO
 
 #include "../dataengineconsumer.h"
 #include "../ion.h"
+#include "../stationcatalogue.h"
 
 class WeatherData
 {
@@ -133,9 +134,18 @@ private:
     QMap<QString, QString> wind(const QString& source) const;
     IonInterface::ConditionIcons getConditionIcon(const QString& weather, bool isDayTime) const;
 
+    struct XMLMapInfo {
+        QString stateName;
+        QString stationName;
+        QString stationID;
+        QString XMLurl;
+    };
+
     // Load and Parse the place XML listing
-    void getXMLSetup(void) const;
+    void getXMLSetup(void);
     bool readXMLSetup(void);
+    void loadPlaces(void);
+    void storePlaces(void);
 
     // Load and parse the specific place(s)
     void getXMLData(const QString& source);
@@ -153,18 +163,14 @@ private:
 
     // Parse weather XML data
     void parseWeatherSite(WeatherData& data, QXmlStreamReader& xml);
-    void parseStationID(void);
-    void parseStationList(void);
-
-    struct XMLMapInfo {
-        QString stateName;
-        QString stationName;
-        QString stationID;
-        QString XMLurl;
-    };
+    void parseStationID(QHash<QString, NOAAIon::XMLMapInfo>& places);
+    void parseStationList(QHash<QString, NOAAIon::XMLMapInfo>& places);
 
     // Key dicts
     QHash<QString, NOAAIon::XMLMapInfo> m_places;
+    // The places by station ID
+    QHash<QString, QString> m_stations;
+    StationCatalogue m_catalogue;
 
     // Weather information
     QHash<QString, WeatherData> m_weatherData;
@@ -0,0 +1,234 @@
+/*****************************************************************************
+ * This library is free software; you can redistribute it and/or             *
+ * modify it under the terms of the GNU Library General Public               *
+ * License as published by the Free Software Foundation; either              *
+ * version 2 of the License, or (at your option) any later version.          *
+ *                                                                           *
+ * This library is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU         *
+ * Library General Public License for more details.                          *
+ *                                                                           *
+ * You should have received a copy of the GNU Library General Public License *
+ * along with this library; see the file COPYING.LIB.  If not, write to      *
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,      *
+ * Boston, MA 02110-1301, USA.                                               *
+ *****************************************************************************/
+
+#include "stationcatalogue.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <KIO/Job>
+
+#include <QDebug>
+
+static const quint32 s_catalogueMagic = 0x53544e43; // "STNC"
+static const quint32 s_catalogueVersion = 1;
+
+// the station lists change a few times a year at most
+static const int s_maximumAge = 24 * 60 * 60;
+
+StationCatalogue::StationCatalogue(const QString &name)
+{
+    m_fileName = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                 + QLatin1String("/plasma_engine_weather/") + name + QLatin1String(".stations");
+}
+
+bool StationCatalogue::load()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic;
+    quint32 version;
+    stream >> magic >> version;
+    if (magic != s_catalogueMagic || version != s_catalogueVersion) {
+        return false;
+    }
+
+    stream.setVersion(QDataStream::Qt_5_0);
+    QDateTime fetched;
+    QString lastModified;
+    QString etag;
+    QStringList places;
+    QVector<QStringList> fields;
+    stream >> fetched >> lastModified >> etag >> places >> fields;
+    if (stream.status() != QDataStream::Ok || places.count() != fields.count() || places.isEmpty()) {
+        qDebug() << "Discarding the corrupt station list" << m_fileName;
+        return false;
+    }
+
+    clear();
+    for (int i = 0; i < places.count(); ++i) {
+        insert(places.at(i), fields.at(i));
+    }
+    m_fetched = fetched;
+    m_lastModified = lastModified;
+    m_etag = etag;
+    return true;
+}
+
+void StationCatalogue::save()
+{
+    QDir().mkpath(QFileInfo(m_fileName).path());
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Could not write the station list" << m_fileName;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << s_catalogueMagic << s_catalogueVersion;
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << m_fetched << m_lastModified << m_etag << m_places << m_fields;
+    file.commit();
+}
+
+bool StationCatalogue::isStale() const
+{
+    return !m_fetched.isValid() || m_fetched.secsTo(QDateTime::currentDateTimeUtc()) > s_maximumAge;
+}
+
+void StationCatalogue::clear()
+{
+    m_places.clear();
+    m_fields.clear();
+    m_entries.clear();
+    m_normalized.clear();
+    m_trigrams.clear();
+}
+
+void StationCatalogue::insert(const QString &place, const QStringList &fields)
+{
+    QHash<QString, int>::const_iterator it = m_entries.constFind(place);
+    if (it != m_entries.constEnd()) {
+        m_fields[it.value()] = fields;
+        return;
+    }
+
+    const int entry = m_places.count();
+    m_places.append(place);
+    m_fields.append(fields);
+    m_entries.insert(place, entry);
+    m_normalized.append(place.toUpper());
+    addToIndex(entry);
+}
+
+void StationCatalogue::addToIndex(int entry)
+{
+    const QString &name = m_normalized.at(entry);
+    for (int i = 0; i + 3 <= name.length(); ++i) {
+        QVector<int> &entries = m_trigrams[name.mid(i, 3)];
+        // a name repeating a trigram is only listed once
+        if (entries.isEmpty() || entries.last() != entry) {
+            entries.append(entry);
+        }
+    }
+}
+
+bool StationCatalogue::isEmpty() const
+{
+    return m_places.isEmpty();
+}
+
+QStringList StationCatalogue::places() const
+{
+    return m_places;
+}
+
+QStringList StationCatalogue::fields(const QString &place) const
+{
+    const int entry = m_entries.value(place, -1);
+    return entry < 0 ? QStringList() : m_fields.at(entry);
+}
+
+QStringList StationCatalogue::search(const QString &text) const
+{
+    const QString normalized = text.toUpper();
+    QStringList result;
+
+    if (normalized.length() < 3) {
+        for (int i = 0; i < m_normalized.count(); ++i) {
+            if (m_normalized.at(i).contains(normalized)) {
+                result.append(m_places.at(i));
+            }
+        }
+        return result;
+    }
+
+    // only the names with the rarest trigram of the text can contain it
+    const QVector<int> *candidates = 0;
+    for (int i = 0; i + 3 <= normalized.length(); ++i) {
+        QHash<QString, QVector<int> >::const_iterator it = m_trigrams.constFind(normalized.mid(i, 3));
+        if (it == m_trigrams.constEnd()) {
+            return result;
+        }
+        if (!candidates || it->count() < candidates->count()) {
+            candidates = &it.value();
+        }
+    }
+
+    Q_FOREACH (int entry, *candidates) {
+        if (m_normalized.at(entry).contains(normalized)) {
+            result.append(m_places.at(entry));
+        }
+    }
+    return result;
+}
+
+void StationCatalogue::prepareRequest(KIO::TransferJob *job) const
+{
+    job->addMetaData(QStringLiteral("PropagateHttpHeader"), QStringLiteral("true"));
+    if (m_places.isEmpty()) {
+        return;
+    }
+
+    QStringList headers;
+    if (!m_etag.isEmpty()) {
+        headers << QStringLiteral("If-None-Match: ") + m_etag;
+    }
+    if (!m_lastModified.isEmpty()) {
+        headers << QStringLiteral("If-Modified-Since: ") + m_lastModified;
+    }
+    if (!headers.isEmpty()) {
+        job->addMetaData(QStringLiteral("customHTTPHeader"), headers.join(QStringLiteral("\r\n")));
+    }
+}
+
+bool StationCatalogue::handleResponse(KIO::TransferJob *job)
+{
+    if (job->error()) {
+        return false;
+    }
+
+    m_fetched = QDateTime::currentDateTimeUtc();
+    if (job->queryMetaData(QStringLiteral("responsecode")) == QLatin1String("304") && !m_places.isEmpty()) {
+        return true;
+    }
+
+    m_etag.clear();
+    m_lastModified.clear();
+    const QStringList headers = job->queryMetaData(QStringLiteral("HTTP-Headers")).split(QLatin1Char('\n'));
+    Q_FOREACH (const QString &header, headers) {
+        const int colon = header.indexOf(QLatin1Char(':'));
+        if (colon < 0) {
+            continue;
+        }
+        const QString name = header.left(colon).trimmed();
+        if (name.compare(QLatin1String("ETag"), Qt::CaseInsensitive) == 0) {
+            m_etag = header.mid(colon + 1).trimmed();
+        } else if (name.compare(QLatin1String("Last-Modified"), Qt::CaseInsensitive) == 0) {
+            m_lastModified = header.mid(colon + 1).trimmed();
+        }
+    }
+    return false;
+}
@@ -0,0 +1,98 @@
+/*****************************************************************************
+ * This library is free software; you can redistribute it and/or             *
+ * modify it under the terms of the GNU Library General Public               *
+ * License as published by the Free Software Foundation; either              *
+ * version 2 of the License, or (at your option) any later version.          *
+ *                                                                           *
+ * This library is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU         *
+ * Library General Public License for more details.                          *
+ *                                                                           *
+ * You should have received a copy of the GNU Library General Public License *
+ * along with this library; see the file COPYING.LIB.  If not, write to      *
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,      *
+ * Boston, MA 02110-1301, USA.                                               *
+ *****************************************************************************/
+
+#ifndef STATIONCATALOGUE_H
+#define STATIONCATALOGUE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+namespace KIO
+{
+    class TransferJob;
+} // namespace KIO
+
+/**
+ * The station list of an ion, cached on disk between sessions.
+ *
+ * Every place is stored under the name shown to the user with the fields the
+ * ion needs to fetch its weather. The list is only downloaded again once it
+ * is older than a day, and then with a conditional request, so that an
+ * unchanged list is not sent again. Searches use a trigram index of the names.
+ */
+class StationCatalogue
+{
+public:
+    /**
+     * @param name the file name of the cache, usually the name of the ion
+     */
+    explicit StationCatalogue(const QString &name);
+
+    /**
+     * Reads the cached list
+     * @return false if there is none or it can't be read
+     */
+    bool load();
+    void save();
+
+    /**
+     * @return whether the list should be downloaded again
+     */
+    bool isStale() const;
+
+    void clear();
+    void insert(const QString &place, const QStringList &fields);
+
+    bool isEmpty() const;
+    QStringList places() const;
+    QStringList fields(const QString &place) const;
+
+    /**
+     * @return the places whose names contain @p text, regardless of the case
+     */
+    QStringList search(const QString &text) const;
+
+    /**
+     * Makes the download of the list conditional on it having changed since it was cached
+     */
+    void prepareRequest(KIO::TransferJob *job) const;
+
+    /**
+     * Remembers the validators of the response to the download of the list
+     * @return true if the cached list is still up to date
+     */
+    bool handleResponse(KIO::TransferJob *job);
+
+private:
+    void addToIndex(int entry);
+
+    QString m_fileName;
+    QDateTime m_fetched;
+    QString m_lastModified;
+    QString m_etag;
+
+    QStringList m_places;
+    QVector<QStringList> m_fields;
+    QHash<QString, int> m_entries;
+    // the upper case names, and the entries containing each trigram of them
+    QStringList m_normalized;
+    QHash<QString, QVector<int> > m_trigrams;
+};
+
+#endif
@@ -0,0 +1,284 @@
+/*****************************************************************************
+ * This library is free software; you can redistribute it and/or             *
+ * modify it under the terms of the GNU Library General Public               *
+ * License as published by the Free Software Foundation; either              *
+ * version 2 of the License, or (at your option) any later version.          *
+ *                                                                           *
+ * This library is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU         *
+ * Library General Public License for more details.                          *
+ *                                                                           *
+ * You should have received a copy of the GNU Library General Public License *
+ * along with this library; see the file COPYING.LIB.  If not, write to      *
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,      *
+ * Boston, MA 02110-1301, USA.                                               *
+ *****************************************************************************/
+
+#include "stationcatalogue.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+#include <QXmlStreamReader>
+
+#include <KIO/StoredTransferJob>
+
+/**
+ * Serves the recorded station list over HTTP, with the validators of the
+ * weather servers, and answers a matching conditional request with a 304.
+ */
+class StationListServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StationListServer(const QByteArray &body)
+        : m_body(body)
+        , m_etag("\"v1\"")
+    {
+        connect(&m_server, SIGNAL(newConnection()), this, SLOT(connection()));
+        m_server.listen(QHostAddress::LocalHost);
+    }
+
+    QUrl url() const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1/siteList.xml").arg(m_server.serverPort()));
+    }
+
+    // a new list is published under a new ETag
+    void setEtag(const QByteArray &etag)
+    {
+        m_etag = etag;
+    }
+
+    QByteArray lastRequest() const
+    {
+        return m_request;
+    }
+
+private Q_SLOTS:
+    void connection()
+    {
+        while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+            connect(socket, SIGNAL(readyRead()), this, SLOT(read()));
+            connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        }
+    }
+
+    void read()
+    {
+        QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+        m_buffer += socket->readAll();
+        if (!m_buffer.contains("\r\n\r\n")) {
+            return;
+        }
+        m_request = m_buffer;
+        m_buffer.clear();
+
+        QByteArray response;
+        if (m_request.contains("If-None-Match: " + m_etag)) {
+            response = "HTTP/1.1 304 Not Modified\r\n"
+                       "ETag: " + m_etag + "\r\n"
+                       "Connection: close\r\n\r\n";
+        } else {
+            response = "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: text/xml\r\n"
+                       "ETag: " + m_etag + "\r\n"
+                       "Last-Modified: Mon, 06 Oct 2014 12:00:00 GMT\r\n"
+                       "Content-Length: " + QByteArray::number(m_body.size()) + "\r\n"
+                       "Connection: close\r\n\r\n" + m_body;
+        }
+        socket->write(response);
+        socket->disconnectFromHost();
+    }
+
+private:
+    QTcpServer m_server;
+    QByteArray m_body;
+    QByteArray m_etag;
+    QByteArray m_buffer;
+    QByteArray m_request;
+};
+
+class TestStationCatalogue : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+    void search();
+    void saveAndLoad();
+    void conditionalRequest();
+    void changedList();
+    void failedRequest();
+
+private:
+    QByteArray recordedList() const;
+    // stores the sites of the list the way the envcan ion does
+    void insertSites(StationCatalogue &catalogue, const QByteArray &list) const;
+    bool fetch(StationCatalogue &catalogue, const QUrl &url, QByteArray *data = 0) const;
+};
+
+void TestStationCatalogue::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestStationCatalogue::cleanup()
+{
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+         + QLatin1String("/plasma_engine_weather")).removeRecursively();
+}
+
+QByteArray TestStationCatalogue::recordedList() const
+{
+    QFile file(QFINDTESTDATA("data/siteList.xml"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+void TestStationCatalogue::insertSites(StationCatalogue &catalogue, const QByteArray &list) const
+{
+    QXmlStreamReader xml(list);
+    QString code;
+    QString name;
+    QString province;
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isStartElement()) {
+            if (xml.name() == "site") {
+                code = xml.attributes().value("code").toString();
+            } else if (xml.name() == "nameEn") {
+                name = xml.readElementText();
+            } else if (xml.name() == "provinceCode") {
+                province = xml.readElementText();
+            }
+        } else if (xml.isEndElement() && xml.name() == "site") {
+            catalogue.insert(name + ", " + province, QStringList() << code << province << name);
+        }
+    }
+}
+
+bool TestStationCatalogue::fetch(StationCatalogue &catalogue, const QUrl &url, QByteArray *data) const
+{
+    // bypasses the HTTP cache of KIO, the requests have to reach the server
+    KIO::StoredTransferJob *job = KIO::storedGet(url, KIO::Reload, KIO::HideProgressInfo);
+    catalogue.prepareRequest(job);
+    job->exec();
+    if (data) {
+        *data = job->data();
+    }
+    return catalogue.handleResponse(job);
+}
+
+void TestStationCatalogue::search()
+{
+    StationCatalogue catalogue(QStringLiteral("test"));
+    insertSites(catalogue, recordedList());
+    QCOMPARE(catalogue.places().count(), 8);
+
+    // regardless of the case, and also in the middle of a word
+    QCOMPARE(catalogue.search(QStringLiteral("calgary")), QStringList() << QStringLiteral("Calgary, AB"));
+    QCOMPARE(catalogue.search(QStringLiteral("COUVER")), QStringList() << QStringLiteral("Vancouver, BC"));
+    QCOMPARE(catalogue.search(QStringLiteral("Toronto")),
+             QStringList() << QStringLiteral("Toronto, ON") << QStringLiteral("Toronto Island, ON"));
+    QCOMPARE(catalogue.search(QStringLiteral("ronto isl")), QStringList() << QStringLiteral("Toronto Island, ON"));
+
+    // names with non-ASCII letters
+    QCOMPARE(catalogue.search(QStringLiteral("orléans")), QStringList() << QStringLiteral("Ottawa (Kanata - Orléans), ON"));
+    QCOMPARE(catalogue.search(QStringLiteral("QUÉBEC")), QStringList() << QStringLiteral("Québec, QC"));
+
+    // no name contains the rarest trigram
+    QVERIFY(catalogue.search(QStringLiteral("toronto calgary")).isEmpty());
+    QVERIFY(catalogue.search(QStringLiteral("Halifax")).isEmpty());
+
+    // shorter than a trigram, every name is checked
+    QCOMPARE(catalogue.search(QStringLiteral("qc")),
+             QStringList() << QStringLiteral("Montréal, QC") << QStringLiteral("Québec, QC"));
+    QCOMPARE(catalogue.search(QString()).count(), 8);
+}
+
+void TestStationCatalogue::saveAndLoad()
+{
+    StationCatalogue catalogue(QStringLiteral("test"));
+    QVERIFY(!catalogue.load());
+    QVERIFY(catalogue.isStale());
+
+    insertSites(catalogue, recordedList());
+    catalogue.save();
+
+    StationCatalogue loaded(QStringLiteral("test"));
+    QVERIFY(loaded.load());
+    QCOMPARE(loaded.places(), catalogue.places());
+    QCOMPARE(loaded.fields(QStringLiteral("Toronto, ON")),
+             QStringList() << QStringLiteral("s0000458") << QStringLiteral("ON") << QStringLiteral("Toronto"));
+    QCOMPARE(loaded.search(QStringLiteral("ronto")), catalogue.search(QStringLiteral("ronto")));
+    // it was never fetched
+    QVERIFY(loaded.isStale());
+}
+
+void TestStationCatalogue::conditionalRequest()
+{
+    const QByteArray list = recordedList();
+    StationListServer server(list);
+
+    StationCatalogue catalogue(QStringLiteral("test"));
+    QByteArray data;
+    QVERIFY(!fetch(catalogue, server.url(), &data));
+    QVERIFY(!server.lastRequest().contains("If-None-Match"));
+    QCOMPARE(data, list);
+    QVERIFY(!catalogue.isStale());
+
+    insertSites(catalogue, data);
+    catalogue.save();
+
+    // the validators are kept with the list
+    StationCatalogue loaded(QStringLiteral("test"));
+    QVERIFY(loaded.load());
+    QVERIFY(fetch(loaded, server.url()));
+    QVERIFY(server.lastRequest().contains("If-None-Match: \"v1\""));
+    QVERIFY(server.lastRequest().contains("If-Modified-Since: Mon, 06 Oct 2014 12:00:00 GMT"));
+    QCOMPARE(loaded.places(), catalogue.places());
+}
+
+void TestStationCatalogue::changedList()
+{
+    StationListServer server(recordedList());
+    StationCatalogue catalogue(QStringLiteral("test"));
+    QVERIFY(!fetch(catalogue, server.url()));
+    insertSites(catalogue, recordedList());
+
+    server.setEtag("\"v2\"");
+    QByteArray data;
+    QVERIFY(!fetch(catalogue, server.url(), &data));
+    QVERIFY(server.lastRequest().contains("If-None-Match: \"v1\""));
+    QCOMPARE(data, recordedList());
+
+    // the next request asks for a newer list than the one just sent
+    QVERIFY(fetch(catalogue, server.url()));
+    QVERIFY(server.lastRequest().contains("If-None-Match: \"v2\""));
+}
+
+void TestStationCatalogue::failedRequest()
+{
+    QUrl url;
+    {
+        StationListServer server(recordedList());
+        url = server.url();
+    }
+
+    StationCatalogue catalogue(QStringLiteral("test"));
+    insertSites(catalogue, recordedList());
+    // nobody is listening anymore, the list is fetched again next time
+    QVERIFY(!fetch(catalogue, url));
+    QVERIFY(catalogue.isStale());
+    QCOMPARE(catalogue.places().count(), 8);
+}
+
+QTEST_MAIN(TestStationCatalogue)
+#include "teststationcatalogue.moc"
@@ -0,0 +1,244 @@
+/* This file is part of the KDE project
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+#include "history.h"
+#include "historyimageitem.h"
+#include "historystringitem.h"
+
+#include <QDir>
+#include <QStandardPaths>
+#include <QTest>
+
+class TestHistory : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void dedupe();
+    void thumbnail();
+    void benchmarkText_data();
+    void benchmarkText();
+    void benchmarkImage_data();
+    void benchmarkImage();
+    void benchmarkThumbnail_data();
+    void benchmarkThumbnail();
+
+private:
+    QString spillDir() const;
+    int spillFiles() const;
+};
+
+static QString largeText(int size, QChar fill)
+{
+    QString text(size, fill);
+    // a text somebody copied, rather than a run of one character
+    for (int i = 0; i < size; i += 80) {
+        text[i] = QLatin1Char('\n');
+    }
+    return text;
+}
+
+void TestHistory::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestHistory::cleanupTestCase()
+{
+    QDir(spillDir()).removeRecursively();
+}
+
+QString TestHistory::spillDir() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+}
+
+int TestHistory::spillFiles() const
+{
+    return QDir(spillDir()).entryList(QStringList() << QStringLiteral("klipper-spill-*"), QDir::Files).count();
+}
+
+void TestHistory::dedupe()
+{
+    History history(0);
+    history.setMaxSize(10);
+    const QString text = largeText(1024 * 1024, QLatin1Char('a'));
+    history.insert(new HistoryStringItem(text));
+    history.insert(new HistoryStringItem(QStringLiteral("other")));
+    QCOMPARE(history.first()->text(), QStringLiteral("other"));
+
+    // the same content again only moves the older copy to the top
+    history.insert(new HistoryStringItem(text));
+    QCOMPARE(history.first()->text(), text);
+    QCOMPARE(history.find(history.first()->next_uuid())->text(), QStringLiteral("other"));
+    QCOMPARE(history.first()->next_uuid(), history.first()->previous_uuid());
+
+    QImage image(64, 64, QImage::Format_ARGB32);
+    image.fill(Qt::red);
+    history.insert(new HistoryImageItem(image));
+    const QByteArray uuid = history.first()->uuid();
+    // equal pixels are the same image, even if it is another QImage
+    QImage copy(64, 64, QImage::Format_ARGB32);
+    copy.fill(Qt::red);
+    history.insert(new HistoryImageItem(copy));
+    QCOMPARE(history.first()->uuid(), uuid);
+    copy.setPixel(0, 0, qRgb(0, 0, 255));
+    history.insert(new HistoryImageItem(copy));
+    QVERIFY(history.first()->uuid() != uuid);
+}
+
+void TestHistory::thumbnail()
+{
+    const int filesBefore = spillFiles();
+    {
+        History history(0);
+        history.setMaxSize(10);
+
+        // 4 MiB, large enough to be spilled
+        QImage image(1024, 1024, QImage::Format_ARGB32);
+        image.fill(Qt::green);
+        history.insert(new HistoryImageItem(image));
+        QCOMPARE(spillFiles(), filesBefore + 1);
+        QVERIFY(history.first()->text().startsWith(QLatin1String("1024x1024x32")));
+
+        // the popup gets a thumbnail made from the spilled pixels
+        const QPixmap &thumbnail = history.first()->image();
+        QCOMPARE(thumbnail.size(), QSize(128, 128));
+        QCOMPARE(thumbnail.toImage().pixel(64, 64), image.pixel(512, 512));
+
+        QImage small(32, 16, QImage::Format_ARGB32);
+        small.fill(Qt::blue);
+        history.insert(new HistoryImageItem(small));
+        QCOMPARE(spillFiles(), filesBefore + 1);
+        QCOMPARE(history.first()->image().size(), QSize(32, 16));
+    }
+    // the spill files go with their items
+    QCOMPARE(spillFiles(), filesBefore);
+}
+
+void TestHistory::benchmarkText_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<bool>("duplicate");
+
+    QTest::newRow("1 KiB new") << 1024 << false;
+    QTest::newRow("1 KiB duplicate") << 1024 << true;
+    QTest::newRow("1 MiB new") << 1024 * 1024 << false;
+    QTest::newRow("1 MiB duplicate") << 1024 * 1024 << true;
+    QTest::newRow("16 MiB new") << 16 * 1024 * 1024 << false;
+    QTest::newRow("16 MiB duplicate") << 16 * 1024 * 1024 << true;
+}
+
+void TestHistory::benchmarkText()
+{
+    QFETCH(int, size);
+    QFETCH(bool, duplicate);
+
+    // a full history, so that every new item trims one
+    History history(0);
+    history.setMaxSize(20);
+    for (int i = 0; i < 20; ++i) {
+        history.insert(new HistoryStringItem(QString::number(i)));
+    }
+    QString text = largeText(size, QLatin1Char('a'));
+    history.insert(new HistoryStringItem(text));
+    history.insert(new HistoryStringItem(QStringLiteral("other")));
+
+    ushort counter = 0;
+    QBENCHMARK {
+        if (!duplicate) {
+            // detaches from the item holding it, like a new selection comes in its own copy
+            text[1] = QChar(++counter);
+        } else {
+            history.insert(new HistoryStringItem(QStringLiteral("other")));
+        }
+        history.insert(new HistoryStringItem(text));
+    }
+    QCOMPARE(history.first()->text(), text);
+}
+
+void TestHistory::benchmarkImage_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<bool>("duplicate");
+
+    // below the spill threshold
+    QTest::newRow("512x512 new") << QSize(512, 512) << false;
+    QTest::newRow("512x512 duplicate") << QSize(512, 512) << true;
+    // a screenshot of a large screen, spilled
+    QTest::newRow("2560x1440 new") << QSize(2560, 1440) << false;
+    QTest::newRow("2560x1440 duplicate") << QSize(2560, 1440) << true;
+}
+
+void TestHistory::benchmarkImage()
+{
+    QFETCH(QSize, size);
+    QFETCH(bool, duplicate);
+
+    History history(0);
+    history.setMaxSize(20);
+    QImage image(size, QImage::Format_ARGB32);
+    image.fill(Qt::white);
+    QImage other(16, 16, QImage::Format_ARGB32);
+    other.fill(Qt::black);
+    history.insert(new HistoryImageItem(image));
+    history.insert(new HistoryImageItem(other));
+
+    int counter = 0;
+    QBENCHMARK {
+        if (!duplicate) {
+            // detaches from the item holding it unless that one was spilled,
+            // like a new image from the clipboard is a new copy
+            image.setPixel(0, 0, ++counter);
+        } else {
+            history.insert(new HistoryImageItem(other));
+        }
+        history.insert(new HistoryImageItem(image));
+    }
+    QVERIFY(history.first()->text().startsWith(QStringLiteral("%1x%2x32").arg(size.width()).arg(size.height())));
+}
+
+void TestHistory::benchmarkThumbnail_data()
+{
+    QTest::addColumn<QSize>("size");
+
+    QTest::newRow("512x512") << QSize(512, 512);
+    QTest::newRow("2560x1440") << QSize(2560, 1440);
+}
+
+void TestHistory::benchmarkThumbnail()
+{
+    QFETCH(QSize, size);
+
+    History history(0);
+    history.setMaxSize(20);
+    QImage image(size, QImage::Format_ARGB32);
+    image.fill(Qt::white);
+
+    int counter = 0;
+    QBENCHMARK {
+        // the first time a new image is shown in the popup
+        image.setPixel(0, 0, ++counter);
+        history.insert(new HistoryImageItem(image));
+        history.first()->image();
+    }
+    QVERIFY(!history.first()->image().isNull());
+}
+
+QTEST_MAIN(TestHistory)
+#include "testhistory.moc"
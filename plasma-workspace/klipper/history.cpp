@@ -50,6 +50,8 @@ void History::insert( HistoryItem* item ) {
     m_topIsUserSelected = false;
     const HistoryItem* existingItem = this->find(item->uuid());
     if ( existingItem ) {
+        // the same content is already in the history, only keep one copy of it
+        delete item;
         if ( existingItem == m_top) {
             return;
         }
@@ -72,6 +74,7 @@ void History::forceInsert( HistoryItem* item ) {
     item->insertBetweeen(m_top ? m_items[m_top->previous_uuid()] : 0L, m_top);
     m_items.insert( item->uuid(), item );
     m_top = item;
+    item->spill();
     emit changed();
     trim();
 }
@@ -20,45 +20,97 @@
 
 #include <QMimeData>
 #include <QCryptographicHash>
+#include <QDataStream>
 
 #include <KDebug>
 
+#include "spillfile.h"
+
+// images bigger than this are kept in a spill file
+static const int SPILL_THRESHOLD = 4 * 1024 * 1024;
+static const int THUMBNAIL_SIZE = 128;
+
 namespace {
-    QByteArray compute_uuid(const QPixmap& data) {
-        QByteArray buffer;
-        QDataStream out(&buffer, QIODevice::WriteOnly);
-        out << data;
-        return QCryptographicHash::hash(buffer, QCryptographicHash::Sha1);
+    QByteArray compute_uuid(const QImage& data) {
+        // hash the pixels rather than an encoded copy of the image
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        QByteArray header;
+        QDataStream out(&header, QIODevice::WriteOnly);
+        out << data.size() << qint32(data.format()) << data.colorTable();
+        hash.addData(header);
+        hash.addData(reinterpret_cast<const char*>(data.constBits()), data.byteCount());
+        return hash.result();
     }
-
 }
 
-HistoryImageItem::HistoryImageItem( const QPixmap& data )
+HistoryImageItem::HistoryImageItem( const QImage& data )
     : HistoryItem(compute_uuid(data))
     , m_data( data )
+    , m_size( data.size() )
+    , m_bytesPerLine( data.bytesPerLine() )
+    , m_format( data.format() )
+    , m_depth( data.depth() )
+{
+}
+
+HistoryImageItem::~HistoryImageItem()
 {
 }
 
+void HistoryImageItem::spill()
+{
+    // images with a color table are small enough anyway
+    if ( m_spill || m_data.byteCount() < SPILL_THRESHOLD || m_data.colorCount() > 0 ) {
+        return;
+    }
+    QScopedPointer<SpillFile> spill( new SpillFile );
+    if ( spill->store( m_data.constBits(), m_data.byteCount() ) ) {
+        m_spill.swap( spill );
+        m_data = QImage();
+    }
+}
+
+QImage HistoryImageItem::data() const
+{
+    if ( m_spill ) {
+        // refers to the mapped file, the pixels are copied on write only
+        return QImage( m_spill->data(), m_size.width(), m_size.height(), m_bytesPerLine, m_format );
+    }
+    return m_data;
+}
+
 QString HistoryImageItem::text() const {
     if ( m_text.isNull() ) {
         m_text = QString( "%1x%2x%3 %4" )
-                 .arg( m_data.width() )
-                 .arg( m_data.height() )
-                 .arg( m_data.depth() );
+                 .arg( m_size.width() )
+                 .arg( m_size.height() )
+                 .arg( m_depth );
     }
     return m_text;
+}
 
+const QPixmap& HistoryImageItem::image() const
+{
+    if ( m_thumbnail.isNull() ) {
+        const QImage image = data();
+        if ( image.width() > THUMBNAIL_SIZE || image.height() > THUMBNAIL_SIZE ) {
+            m_thumbnail = QPixmap::fromImage( image.scaled( THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation ) );
+        } else {
+            m_thumbnail = QPixmap::fromImage( image );
+        }
+    }
+    return m_thumbnail;
 }
 
-/* virtual */
 void HistoryImageItem::write( QDataStream& stream ) const {
-    stream << QString( "image" ) << m_data;
+    // the same format as a QPixmap, which older versions wrote
+    stream << QString( "image" ) << data();
 }
 
 QMimeData* HistoryImageItem::mimeData() const
 {
     QMimeData *data = new QMimeData();
-    data->setImageData(m_data.toImage());
+    // the clipboard may keep the data longer than the spill file exists
+    data->setImageData( m_spill ? this->data().copy() : m_data );
     return data;
 }
-
@@ -20,39 +20,59 @@
 #ifndef HISTORYIMAGEITEM_H
 #define HISTORYIMAGEITEM_H
 
+#include <QImage>
+#include <QScopedPointer>
+
 #include "historyitem.h"
 
+class SpillFile;
+
 /**
- * A image entry in the clipboard history.
+ * An image in the clipboard history.
+ *
+ * Large images are moved to a spill file once they are in the history, and
+ * the popup only gets a thumbnail, which is made the first time it is shown.
  */
 class HistoryImageItem : public HistoryItem
 {
 public:
-    HistoryImageItem( const QPixmap& data );
-    virtual ~HistoryImageItem() {}
+    HistoryImageItem( const QImage& data );
+    virtual ~HistoryImageItem();
     virtual QString text() const;
     virtual bool operator==( const HistoryItem& rhs) const {
         if ( const HistoryImageItem* casted_rhs = dynamic_cast<const HistoryImageItem*>( &rhs ) ) {
-            return &casted_rhs->m_data == &m_data; // Not perfect, but better than nothing.
+            return casted_rhs->uuid() == uuid();
         }
         return false;
     }
-    virtual const QPixmap& image() const { return m_data; }
+    virtual const QPixmap& image() const;
     virtual QMimeData* mimeData() const;
-
     virtual void write( QDataStream& stream ) const;
+    virtual void spill();
 
 private:
     /**
-     *
+     * The full image, read from the spill file if it has been spilled
+     */
+    QImage data() const;
+
+    /**
+     * The image, null once it is in the spill file
+     */
+    QImage m_data;
+    QScopedPointer<SpillFile> m_spill;
+    QSize m_size;
+    int m_bytesPerLine;
+    QImage::Format m_format;
+    int m_depth;
+    /**
+     * Cache for the thumbnail shown in the popup
      */
-    const QPixmap m_data;
+    mutable QPixmap m_thumbnail;
     /**
      * Cache for m_data's string representation
      */
     mutable QString m_text;
 };
 
-
-
 #endif
@@ -36,6 +36,17 @@ HistoryItem::~HistoryItem() {
 
 }
 
+QString HistoryItem::previewText() const
+{
+    // only the ends of a long text can be shown anyway
+    static const int PREVIEW_LENGTH = 1000;
+    const QString text = this->text();
+    if ( text.length() <= 2 * PREVIEW_LENGTH ) {
+        return text.simplified();
+    }
+    return ( text.left( PREVIEW_LENGTH ) + QLatin1Char( ' ' ) + text.right( PREVIEW_LENGTH ) ).simplified();
+}
+
 HistoryItem* HistoryItem::create( const QMimeData* data )
 {
 #if 0
@@ -58,8 +69,7 @@ HistoryItem* HistoryItem::create( const QMimeData* data )
     }
     if (data->hasImage())
     {
-        QImage image = qvariant_cast<QImage>(data->imageData());
-        return new HistoryImageItem(QPixmap::fromImage(image));
+        return new HistoryImageItem(qvariant_cast<QImage>(data->imageData()));
     }
 
     return 0; // Failed.
@@ -86,7 +96,8 @@ HistoryItem* HistoryItem::create( QDataStream& dataStream ) {
         return new HistoryStringItem( text );
     }
     if ( type == "image" ) {
-        QPixmap image;
+        // older versions wrote a QPixmap, which is streamed as a QImage
+        QImage image;
         dataStream >> image;
         return new HistoryImageItem( image );
     }
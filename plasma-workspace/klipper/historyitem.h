@@ -41,6 +41,12 @@ public:
      */
     virtual QString text() const = 0;
 
+    /**
+     * The text simplified for a single line, shortened in
+     * the middle if it is much longer than what can be shown.
+     */
+    QString previewText() const;
+
     /**
      * @return uuid of current item.
      */
@@ -70,6 +76,12 @@ public:
      */
     virtual bool operator==(const HistoryItem& rhs) const = 0;
 
+    /**
+     * Called once the item is in the history, to move
+     * large payloads out of memory. Does nothing by default.
+     */
+    virtual void spill() {}
+
     /**
      * Create an HistoryItem from MimeSources (i.e., clipboard data)
      * returns null if create fails (e.g, unsupported mimetype)
@@ -21,7 +21,7 @@
 #include <QCryptographicHash>
 
 HistoryStringItem::HistoryStringItem( const QString& data )
-    : HistoryItem(QCryptographicHash::hash(data.toUtf8(), QCryptographicHash::Sha1))
+    : HistoryItem(QCryptographicHash::hash(QByteArray::fromRawData(reinterpret_cast<const char*>(data.constData()), data.size() * sizeof(QChar)), QCryptographicHash::Sha1))
     , m_data( data )
 {
 
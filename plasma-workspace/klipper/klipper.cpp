@@ -267,7 +267,7 @@ void Klipper::setClipboardContents(QString s)
     updateTimestamp();
     HistoryStringItem* item = new HistoryStringItem( s );
     setClipboard( *item, Clipboard | Selection);
-    history()->insert( item );
+    history()->insert( item ); // may delete item
 }
 
 // DBUS - don't call from Klipper itself
@@ -575,8 +575,12 @@ HistoryItem* Klipper::applyClipChanges( const QMimeData* clipData )
     }
     Ignore lock( m_locklevel );
     HistoryItem* item = HistoryItem::create( clipData );
+    if ( !item ) {
+        return 0L;
+    }
+    // a duplicate is dropped in favour of the item already in the history
     history()->insert( item );
-    return item;
+    return history()->first();
 
 }
 
@@ -1003,21 +1007,21 @@ QString Klipper::cycleText() const
         result += "<tr><td>";
         result += i18n("up");
         result += "</td><td>";
-        result += font_metrics.elidedText(Qt::escape(itemprev->text().simplified()), Qt::ElideMiddle, WIDTH_IN_PIXEL);
+        result += font_metrics.elidedText(Qt::escape(itemprev->previewText()), Qt::ElideMiddle, WIDTH_IN_PIXEL);
         result += "</td></tr>";
     }
 
     result += "<tr><td>";
     result += i18n("current");
     result += "</td><td><b>";
-    result += font_metrics.elidedText(Qt::escape(item->text().simplified()), Qt::ElideMiddle, WIDTH_IN_PIXEL);
+    result += font_metrics.elidedText(Qt::escape(item->previewText()), Qt::ElideMiddle, WIDTH_IN_PIXEL);
     result += "</b></td></tr>";
 
     if (itemnext) {
         result += "<tr><td>";
         result += i18n("down");
         result += "</td><td>";
-        result += font_metrics.elidedText(Qt::escape(itemnext->text().simplified()), Qt::ElideMiddle, WIDTH_IN_PIXEL);
+        result += font_metrics.elidedText(Qt::escape(itemnext->previewText()), Qt::ElideMiddle, WIDTH_IN_PIXEL);
         result += "</td></tr>";
     }
 
@@ -95,7 +95,7 @@ void PopupProxy::tryInsertItem( HistoryItem const * const item,
     QPixmap image( item->image() );
     if ( image.isNull() ) {
         // Squeeze text strings so that do not take up the entire screen (or more)
-        QString text = m_proxy_for_menu->fontMetrics().elidedText( item->text().simplified(), Qt::ElideMiddle, m_menu_width );
+        QString text = m_proxy_for_menu->fontMetrics().elidedText( item->previewText(), Qt::ElideMiddle, m_menu_width );
         text.replace( '&', "&&" );
         action->setText(text);
     } else {
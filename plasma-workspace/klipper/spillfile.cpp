@@ -0,0 +1,52 @@
+/* This file is part of the KDE project
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+#include "spillfile.h"
+
+#include <QDir>
+#include <QStandardPaths>
+
+#include <KDebug>
+
+SpillFile::SpillFile()
+    : m_data( 0 )
+{
+    const QString dir = QStandardPaths::writableLocation( QStandardPaths::CacheLocation );
+    QDir().mkpath( dir );
+    m_file.setFileTemplate( dir + QLatin1String( "/klipper-spill-XXXXXX" ) );
+}
+
+SpillFile::~SpillFile()
+{
+    if ( m_data ) {
+        m_file.unmap( m_data );
+    }
+}
+
+bool SpillFile::store( const uchar* data, qint64 size )
+{
+    if ( !m_file.open() ) {
+        kWarning() << "Could not create a spill file:" << m_file.errorString();
+        return false;
+    }
+    if ( m_file.write( reinterpret_cast<const char*>( data ), size ) != size || !m_file.flush() ) {
+        kWarning() << "Could not write the spill file:" << m_file.errorString();
+        return false;
+    }
+    m_data = m_file.map( 0, size );
+    return m_data != 0;
+}
@@ -0,0 +1,52 @@
+/* This file is part of the KDE project
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+#ifndef SPILLFILE_H
+#define SPILLFILE_H
+
+#include <QTemporaryFile>
+
+/**
+ * Keeps a large clipboard payload in a temporary file instead of the heap.
+ *
+ * The file is mapped read-only, so the kernel can drop its pages under
+ * memory pressure and read them back when the payload is used again.
+ * It is removed with the object.
+ */
+class SpillFile
+{
+public:
+    SpillFile();
+    ~SpillFile();
+
+    /**
+     * Writes @p data to the file and maps it
+     * @return false if the payload has to stay in memory
+     */
+    bool store( const uchar* data, qint64 size );
+
+    /**
+     * The mapped payload, valid as long as this object
+     */
+    const uchar* data() const { return m_data; }
+
+private:
+    QTemporaryFile m_file;
+    uchar* m_data;
+};
+
+#endif
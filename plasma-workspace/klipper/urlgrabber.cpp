@@ -51,6 +51,10 @@
 #include <fixx11h.h>
 #endif
 
+// longer texts are not matched when they are copied, only when the actions
+// are asked for explicitly
+static const int MAX_MATCH_LENGTH = 4096;
+
 URLGrabber::URLGrabber(History* history):
     m_myCurrentAction(0L),
     m_myMenu(0L),
@@ -205,6 +209,13 @@ void URLGrabber::actionMenu( const HistoryItem* item, bool automatically_invoked
       return;
     }
     QString text(item->text());
+    // Matching only the start of a huge text would let $-anchored expressions
+    // match text they don't match in full, and would fill %0-%9 of the commands
+    // from the cut off text. So such texts are skipped by the clipboard
+    // monitoring instead, and matched in full when the user asks for actions.
+    if (automatically_invoked && text.length() > MAX_MATCH_LENGTH) {
+        return;
+    }
     if (m_stripWhiteSpace) {
         text = text.trimmed();
     }
@@ -252,14 +252,10 @@ void KSMServer::restoreLegacySession( KConfig* config )
         KConfigGroup group( config, QStringLiteral( "Legacy" ) + sessionGroup );
         restoreLegacySessionInternal( &group );
     } else if( wm == QStringLiteral( "kwin" ) ) { // backwards comp. - get it from kwinrc
-        KConfigGroup group( config, sessionGroup );
-        int count =  group.readEntry( "count", 0 );
-        for ( int i = 1; i <= count; i++ ) {
-            QString n = QString::number(i);
-            if ( group.readEntry( QStringLiteral("program")+n, QString() ) != wm )
+        foreach ( const SessionClient& stored, sessionStore.clients( sessionGroup )) {
+            if ( stored.program != wm )
                 continue;
-            QStringList restartCommand =
-                group.readEntry( QStringLiteral("restartCommand")+n, QStringList() );
+            const QStringList& restartCommand = stored.restartCommand;
             for( QStringList::ConstIterator it = restartCommand.constBegin();
                 it != restartCommand.constEnd();
                 ++it ) {
@@ -636,6 +636,7 @@ KSMServer::KSMServer( const QString& windowManager, bool _only_local, bool locks
     dialogActive = false;
     saveSession = false;
     wmPhase1WaitingCount = 0;
+    maxConcurrentRestores = 1;
     KConfigGroup config(KSharedConfig::openConfig(), "General");
     clientInteracting = 0;
     xonCommand = config.readEntry( "xonCommand", "xon" );
@@ -747,6 +748,7 @@ void KSMServer::cleanUp()
 {
     if (clean) return;
     clean = true;
+    sessionStore.waitForWrites();
     IceFreeListenObjs (numTransports, listenObjs);
 
     QByteArray fName = QFile::encodeName(QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation) + QLatin1Char('/') + QStringLiteral("KSMserver"));
@@ -874,8 +876,7 @@ QString KSMServer::currentSession()
 
 void KSMServer::discardSession()
 {
-    KConfigGroup config(KSharedConfig::openConfig(), sessionGroup );
-    int count =  config.readEntry( "count", 0 );
+    const QList<SessionClient> storedClients = sessionStore.clients( sessionGroup );
 	foreach ( KSMClient *c, clients ) {
         QStringList discardCommand = c->discardCommand();
         if ( discardCommand.isEmpty())
@@ -883,12 +884,12 @@ void KSMServer::discardSession()
         // check that non of the old clients used the exactly same
         // discardCommand before we execute it. This used to be the
         // case up to KDE and Qt < 3.1
-        int i = 1;
-        while ( i <= count &&
-                config.readPathEntry( QStringLiteral("discardCommand") + QString::number(i), QStringList() ) != discardCommand )
-            i++;
-        if ( i <= count )
-            executeCommand( discardCommand );
+        foreach ( const SessionClient& stored, storedClients ) {
+            if ( stored.discardCommand == discardCommand ) {
+                executeCommand( discardCommand );
+                break;
+            }
+        }
     }
 }
 
@@ -899,10 +900,8 @@ void KSMServer::storeSession()
     KConfigGroup generalGroup(config, "General");
     excludeApps = generalGroup.readEntry( "excludeApps" ).toLower()
                   .split( QRegExp( QStringLiteral("[,:]") ), QString::SkipEmptyParts );
-    KConfigGroup configSessionGroup(config, sessionGroup);
-    int count =  configSessionGroup.readEntry( "count", 0 );
-    for ( int i = 1; i <= count; i++ ) {
-        QStringList discardCommand = configSessionGroup.readPathEntry( QLatin1String("discardCommand") + QString::number(i), QStringList() );
+    foreach ( const SessionClient& stored, sessionStore.clients( sessionGroup )) {
+        const QStringList& discardCommand = stored.discardCommand;
         if ( discardCommand.isEmpty())
             continue;
         // check that non of the new clients uses the exactly same
@@ -916,9 +915,9 @@ void KSMServer::storeSession()
             continue;
         executeCommand( discardCommand );
     }
+    // the clients are kept in the session store, drop what older versions wrote here
     config->deleteGroup( sessionGroup ); //### does not work with global config object...
-	KConfigGroup cg( config, sessionGroup);
-    count =  0;
+    QList<SessionClient> storedClients;
 
     if (state != ClosingSubSession) {
         // put the wm first
@@ -951,17 +950,17 @@ void KSMServer::storeSession()
             continue;
         }
 
-        count++;
-        QString n = QString::number(count);
-        cg.writeEntry( QStringLiteral("program")+n, program );
-        cg.writeEntry( QStringLiteral("clientId")+n, c->clientId() );
-        cg.writeEntry( QStringLiteral("restartCommand")+n, restartCommand );
-        cg.writePathEntry( QStringLiteral("discardCommand")+n, c->discardCommand() );
-        cg.writeEntry( QStringLiteral("restartStyleHint")+n, restartHint );
-        cg.writeEntry( QStringLiteral("userId")+n, c->userId() );
-        cg.writeEntry( QStringLiteral("wasWm")+n, isWM( c ));
+        SessionClient stored;
+        stored.program = program;
+        stored.clientId = QString::fromLocal8Bit( c->clientId() );
+        stored.restartCommand = restartCommand;
+        stored.discardCommand = c->discardCommand();
+        stored.restartStyleHint = restartHint;
+        stored.userId = c->userId();
+        stored.wasWm = isWM( c );
+        storedClients << stored;
     }
-    cg.writeEntry( "count", count );
+    sessionStore.store( sessionGroup, storedClients );
 
     KConfigGroup cg2( config, "General");
     cg2.writeEntry( "screenCount", ScreenCount(QX11Info::display()));
@@ -974,9 +973,10 @@ QStringList KSMServer::sessionList()
 {
     QStringList sessions( QStringLiteral( "default" ) );
     KSharedConfig::Ptr config = KSharedConfig::openConfig();
-    const QStringList groups = config->groupList();
+    // sessions saved by older versions may not have been moved to the store yet
+    const QStringList groups = config->groupList() + sessionStore.sessionGroups();
     for ( QStringList::ConstIterator it = groups.constBegin(); it != groups.constEnd(); ++it )
-        if ( (*it).startsWith( QLatin1String( "Session: " ) ) )
+        if ( (*it).startsWith( QLatin1String( "Session: " ) ) && !sessions.contains( (*it).mid( 9 ) ) )
             sessions << (*it).mid( 9 );
     return sessions;
 }
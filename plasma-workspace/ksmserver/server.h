@@ -49,8 +49,12 @@ extern "C" {
 #include <kmessagebox.h>
 #include <QTimer>
 #include <QTime>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMap>
 
+#include "sessionstore.h"
+
 
 #define SESSION_PREVIOUS_LOGOUT "saved at previous logout"
 #define SESSION_BY_USER  "saved by user"
@@ -189,6 +193,10 @@ private:
     WId windowWmClientLeader(WId w);
     QByteArray windowSessionId(WId w, WId leader);
 
+    void loadRestoreQueue();
+    int nextRestoreCandidate() const;
+    bool isRestorePending( const QString& program ) const;
+
     bool checkStartupSuspend();
     void finishStartup();
     void resumeStartupInternal();
@@ -242,6 +250,7 @@ private:
     KProcess* wmProcess;
     QString sessionGroup;
     QString sessionName;
+    SessionStore sessionStore;
     QTimer protectionTimer;
     QTimer restoreTimer;
     QString xonCommand;
@@ -257,10 +266,25 @@ private:
     // ksplash interface
     void upAndRunning( const QString& msg );
 
-    // sequential startup
-    int appsToStart;
-    int lastAppStarted;
-    QString lastIdStarted;
+    // concurrent startup
+    struct PendingRestore
+        {
+        QString clientId;
+        QString program;
+        QStringList restartCommand;
+        QString clientMachine;
+        QString userId;
+        QStringList restoreAfter; // programs that have to be up before this one
+        };
+    struct RunningRestore
+        {
+        QString program;
+        QElapsedTimer timer;
+        };
+    QList<PendingRestore> pendingRestores;
+    QHash<QString, RunningRestore> runningRestores; // by clientId
+    int maxConcurrentRestores;
+    QElapsedTimer restoreClock;
 
     QStringList excludeApps;
 
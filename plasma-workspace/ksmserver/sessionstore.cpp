@@ -0,0 +1,344 @@
+/*****************************************************************
+ksmserver - the KDE session management server
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+******************************************************************/
+
+#include "sessionstore.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+
+#include <kconfiggroup.h>
+#include <ksharedconfig.h>
+#include <kdebug.h>
+
+static const quint32 SNAPSHOT_MAGIC = 0x4b534d53; // "KSMS"
+static const quint32 JOURNAL_MAGIC = 0x4b534d4a; // "KSMJ"
+static const quint32 STORE_VERSION = 1;
+// after this many saves the journal is folded into a new snapshot
+static const int MAX_JOURNAL_RECORDS = 16;
+
+bool SessionClient::operator==( const SessionClient& other ) const
+{
+    return program == other.program
+        && clientId == other.clientId
+        && restartCommand == other.restartCommand
+        && discardCommand == other.discardCommand
+        && restartStyleHint == other.restartStyleHint
+        && userId == other.userId
+        && clientMachine == other.clientMachine
+        && wasWm == other.wasWm;
+}
+
+QDataStream& operator<<( QDataStream& stream, const SessionClient& client )
+{
+    stream << client.program << client.clientId << client.restartCommand << client.discardCommand
+           << qint32( client.restartStyleHint ) << client.userId << client.clientMachine << client.wasWm;
+    return stream;
+}
+
+QDataStream& operator>>( QDataStream& stream, SessionClient& client )
+{
+    qint32 restartStyleHint;
+    stream >> client.program >> client.clientId >> client.restartCommand >> client.discardCommand
+           >> restartStyleHint >> client.userId >> client.clientMachine >> client.wasWm;
+    client.restartStyleHint = restartStyleHint;
+    return stream;
+}
+
+/*!
+  Identifies the clients across saves, by their client id if they have one
+ */
+static QStringList clientKeys( const QList<SessionClient>& clients )
+{
+    QStringList keys;
+    QHash<QString, int> occurrences;
+    foreach ( const SessionClient& client, clients ) {
+        const QString key = client.clientId.isEmpty() ? QLatin1Char( '/' ) + client.program : client.clientId;
+        keys.append( key + QLatin1Char( '#' ) + QString::number( occurrences[ key ]++ ));
+    }
+    return keys;
+}
+
+class SessionWriter : public QRunnable
+{
+public:
+    // a snapshot replaces both files, otherwise the data is appended to the journal
+    SessionWriter( SessionStore* store, const QString& sessionGroup,
+                   const QString& snapshotFile, const QString& journalFile,
+                   const QByteArray& snapshot, const QByteArray& journal )
+        : store( store ), sessionGroup( sessionGroup ),
+          snapshotFile( snapshotFile ), journalFile( journalFile ),
+          snapshot( snapshot ), journal( journal ) {}
+
+    void run()
+    {
+        if ( !snapshot.isEmpty()) {
+            QDir().mkpath( QFileInfo( snapshotFile ).path());
+            // the new journal only matches the new snapshot, so a crash in between is harmless
+            if ( !writeAtomically( snapshotFile, snapshot ) || !writeAtomically( journalFile, journal )) {
+                kWarning( 1218 ) << "Could not write the session to" << snapshotFile;
+                store->writeFailed( sessionGroup );
+            }
+            return;
+        }
+        QFile file( journalFile );
+        if ( !file.open( QIODevice::WriteOnly | QIODevice::Append ) || file.write( journal ) != journal.size()
+             || !file.flush()) {
+            kWarning( 1218 ) << "Could not append the session to" << journalFile;
+            store->writeFailed( sessionGroup );
+        }
+    }
+
+private:
+    static bool writeAtomically( const QString& fileName, const QByteArray& data )
+    {
+        QSaveFile file( fileName );
+        if ( !file.open( QIODevice::WriteOnly ))
+            return false;
+        file.write( data );
+        return file.commit();
+    }
+
+    SessionStore* store;
+    QString sessionGroup;
+    QString snapshotFile;
+    QString journalFile;
+    QByteArray snapshot;
+    QByteArray journal;
+};
+
+SessionStore::SessionStore()
+{
+    directory = QStandardPaths::writableLocation( QStandardPaths::GenericDataLocation )
+                + QStringLiteral( "/ksmserver/sessions" );
+    // the files are written in order
+    writer.setMaxThreadCount( 1 );
+}
+
+SessionStore::~SessionStore()
+{
+    waitForWrites();
+}
+
+void SessionStore::waitForWrites()
+{
+    writer.waitForDone();
+}
+
+void SessionStore::writeFailed( const QString& sessionGroup )
+{
+    QMutexLocker locker( &failedLock );
+    failedGroups.insert( sessionGroup );
+}
+
+QString SessionStore::fileName( const QString& sessionGroup, const QString& suffix ) const
+{
+    return directory + QLatin1Char( '/' ) + QString::fromLatin1( QUrl::toPercentEncoding( sessionGroup ))
+           + QLatin1Char( '.' ) + suffix;
+}
+
+QStringList SessionStore::sessionGroups() const
+{
+    QStringList groups;
+    const QStringList files = QDir( directory ).entryList( QStringList( QStringLiteral( "*.snapshot" )), QDir::Files );
+    foreach ( const QString& file, files )
+        groups << QUrl::fromPercentEncoding( file.left( file.length() - 9 ).toLatin1());
+    // the ones still being written
+    for ( QHash<QString, Session>::const_iterator it = sessions.constBegin(); it != sessions.constEnd(); ++it ) {
+        if ( it->onDisk && !groups.contains( it.key()))
+            groups << it.key();
+    }
+    return groups;
+}
+
+QList<SessionClient> SessionStore::clients( const QString& sessionGroup )
+{
+    return session( sessionGroup ).clients;
+}
+
+SessionStore::Session& SessionStore::session( const QString& sessionGroup )
+{
+    QHash<QString, Session>::iterator it = sessions.find( sessionGroup );
+    if ( it != sessions.end())
+        return it.value();
+
+    Session session;
+    if ( !load( sessionGroup, session ))
+        importConfig( sessionGroup, session );
+    return sessions.insert( sessionGroup, session ).value();
+}
+
+bool SessionStore::load( const QString& sessionGroup, Session& session )
+{
+    QFile snapshotFile( fileName( sessionGroup, QStringLiteral( "snapshot" )));
+    if ( !snapshotFile.open( QIODevice::ReadOnly ))
+        return false;
+
+    QDataStream snapshot( &snapshotFile );
+    quint32 magic, version;
+    snapshot >> magic >> version;
+    if ( magic != SNAPSHOT_MAGIC || version != STORE_VERSION )
+        return false;
+    snapshot.setVersion( QDataStream::Qt_5_0 );
+    snapshot >> session.generation >> session.clients;
+    if ( snapshot.status() != QDataStream::Ok ) {
+        kWarning( 1218 ) << "Discarding the corrupt session" << snapshotFile.fileName();
+        session = Session();
+        return false;
+    }
+    session.onDisk = true;
+    // records appended to a journal that can't be replayed completely would be lost,
+    // so unless it can, the next save writes a new snapshot
+    session.journalRecords = MAX_JOURNAL_RECORDS;
+
+    QFile journalFile( fileName( sessionGroup, QStringLiteral( "journal" )));
+    if ( !journalFile.open( QIODevice::ReadOnly ))
+        return true;
+    const QByteArray data = journalFile.readAll();
+    QDataStream journal( data );
+    quint32 generation;
+    journal >> magic >> version >> generation;
+    if ( magic != JOURNAL_MAGIC || version != STORE_VERSION || generation != session.generation )
+        return true; // belongs to an older snapshot
+
+    int records = 0;
+    while ( !journal.atEnd()) {
+        quint32 length;
+        quint16 checksum;
+        journal >> length >> checksum;
+        if ( journal.status() != QDataStream::Ok || length > quint32( data.size() - journal.device()->pos()))
+            return true;
+        QByteArray payload( length, Qt::Uninitialized );
+        journal.readRawData( payload.data(), length );
+        if ( qChecksum( payload.constData(), length ) != checksum )
+            return true; // the write of the last record was interrupted
+
+        QDataStream record( payload );
+        record.setVersion( QDataStream::Qt_5_0 );
+        QStringList order;
+        QStringList changedKeys;
+        QList<SessionClient> changed;
+        record >> order >> changedKeys >> changed;
+        if ( record.status() != QDataStream::Ok || changedKeys.count() != changed.count())
+            return true;
+
+        const QStringList keys = clientKeys( session.clients );
+        QList<SessionClient> clients;
+        foreach ( const QString& key, order ) {
+            int i = changedKeys.indexOf( key );
+            if ( i >= 0 ) {
+                clients << changed.at( i );
+            } else if (( i = keys.indexOf( key )) >= 0 ) {
+                clients << session.clients.at( i );
+            }
+        }
+        session.clients = clients;
+        ++records;
+    }
+    session.journalRecords = records;
+    return true;
+}
+
+void SessionStore::importConfig( const QString& sessionGroup, Session& session )
+{
+    KConfigGroup config( KSharedConfig::openConfig(), sessionGroup );
+    int count = config.readEntry( "count", 0 );
+    for ( int i = 1; i <= count; i++ ) {
+        QString n = QString::number(i);
+        SessionClient client;
+        client.program = config.readEntry( QStringLiteral("program")+n, QString() );
+        client.clientId = config.readEntry( QStringLiteral("clientId")+n, QString() );
+        client.restartCommand = config.readEntry( QStringLiteral("restartCommand")+n, QStringList() );
+        client.discardCommand = config.readPathEntry( QStringLiteral("discardCommand")+n, QStringList() );
+        client.restartStyleHint = config.readEntry( QStringLiteral("restartStyleHint")+n, 0 );
+        client.userId = config.readEntry( QStringLiteral("userId")+n, QString() );
+        client.clientMachine = config.readEntry( QStringLiteral("clientMachine")+n, QString() );
+        client.wasWm = config.readEntry( QStringLiteral("wasWm")+n, false );
+        session.clients << client;
+    }
+}
+
+void SessionStore::store( const QString& sessionGroup, const QList<SessionClient>& clients )
+{
+    Session& session = this->session( sessionGroup );
+    const QString snapshotFile = fileName( sessionGroup, QStringLiteral( "snapshot" ));
+    const QString journalFile = fileName( sessionGroup, QStringLiteral( "journal" ));
+    const QStringList keys = clientKeys( clients );
+
+    {
+        // what is on disk of a session whose last write failed can't be relied on
+        QMutexLocker locker( &failedLock );
+        if ( failedGroups.remove( sessionGroup ))
+            session.journalRecords = MAX_JOURNAL_RECORDS;
+    }
+
+    if ( session.onDisk && session.journalRecords < MAX_JOURNAL_RECORDS ) {
+        const QStringList previousKeys = clientKeys( session.clients );
+        QStringList changedKeys;
+        QList<SessionClient> changed;
+        for ( int i = 0; i < clients.count(); ++i ) {
+            const int previous = previousKeys.indexOf( keys.at( i ));
+            if ( previous < 0 || session.clients.at( previous ) != clients.at( i )) {
+                changedKeys << keys.at( i );
+                changed << clients.at( i );
+            }
+        }
+        session.clients = clients;
+        if ( changed.isEmpty() && keys == previousKeys )
+            return; // nothing to write
+
+        QByteArray payload;
+        QDataStream record( &payload, QIODevice::WriteOnly );
+        record.setVersion( QDataStream::Qt_5_0 );
+        record << keys << changedKeys << changed;
+        QByteArray journal;
+        QDataStream stream( &journal, QIODevice::WriteOnly );
+        stream << quint32( payload.size()) << qChecksum( payload.constData(), payload.size());
+        stream.writeRawData( payload.constData(), payload.size());
+
+        ++session.journalRecords;
+        writer.start( new SessionWriter( this, sessionGroup, snapshotFile, journalFile, QByteArray(), journal ));
+        return;
+    }
+
+    session.clients = clients;
+    ++session.generation;
+    session.journalRecords = 0;
+    session.onDisk = true;
+
+    QByteArray snapshot;
+    QDataStream snapshotStream( &snapshot, QIODevice::WriteOnly );
+    snapshotStream << SNAPSHOT_MAGIC << STORE_VERSION;
+    snapshotStream.setVersion( QDataStream::Qt_5_0 );
+    snapshotStream << session.generation << session.clients;
+    QByteArray journal;
+    QDataStream journalStream( &journal, QIODevice::WriteOnly );
+    journalStream << JOURNAL_MAGIC << STORE_VERSION << session.generation;
+
+    writer.start( new SessionWriter( this, sessionGroup, snapshotFile, journalFile, snapshot, journal ));
+}
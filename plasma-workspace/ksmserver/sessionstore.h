@@ -0,0 +1,104 @@
+/*****************************************************************
+ksmserver - the KDE session management server
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+******************************************************************/
+
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+
+class QDataStream;
+
+struct SessionClient
+    {
+    SessionClient() : restartStyleHint( 0 ), wasWm( false ) {}
+    bool operator==( const SessionClient& other ) const;
+    bool operator!=( const SessionClient& other ) const { return !( *this == other ); }
+
+    QString program;
+    QString clientId;
+    QStringList restartCommand;
+    QStringList discardCommand;
+    int restartStyleHint;
+    QString userId;
+    QString clientMachine;
+    bool wasWm;
+    };
+
+QDataStream& operator<<( QDataStream& stream, const SessionClient& client );
+QDataStream& operator>>( QDataStream& stream, SessionClient& client );
+
+/*!
+  The clients of the saved sessions, kept in a binary store instead of
+  one ksmserverrc group per session.
+
+  Each session is a snapshot of its clients followed by a journal with one
+  record per save, holding the order of the clients and only those that
+  changed. The files are written by a worker thread, the snapshots atomically;
+  a torn journal record is detected and ignored. After that, or after a failed
+  write, the next save writes a new snapshot instead of appending to a journal
+  that can't be replayed. Sessions that were saved by older versions are read
+  from ksmserverrc once.
+ */
+class SessionStore
+{
+public:
+    SessionStore();
+    ~SessionStore();
+
+    QList<SessionClient> clients( const QString& sessionGroup );
+    void store( const QString& sessionGroup, const QList<SessionClient>& clients );
+    QStringList sessionGroups() const;
+    /*! Blocks until everything stored so far is on disk */
+    void waitForWrites();
+
+private:
+    friend class SessionWriter;
+    /*! Called by the writer thread */
+    void writeFailed( const QString& sessionGroup );
+
+    struct Session
+        {
+        Session() : generation( 0 ), journalRecords( 0 ), onDisk( false ) {}
+        QList<SessionClient> clients;
+        quint32 generation;
+        int journalRecords;
+        bool onDisk;
+        };
+
+    Session& session( const QString& sessionGroup );
+    bool load( const QString& sessionGroup, Session& session );
+    void importConfig( const QString& sessionGroup, Session& session );
+    QString fileName( const QString& sessionGroup, const QString& suffix ) const;
+
+    QString directory;
+    QHash<QString, Session> sessions;
+    QMutex failedLock;
+    QSet<QString> failedGroups;
+    QThreadPool writer;
+};
+
+#endif
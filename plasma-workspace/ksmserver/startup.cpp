@@ -31,6 +31,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <kglobalsettings.h>
 #include <QDir>
+#include <QFileInfo>
 #include <krun.h>
 #include <config-workspace.h>
 #include <config-unix.h> // HAVE_LIMITS_H
@@ -101,13 +102,8 @@ void KSMServer::restoreSession( const QString &sessionName )
     state = LaunchingWM;
 
     kDebug( 1218 ) << "KSMServer::restoreSession " << sessionName;
-    KSharedConfig::Ptr config = KSharedConfig::openConfig();
-
     sessionGroup = QStringLiteral("Session: ") + sessionName;
-    KConfigGroup configSessionGroup( config, sessionGroup);
 
-    int count =  configSessionGroup.readEntry( "count", 0 );
-    appsToStart = count;
     upAndRunning( QStringLiteral( "ksmserver" ) );
     connect( klauncherSignals, SIGNAL(autoStart0Done()), SLOT(autoStart0Done()));
     connect( klauncherSignals, SIGNAL(autoStart1Done()), SLOT(autoStart1Done()));
@@ -116,10 +112,9 @@ void KSMServer::restoreSession( const QString &sessionName )
     // find all commands to launch the wm in the session
     QList<QStringList> wmStartCommands;
     if ( !wm.isEmpty() ) {
-        for ( int i = 1; i <= count; i++ ) {
-            QString n = QString::number(i);
-            if ( wm == configSessionGroup.readEntry( QStringLiteral("program")+n, QString() ) ) {
-                wmStartCommands << configSessionGroup.readEntry( QStringLiteral("restartCommand")+n, QStringList() );
+        foreach ( const SessionClient& stored, sessionStore.clients( sessionGroup )) {
+            if ( wm == stored.program ) {
+                wmStartCommands << stored.restartCommand;
             }
         }
     } 
@@ -300,8 +295,6 @@ void KSMServer::autoStart1Done()
         return;
     kDebug( 1218 ) << "Autostart 1 done";
     setupShortcuts(); // done only here, because it needs kglobalaccel :-/
-    lastAppStarted = 0;
-    lastIdStarted.clear();
     state = Restoring;
 #ifdef KSMSERVER_STARTUP_DEBUG1
     kDebug() << t.elapsed();
@@ -310,13 +303,107 @@ void KSMServer::autoStart1Done()
         autoStart2();
         return;
     }
+    loadRestoreQueue();
     tryRestoreNext();
 }
 
+// how long to wait for a restored client to register before giving up on it
+static const int RESTORE_TIMEOUT = 2000;
+
+/*!
+  Reads the clients of the current session group into the restore queue.
+  The wm is not part of it, it has been started already by launchWM().
+ */
+void KSMServer::loadRestoreQueue()
+{
+    pendingRestores.clear();
+    runningRestores.clear();
+    KConfigGroup generalGroup( KSharedConfig::openConfig(), "General" );
+    maxConcurrentRestores = qMax( 1, generalGroup.readEntry( "maxConcurrentRestores", 4 ));
+    // program name -> programs that have to be up before it, kept apart from the
+    // saved clients so that it survives saving the session
+    const QMap<QString, QString> restoreAfter = KConfigGroup( KSharedConfig::openConfig(), "RestoreAfter" ).entryMap();
+
+    foreach ( const SessionClient& stored, sessionStore.clients( sessionGroup )) {
+        if ( stored.restartCommand.isEmpty() ||
+             stored.restartStyleHint == SmRestartNever ) {
+            continue;
+        }
+        if ( wm == stored.program )
+            continue; // wm already started
+        if( stored.wasWm )
+            continue; // it was wm before, but not now, don't run it (some have --replace in command :(  )
+        PendingRestore restore;
+        restore.clientId = stored.clientId;
+        restore.program = stored.program;
+        restore.restartCommand = stored.restartCommand;
+        restore.clientMachine = stored.clientMachine;
+        restore.userId = stored.userId;
+        // "kded5, plasmashell" names kded5 and plasmashell
+        foreach ( const QString& name, restoreAfter.value( QFileInfo( stored.program ).fileName() )
+                                       .split( QLatin1Char( ',' ), QString::SkipEmptyParts )) {
+            const QString trimmed = name.trimmed();
+            if( !trimmed.isEmpty())
+                restore.restoreAfter.append( trimmed );
+        }
+        pendingRestores.append( restore );
+    }
+    restoreClock.start();
+    kDebug( 1218 ) << "Restoring" << pendingRestores.count() << "clients, at most"
+                   << maxConcurrentRestores << "at a time";
+}
+
+static bool programMatches( const QString& program, const QString& name )
+{
+    return program == name || QFileInfo( program ).fileName() == name;
+}
+
+bool KSMServer::isRestorePending( const QString& program ) const
+{
+    foreach ( const PendingRestore& restore, pendingRestores ) {
+        if ( programMatches( restore.program, program ))
+            return true;
+    }
+    foreach ( const RunningRestore& running, runningRestores ) {
+        if ( programMatches( running.program, program ))
+            return true;
+    }
+    return false;
+}
+
+/*!
+  Returns the index of the first queued client whose dependencies are all up,
+  or -1 if every queued client has to wait for a client that is still starting.
+ */
+int KSMServer::nextRestoreCandidate() const
+{
+    for ( int i = 0; i < pendingRestores.count(); ++i ) {
+        bool ready = true;
+        foreach ( const QString& dependency, pendingRestores.at( i ).restoreAfter ) {
+            if ( isRestorePending( dependency )) {
+                ready = false;
+                break;
+            }
+        }
+        if ( ready )
+            return i;
+    }
+    // nothing is starting that could resolve the dependencies, so they are circular
+    if ( runningRestores.isEmpty() && !pendingRestores.isEmpty())
+        return 0;
+    return -1;
+}
+
 void KSMServer::clientRegistered( const char* previousId )
 {
-    if ( previousId && lastIdStarted == QString::fromLocal8Bit( previousId ) )
-        tryRestoreNext();
+    if ( !previousId )
+        return;
+    QHash<QString, RunningRestore>::iterator it = runningRestores.find( QString::fromLocal8Bit( previousId ));
+    if ( it == runningRestores.end())
+        return;
+    kDebug( 1218 ) << "Restored" << it->program << "in" << it->timer.elapsed() << "ms";
+    runningRestores.erase( it );
+    tryRestoreNext();
 }
 
 void KSMServer::tryRestoreNext()
@@ -325,15 +412,26 @@ void KSMServer::tryRestoreNext()
         return;
     restoreTimer.stop();
     startupSuspendTimeoutTimer.stop();
-    KConfigGroup config(KSharedConfig::openConfig(), sessionGroup );
 
-    while ( lastAppStarted < appsToStart ) {
-        lastAppStarted++;
-        QString n = QString::number(lastAppStarted);
-        QString clientId = config.readEntry( QStringLiteral("clientId")+n, QString() );
+    // don't wait forever for clients that never register
+    QMutableHashIterator<QString, RunningRestore> it( runningRestores );
+    while ( it.hasNext()) {
+        it.next();
+        if ( it.value().timer.elapsed() >= RESTORE_TIMEOUT ) {
+            kDebug( 1218 ) << "Restoring" << it.value().program << "timed out after"
+                           << it.value().timer.elapsed() << "ms";
+            it.remove();
+        }
+    }
+
+    while ( runningRestores.count() < maxConcurrentRestores ) {
+        int next = nextRestoreCandidate();
+        if ( next < 0 )
+            break;
+        PendingRestore restore = pendingRestores.takeAt( next );
         bool alreadyStarted = false;
         foreach ( KSMClient *c, clients ) {
-            if ( QString::fromLocal8Bit( c->clientId() ) == clientId ) {
+            if ( QString::fromLocal8Bit( c->clientId() ) == restore.clientId ) {
                 alreadyStarted = true;
                 break;
             }
@@ -341,29 +439,27 @@ void KSMServer::tryRestoreNext()
         if ( alreadyStarted )
             continue;
 
-        QStringList restartCommand = config.readEntry( QStringLiteral("restartCommand")+n, QStringList() );
-        if ( restartCommand.isEmpty() ||
-             (config.readEntry( QStringLiteral("restartStyleHint")+n, 0 ) == SmRestartNever)) {
-            continue;
-        }
-        if ( wm == config.readEntry( QStringLiteral("program")+n, QString() ) )
-            continue; // wm already started
-        if( config.readEntry( QStringLiteral( "wasWm" )+n, false ))
-            continue; // it was wm before, but not now, don't run it (some have --replace in command :(  )
-        startApplication( restartCommand,
-                          config.readEntry( QStringLiteral("clientMachine")+n, QString() ),
-                          config.readEntry( QStringLiteral("userId")+n, QString() ));
-        lastIdStarted = clientId;
-        if ( !lastIdStarted.isEmpty() ) {
-            restoreTimer.setSingleShot( true );
-            restoreTimer.start( 2000 );
-            return; // we get called again from the clientRegistered handler
-        }
+        startApplication( restore.restartCommand, restore.clientMachine, restore.userId );
+        if ( restore.clientId.isEmpty())
+            continue; // no way to find out when it is up, don't wait for it
+        RunningRestore& running = runningRestores[ restore.clientId ];
+        running.program = restore.program;
+        running.timer.start();
+    }
+
+    if ( !runningRestores.isEmpty()) {
+        // we get called again from the clientRegistered handler, or when
+        // the oldest client runs out of time
+        qint64 remaining = RESTORE_TIMEOUT;
+        foreach ( const RunningRestore& running, runningRestores )
+            remaining = qMin( remaining, RESTORE_TIMEOUT - running.timer.elapsed());
+        restoreTimer.setSingleShot( true );
+        restoreTimer.start( int( qMax( qint64( 0 ), remaining )));
+        return;
     }
 
     //all done
-    appsToStart = 0;
-    lastIdStarted.clear();
+    kDebug( 1218 ) << "Session restore done in" << restoreClock.elapsed() << "ms";
 
     if (state == Restoring)
         autoStart2();
@@ -577,12 +673,7 @@ void KSMServer::restoreSubSession( const QString& name )
 {
     sessionGroup = QStringLiteral( "SubSession: " ) + name;
 
-    KConfigGroup configSessionGroup( KSharedConfig::openConfig(), sessionGroup);
-    int count =  configSessionGroup.readEntry( "count", 0 );
-    appsToStart = count;
-    lastAppStarted = 0;
-    lastIdStarted.clear();
-
     state = RestoringSubSession;
+    loadRestoreQueue();
     tryRestoreNext();
 }
@@ -0,0 +1,174 @@
+/*****************************************************************
+ksmserver - the KDE session management server
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+******************************************************************/
+
+#include "sessionstore.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTest>
+
+class TestSessionStore : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void storeAndLoad();
+    void journalReplay();
+    void tornRecord();
+    void invalidJournal();
+private:
+    static QList<SessionClient> makeClients( int count, const QString& suffix = QString() );
+    static QString fileName( const QString& sessionGroup, const QString& suffix );
+    static QList<SessionClient> reload( const QString& sessionGroup );
+};
+
+QList<SessionClient> TestSessionStore::makeClients( int count, const QString& suffix )
+{
+    QList<SessionClient> clients;
+    for ( int i = 0; i < count; ++i ) {
+        SessionClient client;
+        client.program = QStringLiteral( "program%1" ).arg( i );
+        client.clientId = QStringLiteral( "client%1" ).arg( i );
+        client.restartCommand << client.program << QStringLiteral( "--restore" ) << suffix;
+        clients << client;
+    }
+    return clients;
+}
+
+QString TestSessionStore::fileName( const QString& sessionGroup, const QString& suffix )
+{
+    return QStandardPaths::writableLocation( QStandardPaths::GenericDataLocation )
+           + QStringLiteral( "/ksmserver/sessions/" ) + sessionGroup + QLatin1Char( '.' ) + suffix;
+}
+
+QList<SessionClient> TestSessionStore::reload( const QString& sessionGroup )
+{
+    SessionStore store;
+    return store.clients( sessionGroup );
+}
+
+void TestSessionStore::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled( true );
+    QDir( QStandardPaths::writableLocation( QStandardPaths::GenericDataLocation )
+          + QStringLiteral( "/ksmserver/sessions" )).removeRecursively();
+}
+
+void TestSessionStore::storeAndLoad()
+{
+    const QList<SessionClient> clients = makeClients( 3 );
+    {
+        SessionStore store;
+        QVERIFY( store.clients( QStringLiteral( "load" )).isEmpty());
+        store.store( QStringLiteral( "load" ), clients );
+    }
+    QVERIFY( QFile::exists( fileName( QStringLiteral( "load" ), QStringLiteral( "snapshot" ))));
+    QCOMPARE( reload( QStringLiteral( "load" )), clients );
+    QVERIFY( SessionStore().sessionGroups().contains( QStringLiteral( "load" )));
+}
+
+void TestSessionStore::journalReplay()
+{
+    QList<SessionClient> clients = makeClients( 4 );
+    QByteArray snapshot;
+    {
+        SessionStore store;
+        store.store( QStringLiteral( "replay" ), clients );
+        store.waitForWrites();
+        QFile snapshotFile( fileName( QStringLiteral( "replay" ), QStringLiteral( "snapshot" )));
+        QVERIFY( snapshotFile.open( QIODevice::ReadOnly ));
+        snapshot = snapshotFile.readAll();
+
+        // a changed client, a removed one, a new one and a different order
+        clients[ 1 ].restartCommand << QStringLiteral( "--changed" );
+        store.store( QStringLiteral( "replay" ), clients );
+        clients.removeAt( 2 );
+        store.store( QStringLiteral( "replay" ), clients );
+        clients << makeClients( 6 ).last();
+        clients.move( 0, 2 );
+        store.store( QStringLiteral( "replay" ), clients );
+    }
+    // the changes only went to the journal
+    QFile snapshotFile( fileName( QStringLiteral( "replay" ), QStringLiteral( "snapshot" )));
+    QVERIFY( snapshotFile.open( QIODevice::ReadOnly ));
+    QCOMPARE( snapshotFile.readAll(), snapshot );
+    QCOMPARE( reload( QStringLiteral( "replay" )), clients );
+}
+
+void TestSessionStore::tornRecord()
+{
+    const QList<SessionClient> first = makeClients( 3, QStringLiteral( "first" ));
+    const QList<SessionClient> second = makeClients( 3, QStringLiteral( "second" ));
+    const QList<SessionClient> third = makeClients( 3, QStringLiteral( "third" ));
+    {
+        SessionStore store;
+        store.store( QStringLiteral( "torn" ), makeClients( 3 ));
+        store.store( QStringLiteral( "torn" ), first );
+        store.store( QStringLiteral( "torn" ), second );
+    }
+
+    // the write of the last record was interrupted
+    QFile journal( fileName( QStringLiteral( "torn" ), QStringLiteral( "journal" )));
+    QVERIFY( journal.exists());
+    QVERIFY( journal.resize( journal.size() - 5 ));
+    QCOMPARE( reload( QStringLiteral( "torn" )), first );
+
+    // the next save can't go behind the torn record, where it would be lost
+    {
+        SessionStore store;
+        QCOMPARE( store.clients( QStringLiteral( "torn" )), first );
+        store.store( QStringLiteral( "torn" ), third );
+    }
+    QCOMPARE( reload( QStringLiteral( "torn" )), third );
+
+    // and the journal is used again after that
+    {
+        SessionStore store;
+        store.store( QStringLiteral( "torn" ), second );
+    }
+    QCOMPARE( reload( QStringLiteral( "torn" )), second );
+}
+
+void TestSessionStore::invalidJournal()
+{
+    const QList<SessionClient> clients = makeClients( 2 );
+    {
+        SessionStore store;
+        store.store( QStringLiteral( "invalid" ), makeClients( 1 ));
+    }
+    // a journal of another snapshot, e.g. after a crash while a new snapshot was written
+    QFile journal( fileName( QStringLiteral( "invalid" ), QStringLiteral( "journal" )));
+    QVERIFY( journal.open( QIODevice::WriteOnly | QIODevice::Truncate ));
+    journal.write( "garbage" );
+    journal.close();
+    QCOMPARE( reload( QStringLiteral( "invalid" )), makeClients( 1 ));
+
+    {
+        SessionStore store;
+        store.store( QStringLiteral( "invalid" ), clients );
+    }
+    QCOMPARE( reload( QStringLiteral( "invalid" )), clients );
+}
+
+QTEST_MAIN(TestSessionStore)
+#include "testsessionstore.moc"
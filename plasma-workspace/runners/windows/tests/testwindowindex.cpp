@@ -0,0 +1,111 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+#include "windowindex.h"
+
+#include <QTest>
+
+class TestWindowIndex : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void substring();
+    void caseInsensitive();
+    void shortTerm();
+    void rarestTrigram();
+    void changedText();
+    void remove();
+};
+
+void TestWindowIndex::substring()
+{
+    WindowIndex index;
+    index.insert(1, QStringLiteral("Mozilla Firefox\nNavigator\nFirefox\nbrowser"));
+    index.insert(2, QStringLiteral("~ : bash\nkonsole\nkonsole\nMainWindow#1"));
+
+    // also in the middle of a word
+    QCOMPARE(index.candidates(QStringLiteral("fox")), QSet<WId>() << 1);
+    QCOMPARE(index.candidates(QStringLiteral("sole")), QSet<WId>() << 2);
+    QCOMPARE(index.candidates(QStringLiteral("window#")), QSet<WId>() << 2);
+    QVERIFY(index.candidates(QStringLiteral("dolphin")).isEmpty());
+}
+
+void TestWindowIndex::caseInsensitive()
+{
+    WindowIndex index;
+    index.insert(1, QStringLiteral("KWrite"));
+    QCOMPARE(index.candidates(QStringLiteral("kwri")), QSet<WId>() << 1);
+    QCOMPARE(index.candidates(QStringLiteral("WRITE")), QSet<WId>() << 1);
+}
+
+void TestWindowIndex::shortTerm()
+{
+    WindowIndex index;
+    index.insert(1, QStringLiteral("KWrite"));
+    index.insert(2, QStringLiteral("Dolphin"));
+    // shorter than a trigram, the caller checks every window
+    QCOMPARE(index.candidates(QString()), QSet<WId>() << 1 << 2);
+    QCOMPARE(index.candidates(QStringLiteral("zz")), QSet<WId>() << 1 << 2);
+}
+
+void TestWindowIndex::rarestTrigram()
+{
+    WindowIndex index;
+    index.insert(1, QStringLiteral("abcdef"));
+    index.insert(2, QStringLiteral("abcxyz"));
+    index.insert(3, QStringLiteral("xabcx"));
+    QCOMPARE(index.candidates(QStringLiteral("abc")), QSet<WId>() << 1 << 2 << 3);
+    QCOMPARE(index.candidates(QStringLiteral("abcdef")), QSet<WId>() << 1);
+    // all trigrams have to be present, not just one
+    QVERIFY(index.candidates(QStringLiteral("abcdxy")).isEmpty());
+}
+
+void TestWindowIndex::changedText()
+{
+    // like the runner does when a window changes its title
+    WindowIndex index;
+    index.insert(1, QStringLiteral("Konsole"));
+    index.insert(2, QStringLiteral("Konqueror"));
+    index.insert(1, QStringLiteral("Dolphin"));
+    QVERIFY(index.contains(1));
+    QCOMPARE(index.candidates(QStringLiteral("kon")), QSet<WId>() << 2);
+    QCOMPARE(index.candidates(QStringLiteral("dolph")), QSet<WId>() << 1);
+
+    // unchanged text
+    index.insert(1, QStringLiteral("Dolphin"));
+    QCOMPARE(index.candidates(QStringLiteral("dolph")), QSet<WId>() << 1);
+    QCOMPARE(index.windows().count(), 2);
+}
+
+void TestWindowIndex::remove()
+{
+    WindowIndex index;
+    index.insert(1, QStringLiteral("Konsole"));
+    index.insert(2, QStringLiteral("Konqueror"));
+    index.remove(1);
+    index.remove(3);
+    QVERIFY(!index.contains(1));
+    QCOMPARE(index.windows(), QList<WId>() << 2);
+    QVERIFY(index.candidates(QStringLiteral("sole")).isEmpty());
+    QCOMPARE(index.candidates(QStringLiteral("kon")), QSet<WId>() << 2);
+
+    index.clear();
+    QVERIFY(index.windows().isEmpty());
+    QVERIFY(index.candidates(QStringLiteral("kon")).isEmpty());
+}
+
+QTEST_MAIN(TestWindowIndex)
+#include "testwindowindex.moc"
@@ -0,0 +1,97 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+#include "windowindex.h"
+
+void WindowIndex::insert(WId w, const QString &text)
+{
+    const QString normalized = text.toLower();
+    QHash<WId, QString>::iterator it = m_texts.find(w);
+    if (it != m_texts.end()) {
+        if (it.value() == normalized) {
+            return;
+        }
+        remove(w);
+    }
+
+    m_texts.insert(w, normalized);
+    foreach (const QString &trigram, trigrams(normalized)) {
+        m_trigrams[trigram].insert(w);
+    }
+}
+
+void WindowIndex::remove(WId w)
+{
+    QHash<WId, QString>::iterator it = m_texts.find(w);
+    if (it == m_texts.end()) {
+        return;
+    }
+
+    foreach (const QString &trigram, trigrams(it.value())) {
+        QHash<QString, QSet<WId> >::iterator windows = m_trigrams.find(trigram);
+        windows->remove(w);
+        if (windows->isEmpty()) {
+            m_trigrams.erase(windows);
+        }
+    }
+    m_texts.erase(it);
+}
+
+void WindowIndex::clear()
+{
+    m_texts.clear();
+    m_trigrams.clear();
+}
+
+bool WindowIndex::contains(WId w) const
+{
+    return m_texts.contains(w);
+}
+
+QList<WId> WindowIndex::windows() const
+{
+    return m_texts.keys();
+}
+
+QSet<WId> WindowIndex::candidates(const QString &term) const
+{
+    const QString normalized = term.toLower();
+    if (normalized.length() < 3) {
+        return m_texts.keys().toSet();
+    }
+
+    // only the windows with the rarest trigram of the term can contain it
+    const QSet<WId> *windows = 0;
+    for (int i = 0; i + 3 <= normalized.length(); ++i) {
+        QHash<QString, QSet<WId> >::const_iterator it = m_trigrams.constFind(normalized.mid(i, 3));
+        if (it == m_trigrams.constEnd()) {
+            return QSet<WId>();
+        }
+        if (!windows || it->count() < windows->count()) {
+            windows = &it.value();
+        }
+    }
+    return *windows;
+}
+
+QSet<QString> WindowIndex::trigrams(const QString &text)
+{
+    QSet<QString> result;
+    for (int i = 0; i + 3 <= text.length(); ++i) {
+        result.insert(text.mid(i, 3));
+    }
+    return result;
+}
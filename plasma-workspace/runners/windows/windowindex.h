@@ -0,0 +1,59 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+#ifndef WINDOWINDEX_H
+#define WINDOWINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <qwindowdefs.h>
+
+/**
+ * Finds the windows whose text, their name, class and role, contains a term.
+ *
+ * Every window is listed under each trigram of its lower case text, a window
+ * containing the term has to be listed under all trigrams of the term. Terms
+ * shorter than a trigram match every window.
+ */
+class WindowIndex
+{
+    public:
+        /**
+         * Adds @p w with @p text, or replaces the text it had
+         */
+        void insert(WId w, const QString &text);
+        void remove(WId w);
+        void clear();
+
+        bool contains(WId w) const;
+        QList<WId> windows() const;
+
+        /**
+         * @return the windows which might contain @p term, the caller
+         *         checks which fields of them actually do
+         */
+        QSet<WId> candidates(const QString &term) const;
+
+    private:
+        static QSet<QString> trigrams(const QString &text);
+
+        QHash<WId, QString> m_texts;
+        QHash<QString, QSet<WId> > m_trigrams;
+};
+
+#endif // WINDOWINDEX_H
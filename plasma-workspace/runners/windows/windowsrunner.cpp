@@ -18,20 +18,71 @@
  ***************************************************************************/
 #include "windowsrunner.h"
 
+#include <QIconEngine>
+#include <QPainter>
 #include <QTimer>
 
 #include <QDebug>
 #include <KIcon>
 #include <KWindowSystem>
 
-#ifdef Q_WS_X11
 #include <QX11Info>
 #include <netwm.h>
-#endif
+
+static const NET::Properties s_windowProperties = NET::WMWindowType | NET::WMDesktop |
+                                                  NET::WMState | NET::XAWMState | NET::WMName;
+static const NET::Properties2 s_windowProperties2 = NET::WM2WindowClass | NET::WM2WindowRole |
+                                                    NET::WM2AllowedActions;
+
+/**
+ * Reads the icon of a window only once a match with it is shown.
+ *
+ * Pixmaps can't be made in the matching threads, but the icon is only painted
+ * in the GUI thread. The copies of a QIcon share their engine, so all matches
+ * of a window read its icon once, until it changes.
+ */
+class WindowIconEngine : public QIconEngine
+{
+public:
+    explicit WindowIconEngine(WId w)
+        : m_window(w)
+    {
+    }
+
+    virtual void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state)
+    {
+        painter->drawPixmap(rect, pixmap(rect.size(), mode, state));
+    }
+
+    virtual QPixmap pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state)
+    {
+        if (m_icon.isNull()) {
+            m_icon = QIcon(KWindowSystem::icon(m_window));
+        }
+        return m_icon.pixmap(size, mode, state);
+    }
+
+    virtual QIconEngine *clone() const
+    {
+        return new WindowIconEngine(*this);
+    }
+
+private:
+    WId m_window;
+    QIcon m_icon;
+};
+
+// the text a window can be found by
+static QString indexText(const KWindowInfo& info)
+{
+    return info.name() + QLatin1Char('\n') +
+           QString::fromUtf8(info.windowClassName()) + QLatin1Char('\n') +
+           QString::fromUtf8(info.windowClassClass()) + QLatin1Char('\n') +
+           QString::fromUtf8(info.windowRole());
+}
 
 WindowsRunner::WindowsRunner(QObject* parent, const QVariantList& args)
     : AbstractRunner(parent, args),
-      m_inSession(false),
       m_ready(false)
 {
     Q_UNUSED(args)
@@ -54,7 +105,6 @@ WindowsRunner::WindowsRunner(QObject* parent, const QVariantList& args)
                                    i18n("Lists all other desktops and allows to switch to them.")));
 
     connect(this, SIGNAL(prepare()), this, SLOT(prepareForMatchSession()));
-    connect(this, SIGNAL(teardown()), this, SLOT(matchSessionComplete()));
 }
 
 WindowsRunner::~WindowsRunner()
@@ -63,56 +113,106 @@ WindowsRunner::~WindowsRunner()
 
 void WindowsRunner::gatherInfo()
 {
-    if (!m_inSession) {
+    if (m_ready) {
         return;
     }
 
     foreach (const WId w, KWindowSystem::windows()) {
-        KWindowInfo info = KWindowSystem::windowInfo(w, NET::WMWindowType | NET::WMDesktop |
-                                                        NET::WMState | NET::XAWMState |
-                                                        NET::WMName,
-                                                    NET::WM2WindowClass | NET::WM2WindowRole | NET::WM2AllowedActions);
-        if (info.valid()) {
-            // ignore NET::Tool and other special window types
-            NET::WindowType wType = info.windowType(NET::NormalMask | NET::DesktopMask | NET::DockMask |
-                                                    NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
-                                                    NET::OverrideMask | NET::TopMenuMask |
-                                                    NET::UtilityMask | NET::SplashMask);
-
-            if (wType != NET::Normal && wType != NET::Override && wType != NET::Unknown &&
-                wType != NET::Dialog && wType != NET::Utility) {
-                continue;
-            }
-            m_windows.insert(w, info);
-            m_icons.insert(w, QIcon(KWindowSystem::icon(w)));
-        }
+        windowAdded(w);
     }
+    desktopNamesChanged();
 
-    for (int i=1; i<=KWindowSystem::numberOfDesktops(); i++) {
-        m_desktopNames << KWindowSystem::desktopName(i);
-    }
+    connect(KWindowSystem::self(), SIGNAL(windowAdded(WId)), this, SLOT(windowAdded(WId)));
+    connect(KWindowSystem::self(), SIGNAL(windowRemoved(WId)), this, SLOT(windowRemoved(WId)));
+    connect(KWindowSystem::self(), SIGNAL(windowChanged(WId,const ulong*)),
+            this, SLOT(windowChanged(WId,const ulong*)));
+    connect(KWindowSystem::self(), SIGNAL(desktopNamesChanged()), this, SLOT(desktopNamesChanged()));
+    connect(KWindowSystem::self(), SIGNAL(numberOfDesktopsChanged(int)), this, SLOT(desktopNamesChanged()));
 
+    QWriteLocker locker(&m_lock);
     m_ready = true;
 }
 
-void WindowsRunner::prepareForMatchSession()
+void WindowsRunner::windowAdded(WId w)
+{
+    updateWindow(w, true);
+}
+
+void WindowsRunner::windowRemoved(WId w)
+{
+    QWriteLocker locker(&m_lock);
+    m_windows.remove(w);
+    m_icons.remove(w);
+    m_index.remove(w);
+}
+
+void WindowsRunner::windowChanged(WId w, const unsigned long *dirty)
+{
+    const bool iconChanged = dirty[NETWinInfo::PROTOCOLS] & NET::WMIcon;
+    if (iconChanged ||
+        (dirty[NETWinInfo::PROTOCOLS] & s_windowProperties) ||
+        (dirty[NETWinInfo::PROTOCOLS2] & s_windowProperties2)) {
+        // also picks up windows which changed their type
+        updateWindow(w, iconChanged);
+    }
+}
+
+void WindowsRunner::updateWindow(WId w, bool iconChanged)
+{
+    KWindowInfo info = KWindowSystem::windowInfo(w, s_windowProperties, s_windowProperties2);
+    if (!info.valid()) {
+        windowRemoved(w);
+        return;
+    }
+    // ignore NET::Tool and other special window types
+    NET::WindowType wType = info.windowType(NET::NormalMask | NET::DesktopMask | NET::DockMask |
+                                            NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
+                                            NET::OverrideMask | NET::TopMenuMask |
+                                            NET::UtilityMask | NET::SplashMask);
+
+    if (wType != NET::Normal && wType != NET::Override && wType != NET::Unknown &&
+        wType != NET::Dialog && wType != NET::Utility) {
+        windowRemoved(w);
+        return;
+    }
+
+    // only this thread changes the catalogue, so it can be read without the lock,
+    // a new icon is only read once it is shown
+    QIcon icon;
+    if (iconChanged || !m_icons.contains(w)) {
+        icon = QIcon(new WindowIconEngine(w));
+    } else {
+        icon = m_icons.value(w);
+    }
+    const QString text = indexText(info);
+
+    QWriteLocker locker(&m_lock);
+    m_windows.insert(w, info);
+    m_icons.insert(w, icon);
+    m_index.insert(w, text);
+}
+
+void WindowsRunner::desktopNamesChanged()
 {
-    m_inSession = true;
-    m_ready = false;
-    QTimer::singleShot(0, this, SLOT(gatherInfo()));
+    QStringList desktopNames;
+    for (int i=1; i<=KWindowSystem::numberOfDesktops(); i++) {
+        desktopNames << KWindowSystem::desktopName(i);
+    }
+
+    QWriteLocker locker(&m_lock);
+    m_desktopNames = desktopNames;
 }
 
-void WindowsRunner::matchSessionComplete()
+void WindowsRunner::prepareForMatchSession()
 {
-    m_inSession = false;
-    m_ready = false;
-    m_desktopNames.clear();
-    m_icons.clear();
-    m_windows.clear();
+    if (!m_ready) {
+        QTimer::singleShot(0, this, SLOT(gatherInfo()));
+    }
 }
 
 void WindowsRunner::match(Plasma::RunnerContext& context)
 {
+    QReadLocker locker(&m_lock);
     if (!m_ready) {
         return;
     }
@@ -190,17 +290,14 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
                 }
             }
         }
-        QHashIterator<WId, KWindowInfo> it(m_windows);
-        while(it.hasNext()) {
-            it.next();
-            WId w = it.key();
-            KWindowInfo info = it.value();
+        const bool unrestricted = windowName.isEmpty() && windowClass.isEmpty() && windowRole.isEmpty() && desktop == -1;
+        const QSet<WId> windows = unrestricted ? m_index.candidates(term.mid(keywords[0].length() + 1))
+                                               : m_windows.keys().toSet();
+        foreach (const WId w, windows) {
+            const KWindowInfo info = m_windows.value(w);
             QString windowClassCompare = QString::fromUtf8(info.windowClassName()) + " " +
                                          QString::fromUtf8(info.windowClassClass());
             // exclude not matching windows
-            if (!KWindowSystem::hasWId(w)) {
-                continue;
-            }
             if (!windowName.isEmpty() && !info.name().contains(windowName, Qt::CaseInsensitive)) {
                 continue;
             }
@@ -215,7 +312,7 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
             }
             // check for windows when no keywords were used
             // check the name, class and role for containing the query without the keyword
-            if (windowName.isEmpty() && windowClass.isEmpty() && windowRole.isEmpty() && desktop == -1) {
+            if (unrestricted) {
                 const QString& test = term.mid(keywords[0].length() + 1);
                 if (!info.name().contains(test, Qt::CaseInsensitive) &&
                     !windowClassCompare.contains(test, Qt::CaseInsensitive) &&
@@ -261,21 +358,16 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
     }
 
     // check for matches without keywords
-    QHashIterator<WId, KWindowInfo> it(m_windows);
-    while (it.hasNext()) {
-        it.next();
-        WId w = it.key();
-        if (!KWindowSystem::hasWId(w)) {
-            continue;
-        }
+    foreach (const WId w, m_index.candidates(term)) {
         // check if window name, class or role contains the query
-        KWindowInfo info = it.value();
+        const KWindowInfo info = m_windows.value(w);
         QString className = QString::fromUtf8(info.windowClassName());
         if (info.name().startsWith(term, Qt::CaseInsensitive) ||
             className.startsWith(term, Qt::CaseInsensitive)) {
             matches << windowMatch(info, action, 0.8, Plasma::QueryMatch::ExactMatch);
         } else if ((info.name().contains(term, Qt::CaseInsensitive) ||
-             className.contains(term, Qt::CaseInsensitive)) && 
+             className.contains(term, Qt::CaseInsensitive) ||
+             QString::fromUtf8(info.windowRole()).contains(term, Qt::CaseInsensitive)) &&
             actionSupported(info, action)) {
             matches << windowMatch(info, action, 0.7, Plasma::QueryMatch::PossibleMatch);
         }
@@ -320,7 +412,9 @@ void WindowsRunner::run(const Plasma::RunnerContext& context, const Plasma::Quer
     const QStringList parts = match.data().toString().split("_");
     WindowAction action = WindowAction(parts[0].toInt());
     WId w = WId(parts[1].toULong());
-    KWindowInfo info = m_windows[w];
+    m_lock.lockForRead();
+    KWindowInfo info = m_windows.value(w);
+    m_lock.unlock();
     switch (action) {
     case ActivateAction:
         KWindowSystem::forceActiveWindow(w);
@@ -400,7 +494,7 @@ Plasma::QueryMatch WindowsRunner::windowMatch(const KWindowInfo& info, WindowAct
     Plasma::QueryMatch match(this);
     match.setType(type);
     match.setData(QString(QString::number((int)action) + "_" + QString::number(info.win())));
-    match.setIcon(m_icons[info.win()]);
+    match.setIcon(m_icons.value(info.win()));
     match.setText(info.name());
     QString desktopName;
     int desktop = info.desktop();
@@ -19,8 +19,12 @@
 #ifndef WINDOWSRUNNER_H
 #define WINDOWSRUNNER_H
 
+#include <QReadWriteLock>
+
 #include <Plasma/AbstractRunner>
 
+#include "windowindex.h"
+
 class KWindowInfo;
 
 class WindowsRunner : public Plasma::AbstractRunner
@@ -36,8 +40,11 @@ class WindowsRunner : public Plasma::AbstractRunner
 
     private Q_SLOTS:
         void prepareForMatchSession();
-        void matchSessionComplete();
         void gatherInfo();
+        void windowAdded(WId w);
+        void windowRemoved(WId w);
+        void windowChanged(WId w, const unsigned long *dirty);
+        void desktopNamesChanged();
 
     private:
         enum WindowAction {
@@ -54,12 +61,17 @@ class WindowsRunner : public Plasma::AbstractRunner
         Plasma::QueryMatch windowMatch(const KWindowInfo& info, WindowAction action, qreal relevance = 1.0,
                                        Plasma::QueryMatch::Type type = Plasma::QueryMatch::ExactMatch);
         bool actionSupported(const KWindowInfo& info, WindowAction action);
+        void updateWindow(WId w, bool iconChanged);
 
+        // the windows are kept up to date from the signals of KWindowSystem in
+        // the GUI thread once the first match session started, the matching
+        // threads only read them with m_lock locked
+        QReadWriteLock m_lock;
         QHash<WId, KWindowInfo> m_windows;
         QHash<WId, QIcon> m_icons;
+        WindowIndex m_index;
         QStringList m_desktopNames;
 
-        bool m_inSession : 1;
         bool m_ready : 1;
 };
 
@@ -24,8 +24,11 @@
 
 #include <unistd.h>
 
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFuture>
 #include <QTimer>
+#include <QtConcurrentRun>
 
 #include <kapplication.h>
 #include <kcmdlineargs.h>
@@ -63,7 +66,17 @@ static void waitForReady()
   close( ready[ 0 ] );
 }
 
-bool KCMInit::runModule(const QString &libName, KService::Ptr service)
+// calls the kcminit function of a module, returns how long it took in ms
+static qint64 timedInit( KLibrary::void_function_ptr init )
+{
+    QElapsedTimer timer;
+    timer.start();
+    void (*func)() = (void(*)())init;
+    func();
+    return timer.elapsed();
+}
+
+KLibrary::void_function_ptr KCMInit::resolveModule(const QString &libName, KService::Ptr service)
 {
     KLibrary lib(libName);
     if (lib.load()) {
@@ -81,39 +94,40 @@ bool KCMInit::runModule(const QString &libName, KService::Ptr service)
         // get the kcminit_ function
         KLibrary::void_function_ptr init = lib.resolveFunction(kcminit.toUtf8().constData());
         if (init) {
-            // initialize the module
             kDebug(1208) << "Initializing " << libName << ": " << kcminit;
-
-            void (*func)() = (void(*)())init;
-            func();
-            return true;
+            return init;
         } else {
             kDebug(1208) << "Module" << libName << "does not actually have a kcminit function";
         }
     }
-    return false;
+    return 0;
+}
+
+bool KCMInit::runModule(const QString &libName, KService::Ptr service)
+{
+    KLibrary::void_function_ptr init = resolveModule(libName, service);
+    if (!init)
+        return false;
+    timings.append(qMakePair(libName, timedInit(init)));
+    return true;
 }
 
 void KCMInit::runModules( int phase )
 {
+  QElapsedTimer phaseTimer;
+  phaseTimer.start();
+  timings.clear();
+
+  // modules declaring X-KDE-Init-ThreadSafe=true do not touch the GUI
+  // and are run concurrently with the rest, which stays in the main thread
+  QList< QPair< QString, QFuture< qint64 > > > concurrent;
+  KService::List serial;
   for(KService::List::Iterator it = list.begin();
       it != list.end();
       ++it) {
       KService::Ptr service = (*it);
 
-      QVariant tmp = service->property("X-KDE-Init-Library", QVariant::String);
-      QString library;
-      if( tmp.isValid() )
-      {
-          library = tmp.toString();
-          if( !library.startsWith( QLatin1String( "kcminit_" ) ) )
-              library = QLatin1String( "kcminit_" ) + library;
-      }
-      else
-      {
-          library = service->library();
-      }
-
+      QString library = moduleLibrary(service);
       if (library.isEmpty())
           continue; // Skip
 
@@ -126,12 +140,85 @@ void KCMInit::runModules( int phase )
       if( phase != -1 && libphase != phase )
           continue;
 
-      // try to load the library
-      if (!alreadyInitialized.contains(library)) {
-          runModule(library, service);
-          alreadyInitialized.append(library);
+      // modules that don't affect the first frame may ask to be run once
+      // the desktop is up, see runDeferredModules()
+      if( phase > 0 && service->property("X-KDE-Init-Deferred", QVariant::Bool).toBool() ) {
+          if( !deferred.contains(service) )
+              deferred.append(service);
+          continue;
+      }
+
+      if (alreadyInitialized.contains(library))
+          continue;
+      alreadyInitialized.append(library);
+
+      if( service->property("X-KDE-Init-ThreadSafe", QVariant::Bool).toBool() ) {
+          if (KLibrary::void_function_ptr init = resolveModule(library, service))
+              concurrent.append(qMakePair(library, QtConcurrent::run(timedInit, init)));
+      } else {
+          serial.append(service);
       }
   }
+
+  foreach (const KService::Ptr& service, serial)
+      runModule(moduleLibrary(service), service);
+
+  for (int i = 0; i < concurrent.count(); ++i) {
+      concurrent[i].second.waitForFinished();
+      timings.append(qMakePair(concurrent.at(i).first, concurrent.at(i).second.result()));
+  }
+
+  reportTimings(phase, phaseTimer.elapsed());
+}
+
+void KCMInit::runDeferredModules()
+{
+  QElapsedTimer phaseTimer;
+  phaseTimer.start();
+  timings.clear();
+  foreach (const KService::Ptr& service, deferred) {
+      QString library = moduleLibrary(service);
+      if (alreadyInitialized.contains(library))
+          continue;
+      alreadyInitialized.append(library);
+      runModule(library, service);
+  }
+  deferred.clear();
+  reportTimings(-2, phaseTimer.elapsed());
+  qApp->exit( 0 );
+}
+
+QString KCMInit::moduleLibrary(KService::Ptr service)
+{
+  QVariant tmp = service->property("X-KDE-Init-Library", QVariant::String);
+  QString library;
+  if( tmp.isValid() )
+  {
+      library = tmp.toString();
+      if( !library.startsWith( QLatin1String( "kcminit_" ) ) )
+          library = QLatin1String( "kcminit_" ) + library;
+  }
+  else
+  {
+      library = service->library();
+  }
+  return library;
+}
+
+static bool slowerThan(const QPair<QString, qint64> &a, const QPair<QString, qint64> &b)
+{
+  return a.second > b.second;
+}
+
+void KCMInit::reportTimings(int phase, qint64 total)
+{
+  if (timings.isEmpty())
+      return;
+  qSort(timings.begin(), timings.end(), slowerThan);
+  QString name = phase == -2 ? QStringLiteral("deferred") : QString::number(phase);
+  kDebug(1208) << "Phase" << name << "took" << total << "ms";
+  for (int i = 0; i < timings.count(); ++i)
+      kDebug(1208) << "  " << timings.at(i).first << timings.at(i).second << "ms";
 }
 
 KCMInit::KCMInit( KCmdLineArgs* args )
@@ -229,7 +316,8 @@ void KCMInit::runPhase2()
 {
   runModules( 2 );
   emit phase2Done();
-  qApp->exit( 0 );
+  // return to ksmserver first, it waits for this call before starting the applications
+  QTimer::singleShot( 0, this, SLOT(runDeferredModules()) );
 }
 
 extern "C" Q_DECL_EXPORT int kdemain(int argc, char *argv[])
@@ -20,7 +20,9 @@
 #ifndef MAIN_H
 #define MAIN_H
 
+#include <QPair>
 #include <kservice.h>
+#include <klibrary.h>
 
 class KCmdLineArgs;
 
@@ -37,11 +39,18 @@ class KCMInit : public QObject
     public:
         KCMInit( KCmdLineArgs* args );
         virtual ~KCMInit();
+    private Q_SLOTS:
+        void runDeferredModules();
     private:
+        KLibrary::void_function_ptr resolveModule(const QString &libName, KService::Ptr service);
         bool runModule(const QString &libName, KService::Ptr service);
         void runModules( int phase );
+        void reportTimings(int phase, qint64 total);
+        static QString moduleLibrary(KService::Ptr service);
         KService::List list;
+        KService::List deferred;
         QStringList alreadyInitialized;
+        QList< QPair<QString, qint64> > timings; // ms per module of the last phase
 };
 
 #endif // MAIN_H
@@ -40,6 +40,7 @@
 #include <Plasma/PluginLoader>
 
 #include "image.h"
+#include "wallpaperindex.h"
 #include "wallpaperpackage.h"
 
 QSet<QString> BackgroundFinder::m_suffixes;
@@ -52,8 +53,7 @@ ImageSizeFinder::ImageSizeFinder(const QString &path, QObject *parent)
 
 void ImageSizeFinder::run()
 {
-    QImage image(m_path);
-    Q_EMIT sizeFound(m_path, image.size());
+    Q_EMIT sizeFound(m_path, WallpaperIndex::self()->imageSize(m_path));
 }
 
 
@@ -77,6 +77,7 @@ BackgroundListModel::BackgroundListModel(Image *listener, QObject *parent)
 
 BackgroundListModel::~BackgroundListModel()
 {
+    WallpaperIndex::self()->save();
 }
 
 void BackgroundListModel::removeBackground(const QString &path)
@@ -405,44 +406,54 @@ void BackgroundFinder::run()
     QStringList papersFound;
 
     QDir dir;
-    dir.setFilter(QDir::AllDirs | QDir::Files | QDir::Hidden | QDir::Readable);
+    dir.setFilter(QDir::AllDirs | QDir::NoDotAndDotDot | QDir::Files | QDir::Hidden | QDir::Readable);
     //Plasma::Package pkg = Plasma::PluginLoader::self()->loadPackage(QString::fromLatin1("Plasma/Wallpaper"));
     Plasma::Package pkg = Plasma::Package(new WallpaperPackage(0, 0));
+    WallpaperIndex *index = WallpaperIndex::self();
 
     int i;
     for (i = 0; i < m_paths.count(); ++i) {
         const QString path = m_paths.at(i);
-        dir.setPath(path);
-        const QFileInfoList files = dir.entryInfoList();
-        Q_FOREACH (const QFileInfo &wp, files) {
-            if (wp.isDir()) {
-                //qDebug() << "scanning directory" << wp.fileName();
-
-                const QString name = wp.fileName();
-                if (name == QString::fromLatin1(".") || name == QString::fromLatin1("..")) {
-                    // do nothing
-                    continue;
-                }
 
-                const QString filePath = wp.filePath();
-                if (QFile::exists(filePath + QString::fromLatin1("/metadata.desktop"))) {
-                    pkg.setPath(filePath);
-                    if (pkg.isValid()) {
-                        papersFound << pkg.path();
-                        //qDebug() << "adding package" << wp.filePath();
-                        continue;
-                    }
+        // only list the directories which changed since the last run, whether a
+        // subdirectory is a package is checked every time as adding its metadata
+        // doesn't touch this directory
+        QStringList images;
+        QStringList subdirs;
+        if (!index->directory(path, &images, &subdirs)) {
+            dir.setPath(path);
+            const QFileInfoList files = dir.entryInfoList();
+            Q_FOREACH (const QFileInfo &wp, files) {
+                if (wp.isDir()) {
+                    subdirs << wp.filePath();
+                } else if (fileSuffixes.contains(wp.suffix().toLower())) {
+                    images << wp.filePath();
                 }
+            }
+            index->setDirectory(path, images, subdirs);
+        }
+
+        //qDebug() << "adding image files" << images;
+        papersFound << images;
 
-                // add this to the directories we should be looking at
-                m_paths.append(filePath);
-            } else if (fileSuffixes.contains(wp.suffix().toLower())) {
-                //qDebug() << "adding image file" << wp.filePath();
-                papersFound << wp.filePath();
+        Q_FOREACH (const QString &filePath, subdirs) {
+            //qDebug() << "scanning directory" << filePath;
+            if (QFile::exists(filePath + QString::fromLatin1("/metadata.desktop"))) {
+                pkg.setPath(filePath);
+                if (pkg.isValid()) {
+                    papersFound << pkg.path();
+                    //qDebug() << "adding package" << filePath;
+                    continue;
+                }
             }
+
+            // add this to the directories we should be looking at
+            m_paths.append(filePath);
         }
     }
 
+    index->save();
+
     //qDebug() << "WP background found!" << papersFound.size() << "in" << i << "dirs, taking" << t.elapsed() << "ms";
     Q_EMIT backgroundsFound(papersFound, m_token);
     deleteLater();
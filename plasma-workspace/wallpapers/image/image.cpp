@@ -22,6 +22,8 @@
  ***************************************************************************/
 
 #include "image.h"
+#include "slideimagecache.h"
+#include "wallpaperindex.h"
 #include "wallpaperpackage.h"
 
 #include <QAction>
@@ -55,12 +57,20 @@ Image::Image(QObject *parent)
       m_mode(SingleImage),
       m_currentSlide(-1),
       m_model(0),
-      m_dialog(0)
+      m_dialog(0),
+      m_width(0),
+      m_height(0),
+      m_fillMode(SlideImageCache::PreserveAspectCrop)
 {
     m_wallpaperPackage = Plasma::Package(new WallpaperPackage(this, this));
+    m_preloadPackage = Plasma::Package(new WallpaperPackage(this, this));
 
     connect(&m_timer, SIGNAL(timeout()), this, SLOT(nextSlide()));
 
+    // the width and height usually change together
+    m_preloadTimer.setSingleShot(true);
+    connect(&m_preloadTimer, SIGNAL(timeout()), this, SLOT(preloadNextSlide()));
+
     connect(m_dirWatch, SIGNAL(created(QString)), SLOT(pathCreated(QString)));
     connect(m_dirWatch, SIGNAL(dirty(QString)),   SLOT(pathDirty(QString)));
     connect(m_dirWatch, SIGNAL(deleted(QString)), SLOT(pathDeleted(QString)));
@@ -74,6 +84,8 @@ Image::Image(QObject *parent)
 
 Image::~Image()
 {
+    SlideImageCache::self()->discard(m_preloadKey);
+    WallpaperIndex::self()->save();
 }
 
 QString Image::wallpaperPath() const
@@ -137,6 +149,9 @@ void Image::setHeight(int h)
     if (m_height != h) {
         m_height = h;
         emit sizeChanged(QSize(m_width, m_height));
+        if (m_mode == SlideShow) {
+            m_preloadTimer.start(200);
+        }
     }
 }
 
@@ -150,6 +165,25 @@ void Image::setWidth(int w)
     if (m_width != w) {
         m_width = w;
         emit sizeChanged(QSize(m_width, m_height));
+        if (m_mode == SlideShow) {
+            m_preloadTimer.start(200);
+        }
+    }
+}
+
+int Image::fillMode() const
+{
+    return m_fillMode;
+}
+
+void Image::setFillMode(int fillMode)
+{
+    if (m_fillMode != fillMode) {
+        m_fillMode = fillMode;
+        emit fillModeChanged();
+        if (m_mode == SlideShow) {
+            m_preloadTimer.start(200);
+        }
     }
 }
 
@@ -284,7 +318,8 @@ void Image::removeSlidePath(const QString &path)
 
 void Image::pathDirty(const QString& path)
 {
-    updateDirWatch(QStringList(path));
+    // the watched directories stay the same, only what is known about the path is stale
+    WallpaperIndex::self()->invalidate(path);
 }
 
 void Image::updateDirWatch(const QStringList &newDirs)
@@ -590,7 +625,11 @@ void Image::nextSlide()
         }
     }
 
-    m_currentSlide = KRandom::random() % m_unseenSlideshowBackgrounds.size();
+    // the upcoming slide was picked and preloaded when showing the previous one
+    m_currentSlide = m_unseenSlideshowBackgrounds.indexOf(m_nextSlide);
+    if (m_currentSlide < 0) {
+        m_currentSlide = KRandom::random() % m_unseenSlideshowBackgrounds.size();
+    }
     const QString currentPath = m_unseenSlideshowBackgrounds.at(m_currentSlide);
 
     m_wallpaperPackage.setPath(currentPath);
@@ -606,6 +645,36 @@ void Image::nextSlide()
     }
 
     Q_EMIT wallpaperPathChanged();
+
+    // pick the slide after this one, from the ones nextSlide() will choose from
+    QStringList upcoming = m_unseenSlideshowBackgrounds;
+    upcoming.removeAt(m_currentSlide);
+    if (upcoming.isEmpty()) {
+        upcoming = m_slideshowBackgrounds;
+        upcoming.removeAll(currentPath);
+    }
+    m_nextSlide = upcoming.isEmpty() ? QString() : upcoming.at(KRandom::random() % upcoming.size());
+
+    // give the transition to this slide a head start
+    m_preloadTimer.start(qMin(m_delay * 1000 / 2, 2000));
+}
+
+void Image::preloadNextSlide()
+{
+    SlideImageCache *cache = SlideImageCache::self();
+    cache->discard(m_preloadKey);
+    m_preloadKey.clear();
+
+    if (m_mode != SlideShow || m_nextSlide.isEmpty() || m_width <= 0 || m_height <= 0) {
+        return;
+    }
+
+    m_preloadPackage.setPath(m_nextSlide);
+    QString path = m_preloadPackage.filePath("preferred");
+    if (path.isEmpty()) {
+        path = m_nextSlide;
+    }
+    m_preloadKey = cache->preload(path, QSize(m_width, m_height), m_fillMode);
 }
 
 void Image::openSlide()
@@ -622,6 +691,7 @@ void Image::openSlide()
 
 void Image::pathCreated(const QString &path)
 {
+    WallpaperIndex::self()->invalidate(path);
     if(!m_slideshowBackgrounds.contains(path)) {
         QFileInfo fileInfo(path);
         if(fileInfo.isFile() && BackgroundFinder::suffixes().contains(fileInfo.suffix().toLower())) {
@@ -636,6 +706,7 @@ void Image::pathCreated(const QString &path)
 
 void Image::pathDeleted(const QString &path)
 {
+    WallpaperIndex::self()->invalidate(path);
     if(m_slideshowBackgrounds.removeAll(path)) {
         m_unseenSlideshowBackgrounds.removeAll(path);
         if(path == m_img) {
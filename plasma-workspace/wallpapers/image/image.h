@@ -55,6 +55,7 @@ class Image : public QObject
     Q_PROPERTY(QStringList slidePaths READ slidePaths WRITE setSlidePaths NOTIFY slidePathsChanged)
     Q_PROPERTY(int width MEMBER m_width READ width WRITE setWidth NOTIFY sizeChanged)
     Q_PROPERTY(int height MEMBER m_height READ height WRITE setHeight NOTIFY sizeChanged)
+    Q_PROPERTY(int fillMode READ fillMode WRITE setFillMode NOTIFY fillModeChanged)
 
     public:
 
@@ -92,6 +93,12 @@ class Image : public QObject
         void setWidth(int w);
         void setHeight(int h);
 
+        /**
+         * The fillMode of the QML images, the slides are preloaded for it
+         */
+        int fillMode() const;
+        void setFillMode(int fillMode);
+
         Plasma::Package *package();
 
         QAbstractItemModel* wallpaperModel();
@@ -117,6 +124,7 @@ class Image : public QObject
         void slidePathsChanged();
         void resizeMethodChanged();
         void sizeChanged(QSize s);
+        void fillModeChanged();
         void customWallpaperPicked();
 
     protected Q_SLOTS:
@@ -141,6 +149,7 @@ class Image : public QObject
         void pathDeleted(const QString &path);
         void pathDirty(const QString &path);
         void backgroundsFound(const QStringList &paths, const QString &token);
+        void preloadNextSlide();
 
     protected:
         void setSingleImage();
@@ -171,7 +180,12 @@ class Image : public QObject
         QSize m_size;
         int m_width;
         int m_height;
+        int m_fillMode;
         QString m_img;
+        QString m_nextSlide;
+        QString m_preloadKey;
+        QTimer m_preloadTimer;
+        Plasma::Package m_preloadPackage;
         QDateTime m_previousModified;
         QWeakPointer<KNS3::DownloadDialog> m_newStuffDialog;
         QString m_findToken;
@@ -46,6 +46,14 @@ Rectangle {
     }
 
     //private
+    // decoded and scaled for the screen by the C++ side, which preloads the slides
+    function imageSource(path) {
+        if (path == "") {
+            return ""
+        }
+        return "image://wallpaperimage/" + fillMode + "/" + encodeURIComponent(path)
+    }
+
     function fadeWallpaper() {
         fadeAnim.running = false
         if (currentImage == imageA) {
@@ -55,7 +63,7 @@ Rectangle {
             currentImage = imageA
             otherImage = imageB
         }
-        currentImage.source = modelImage
+        currentImage.source = imageSource(modelImage)
         currentImage.opacity = 0
         otherImage.z = 0
         currentImage.z = 1
@@ -71,7 +79,7 @@ Rectangle {
             currentImage = imageA
             otherImage = imageB
         }
-        currentImage.source = modelImage
+        currentImage.source = imageSource(modelImage)
         currentImage.opacity = 0
         otherImage.z = 0
         currentImage.fillMode = fillMode
@@ -107,6 +115,7 @@ Rectangle {
 //         targetSize: "1920x1080"
         width: parent.width
         height: parent.height
+        fillMode: root.fillMode
         slidePaths: wallpaper.configuration.SlidePaths
         slideTimer: wallpaper.configuration.SlideInterval
     }
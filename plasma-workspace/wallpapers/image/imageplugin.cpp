@@ -19,11 +19,18 @@
 
 #include "imageplugin.h"
 #include "image.h"
+#include "slideimagecache.h"
 
 #include <QQmlContext>
 #include <QtQml>
 
 
+void ImagePlugin::initializeEngine(QQmlEngine *engine, const char *uri)
+{
+    Q_UNUSED(uri)
+    engine->addImageProvider(QStringLiteral("wallpaperimage"), new SlideImageProvider);
+}
+
 void ImagePlugin::registerTypes(const char *uri)
 {
     Q_ASSERT(uri == QLatin1String("org.kde.plasma.wallpapers.image"));
@@ -0,0 +1,182 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "slideimagecache.h"
+
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QUrl>
+
+// enough for the next slide of three 4K screens
+static const int s_budget = 128 * 1024;
+
+Q_GLOBAL_STATIC(SlideImageCache, s_slideImageCache)
+
+SlideImageCache::SlideImageCache()
+    : m_images(s_budget)
+{
+}
+
+SlideImageCache *SlideImageCache::self()
+{
+    return s_slideImageCache;
+}
+
+QString SlideImageCache::key(const QString &path, const QSize &size, int fillMode)
+{
+    return QStringLiteral("%1x%2/%3/%4").arg(size.width()).arg(size.height()).arg(fillMode).arg(path);
+}
+
+QImage SlideImageCache::load(const QString &path, const QSize &size, int fillMode)
+{
+    QImageReader reader(path);
+    const QSize imageSize = reader.size();
+
+    QSize scaledSize;
+    if (imageSize.isValid() && !size.isEmpty()) {
+        switch (fillMode) {
+        case Stretch:
+            scaledSize = size;
+            break;
+        case PreserveAspectFit:
+            scaledSize = imageSize.scaled(size, Qt::KeepAspectRatio);
+            break;
+        case PreserveAspectCrop:
+            scaledSize = imageSize.scaled(size, Qt::KeepAspectRatioByExpanding);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // the jpeg reader decodes at a fraction of the size when scaling down
+    if (scaledSize.isValid() && scaledSize != imageSize) {
+        reader.setScaledSize(scaledSize);
+    }
+    QImage image = reader.read();
+    if (!image.isNull() && scaledSize.isValid() && image.size() != scaledSize) {
+        image = image.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
+
+QString SlideImageCache::preload(const QString &path, const QSize &size, int fillMode)
+{
+    const QString k = key(path, size, fillMode);
+    QMutexLocker locker(&m_mutex);
+    if (m_pending.contains(k) || m_images.contains(k)) {
+        return k;
+    }
+    m_pending.insert(k, false);
+    QThreadPool::globalInstance()->start(new SlidePreloader(k, path, size, fillMode));
+    return k;
+}
+
+void SlideImageCache::discard(const QString &key)
+{
+    QMutexLocker locker(&m_mutex);
+    m_images.remove(key);
+    QHash<QString, bool>::iterator it = m_pending.find(key);
+    if (it != m_pending.end() && !it.value()) {
+        m_pending.erase(it);
+        m_loaded.wakeAll();
+    }
+}
+
+bool SlideImageCache::start(const QString &key)
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, bool>::iterator it = m_pending.find(key);
+    if (it == m_pending.end()) {
+        return false;
+    }
+    it.value() = true;
+    return true;
+}
+
+void SlideImageCache::insert(const QString &key, const QImage &image)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending.remove(key);
+    if (!image.isNull()) {
+        // fails if the image alone is over the budget, it is decoded again when shown
+        m_images.insert(key, new QImage(image), qMax(1, image.byteCount() / 1024));
+    }
+    m_loaded.wakeAll();
+}
+
+QImage SlideImageCache::take(const QString &path, const QSize &size, int fillMode)
+{
+    const QString k = key(path, size, fillMode);
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_pending.contains(k)) {
+            m_loaded.wait(&m_mutex);
+        }
+        if (QImage *cached = m_images.object(k)) {
+            // QML keeps the only copy from here on
+            const QImage image = *cached;
+            m_images.remove(k);
+            return image;
+        }
+    }
+    return load(path, size, fillMode);
+}
+
+SlidePreloader::SlidePreloader(const QString &key, const QString &path, const QSize &size, int fillMode)
+    : m_key(key),
+      m_path(path),
+      m_size(size),
+      m_fillMode(fillMode)
+{
+}
+
+void SlidePreloader::run()
+{
+    SlideImageCache *cache = SlideImageCache::self();
+    if (cache->start(m_key)) {
+        cache->insert(m_key, SlideImageCache::load(m_path, m_size, m_fillMode));
+    }
+}
+
+SlideImageProvider::SlideImageProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+}
+
+QImage SlideImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    const int separator = id.indexOf(QLatin1Char('/'));
+    if (separator < 0) {
+        return QImage();
+    }
+
+    bool ok;
+    const int fillMode = id.left(separator).toInt(&ok);
+    // QML passes the path encoded or not depending on the characters in it
+    const QString path = QUrl::fromPercentEncoding(id.mid(separator + 1).toUtf8());
+    if (!ok || path.isEmpty()) {
+        return QImage();
+    }
+
+    const QImage image = SlideImageCache::self()->take(path, requestedSize, fillMode);
+    if (size) {
+        *size = image.size();
+    }
+    return image;
+}
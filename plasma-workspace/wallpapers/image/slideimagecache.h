@@ -0,0 +1,119 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#ifndef SLIDEIMAGECACHE_H
+#define SLIDEIMAGECACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QQuickImageProvider>
+#include <QRunnable>
+#include <QWaitCondition>
+
+/**
+ * Wallpaper images decoded and scaled for one screen, shared by all the
+ * wallpapers of the process.
+ *
+ * The slideshow preloads the upcoming slide in the thread pool, the image
+ * provider then hands it over to QML when the slide is shown, so that it
+ * doesn't have to decode the full resolution image at that point. The
+ * preloaded images are bounded by a memory budget.
+ */
+class SlideImageCache
+{
+public:
+    /**
+     * The values of the fillMode of the QtQuick Image element
+     */
+    enum FillMode {
+        Stretch,
+        PreserveAspectFit,
+        PreserveAspectCrop,
+        Tile,
+        TileVertically,
+        TileHorizontally,
+        Pad
+    };
+
+    SlideImageCache();
+
+    static SlideImageCache *self();
+
+    /**
+     * Decodes the image at @p path scaled for a screen of @p size with @p fillMode,
+     * the tiled and padded modes keep the size of the image
+     */
+    static QImage load(const QString &path, const QSize &size, int fillMode);
+
+    /**
+     * Starts decoding the image at @p path in the thread pool, unless it is loaded already
+     * @return the key of the preloaded image
+     */
+    QString preload(const QString &path, const QSize &size, int fillMode);
+
+    /**
+     * Drops the image of @p key if it wasn't taken, or its decoding didn't start yet
+     */
+    void discard(const QString &key);
+
+    /**
+     * Removes the image from the cache and returns it, it is decoded if it wasn't
+     * preloaded. Waits for the image if it is being decoded.
+     */
+    QImage take(const QString &path, const QSize &size, int fillMode);
+
+private:
+    friend class SlidePreloader;
+
+    static QString key(const QString &path, const QSize &size, int fillMode);
+    bool start(const QString &key);
+    void insert(const QString &key, const QImage &image);
+
+    QMutex m_mutex;
+    QWaitCondition m_loaded;
+    // whether the decoding of a queued image started
+    QHash<QString, bool> m_pending;
+    // the cost is in kB
+    QCache<QString, QImage> m_images;
+};
+
+class SlidePreloader : public QRunnable
+{
+public:
+    SlidePreloader(const QString &key, const QString &path, const QSize &size, int fillMode);
+    void run();
+
+private:
+    QString m_key;
+    QString m_path;
+    QSize m_size;
+    int m_fillMode;
+};
+
+/**
+ * Provides the wallpapers as image://wallpaperimage/<fillMode>/<path>
+ */
+class SlideImageProvider : public QQuickImageProvider
+{
+public:
+    SlideImageProvider();
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+};
+
+#endif // SLIDEIMAGECACHE_H
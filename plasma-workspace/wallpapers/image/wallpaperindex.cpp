@@ -0,0 +1,218 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "wallpaperindex.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <QDebug>
+
+static const quint32 s_indexMagic = 0x57504958; // "WPIX"
+static const quint32 s_indexVersion = 1;
+
+Q_GLOBAL_STATIC(WallpaperIndex, s_wallpaperIndex)
+
+QDataStream &operator<<(QDataStream &stream, const WallpaperIndex::Entry &entry)
+{
+    return stream << entry.modified << entry.size << entry.imageSize << entry.wallpapers << entry.subdirs;
+}
+
+QDataStream &operator>>(QDataStream &stream, WallpaperIndex::Entry &entry)
+{
+    return stream >> entry.modified >> entry.size >> entry.imageSize >> entry.wallpapers >> entry.subdirs;
+}
+
+WallpaperIndex::WallpaperIndex()
+    : m_loaded(false),
+      m_dirty(false)
+{
+    m_fileName = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/wallpaperindex");
+}
+
+WallpaperIndex::~WallpaperIndex()
+{
+    save();
+}
+
+WallpaperIndex *WallpaperIndex::self()
+{
+    return s_wallpaperIndex;
+}
+
+void WallpaperIndex::load()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic;
+    quint32 version;
+    stream >> magic >> version;
+    if (magic != s_indexMagic || version != s_indexVersion) {
+        return;
+    }
+
+    stream.setVersion(QDataStream::Qt_5_0);
+    QHash<QString, Entry> entries;
+    stream >> entries;
+    if (stream.status() == QDataStream::Ok) {
+        m_entries = entries;
+    } else {
+        qDebug() << "Discarding corrupt wallpaper index" << m_fileName;
+    }
+}
+
+bool WallpaperIndex::lookup(const QString &path, Entry *entry)
+{
+    const QFileInfo info(path);
+    if (!info.exists()) {
+        m_dirty = m_entries.remove(path) || m_dirty;
+        return false;
+    }
+
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    const qint64 size = info.isDir() ? -1 : info.size();
+    QHash<QString, Entry>::const_iterator it = m_entries.constFind(path);
+    if (it != m_entries.constEnd() && it->modified == modified && it->size == size) {
+        *entry = *it;
+        return true;
+    }
+
+    entry->modified = modified;
+    entry->size = size;
+    return false;
+}
+
+bool WallpaperIndex::directory(const QString &path, QStringList *wallpapers, QStringList *subdirs)
+{
+    // KDirWatch and the finders don't agree on trailing slashes
+    const QString dir = QDir::cleanPath(path);
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    Entry entry;
+    if (!lookup(dir, &entry)) {
+        return false;
+    }
+    *wallpapers = entry.wallpapers;
+    *subdirs = entry.subdirs;
+    return true;
+}
+
+void WallpaperIndex::setDirectory(const QString &path, const QStringList &wallpapers, const QStringList &subdirs)
+{
+    const QString dir = QDir::cleanPath(path);
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    Entry entry;
+    if (lookup(dir, &entry) && entry.wallpapers == wallpapers && entry.subdirs == subdirs) {
+        return;
+    }
+    if (!QFileInfo(dir).isDir()) {
+        return;
+    }
+    entry.wallpapers = wallpapers;
+    entry.subdirs = subdirs;
+    m_entries.insert(dir, entry);
+    m_dirty = true;
+}
+
+QSize WallpaperIndex::imageSize(const QString &filePath)
+{
+    const QString path = QDir::cleanPath(filePath);
+    {
+        QMutexLocker locker(&m_mutex);
+        load();
+
+        Entry entry;
+        if (lookup(path, &entry) && entry.imageSize.isValid()) {
+            return entry.imageSize;
+        }
+    }
+
+    // the size is in the header of the common formats, only decode the image for the others
+    QSize size = QImageReader(path).size();
+    if (!size.isValid()) {
+        size = QImage(path).size();
+    }
+    if (!size.isValid()) {
+        return size;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Entry entry;
+    if (!lookup(path, &entry) || entry.imageSize != size) {
+        entry.imageSize = size;
+        m_entries.insert(path, entry);
+        m_dirty = true;
+    }
+    return size;
+}
+
+void WallpaperIndex::invalidate(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    const QString cleanPath = QDir::cleanPath(path);
+    if (m_entries.remove(cleanPath)) {
+        m_dirty = true;
+    }
+    if (m_entries.remove(QFileInfo(cleanPath).path())) {
+        m_dirty = true;
+    }
+}
+
+void WallpaperIndex::save()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_dirty) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(m_fileName).path());
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Could not write the wallpaper index" << m_fileName;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << s_indexMagic << s_indexVersion;
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << m_entries;
+    if (file.commit()) {
+        m_dirty = false;
+    }
+}
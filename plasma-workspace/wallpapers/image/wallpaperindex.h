@@ -0,0 +1,87 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#ifndef WALLPAPERINDEX_H
+#define WALLPAPERINDEX_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSize>
+#include <QStringList>
+
+/**
+ * On-disk index of the wallpaper directories and image dimensions.
+ *
+ * Every entry is keyed by the path and stays valid as long as the modification
+ * time and size of the file or directory don't change, so a directory is only
+ * listed again and an image only probed again if it changed. The index is shared
+ * by the BackgroundFinder threads and the ImageSizeFinder runnables.
+ */
+class WallpaperIndex
+{
+public:
+    WallpaperIndex();
+    ~WallpaperIndex();
+
+    static WallpaperIndex *self();
+
+    /**
+     * Looks up the image files and subdirectories found in @p dir when it was last listed.
+     * Whether a subdirectory is a wallpaper package is left to the caller, as adding a
+     * metadata.desktop does not touch the modification time of @p dir.
+     * @return false if @p dir is not indexed or was modified since
+     */
+    bool directory(const QString &dir, QStringList *wallpapers, QStringList *subdirs);
+    void setDirectory(const QString &dir, const QStringList &wallpapers, const QStringList &subdirs);
+
+    /**
+     * @return the dimensions of the image at @p path, which are read from
+     * the image header unless they are indexed already
+     */
+    QSize imageSize(const QString &path);
+
+    /**
+     * Drops @p path and its parent directory from the index, for the changes reported by KDirWatch
+     */
+    void invalidate(const QString &path);
+
+    /**
+     * Writes the index to disk if it changed
+     */
+    void save();
+
+    struct Entry {
+        Entry() : modified(0), size(-1) {}
+        qint64 modified;
+        qint64 size;
+        QSize imageSize;
+        QStringList wallpapers;
+        QStringList subdirs;
+    };
+
+private:
+    bool lookup(const QString &path, Entry *entry);
+    void load();
+
+    QMutex m_mutex;
+    bool m_loaded;
+    QString m_fileName;
+    QHash<QString, Entry> m_entries;
+    bool m_dirty;
+};
+
+#endif // WALLPAPERINDEX_H
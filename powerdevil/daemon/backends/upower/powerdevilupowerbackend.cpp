@@ -24,6 +24,7 @@
 
 #include <qtextstream.h>
 #include <QtDBus>
+#include <QTimer>
 
 #include <KDebug>
 #include <kauthexecutejob.h>
@@ -40,6 +41,28 @@
 
 #define HELPER_ID "org.kde.powerdevil.backlighthelper"
 
+// minimum time between two brightness writes through the helper
+#define BRIGHTNESS_WRITE_INTERVAL 100
+
+// reads the brightness in percent straight from sysfs, -1 if not readable
+static float brightnessFromDevice(const UdevQt::Device &device)
+{
+    if (!device.isValid()) {
+        return -1;
+    }
+
+    bool ok = false;
+    const int maxBrightness = device.sysfsProperty("max_brightness").toInt(&ok);
+    if (!ok || maxBrightness <= 0) {
+        return -1;
+    }
+    const int brightness = device.sysfsProperty("brightness").toInt(&ok);
+    if (!ok) {
+        return -1;
+    }
+    return brightness * 100 / maxBrightness;
+}
+
 bool checkSystemdVersion(uint requiredVersion)
 {
 
@@ -76,6 +99,8 @@ bool checkSystemdVersion(uint requiredVersion)
 PowerDevilUPowerBackend::PowerDevilUPowerBackend(QObject* parent)
     : BackendInterface(parent),
       m_brightnessControl(0),
+      m_udevClient(0), m_brightnessWriteTimer(0), m_pendingBrightness(-1),
+      m_brightnessWrites(0), m_brightnessWriteFailed(false),
       m_lidIsPresent(false), m_lidIsClosed(false), m_onBattery(false), m_kbdMaxBrightness(0)
 {
 
@@ -172,8 +197,22 @@ void PowerDevilUPowerBackend::init()
             m_syspath = job->data()["syspath"].toString();
             m_syspath = QFileInfo(m_syspath).readLink();
 
-            UdevQt::Client *client =  new UdevQt::Client(QStringList("backlight"), this);
-            connect(client, SIGNAL(deviceChanged(UdevQt::Device)), SLOT(onDeviceChanged(UdevQt::Device)));
+            m_udevClient = new UdevQt::Client(QStringList("backlight"), this);
+            connect(m_udevClient, SIGNAL(deviceChanged(UdevQt::Device)), SLOT(onDeviceChanged(UdevQt::Device)));
+
+            // sysfs is usually world-readable, so reads are served from a cache
+            // kept current by udev and only writes go through the helper
+            float currentBrightness = brightnessFromDevice(m_udevClient->deviceBySysfsPath(m_syspath));
+            if (currentBrightness < 0) {
+                kDebug() << "Can't read brightness from" << m_syspath << ", asking the helper";
+                currentBrightness = helperBrightness();
+            }
+            m_cachedBrightnessMap.insert(Screen, currentBrightness);
+
+            m_brightnessWriteTimer = new QTimer(this);
+            m_brightnessWriteTimer->setSingleShot(true);
+            m_brightnessWriteTimer->setInterval(BRIGHTNESS_WRITE_INTERVAL);
+            connect(m_brightnessWriteTimer, SIGNAL(timeout()), SLOT(writePendingBrightness()));
             screenBrightnessAvailable = true;
         }
     } else {
@@ -298,11 +337,20 @@ void PowerDevilUPowerBackend::onDeviceChanged(const UdevQt::Device &device)
         return;
     }
 
-    int maxBrightness = device.sysfsProperty("max_brightness").toInt();
-    if (maxBrightness <= 0) {
+    // our own writes are still settling, the cache already has the value we asked for
+    // and the device is read again once they are done, see syncBrightness()
+    if (m_brightnessWriteTimer->isActive() || m_brightnessWrites > 0) {
+        return;
+    }
+
+    updateCachedBrightness(brightnessFromDevice(device));
+}
+
+void PowerDevilUPowerBackend::updateCachedBrightness(float newBrightness)
+{
+    if (newBrightness < 0) {
         return;
     }
-    float newBrightness = device.sysfsProperty("brightness").toInt() * 100 / maxBrightness;
 
     if (!qFuzzyCompare(newBrightness, m_cachedBrightnessMap[Screen])) {
         m_cachedBrightnessMap[Screen] = newBrightness;
@@ -361,17 +409,8 @@ float PowerDevilUPowerBackend::brightness(PowerDevil::BackendInterface::Brightne
             //kDebug() << "Calling xrandr brightness";
             result = m_brightnessControl->brightness();
         } else {
-            //kDebug() << "Falling back to helper to get brightness";
-            KAuth::Action action("org.kde.powerdevil.backlighthelper.brightness");
-            action.setHelperId(HELPER_ID);
-            KAuth::ExecuteJob *job = action.execute();
-            if (!job->error()) {
-                result = job->data()["brightness"].toFloat();
-                //kDebug() << "org.kde.powerdevil.backlighthelper.brightness succeeded: " << reply.data()["brightness"];
-            }
-            else
-                kWarning() << "org.kde.powerdevil.backlighthelper.brightness failed";
-
+            // kept current by onDeviceChanged() and setBrightness()
+            result = m_cachedBrightnessMap.value(Screen);
         }
         kDebug() << "Screen brightness: " << result;
     } else if (type == Keyboard) {
@@ -389,19 +428,23 @@ bool PowerDevilUPowerBackend::setBrightness(float brightnessValue, PowerDevil::B
         kDebug() << "set screen brightness: " << brightnessValue;
         if (m_brightnessControl->isSupported()) {
             m_brightnessControl->setBrightness(brightnessValue);
+            success = true;
         } else {
-            //kDebug() << "Falling back to helper to set brightness";
-            KAuth::Action action("org.kde.powerdevil.backlighthelper.setbrightness");
-            action.setHelperId(HELPER_ID);
-            action.addArgument("brightness", brightnessValue);
-            KAuth::ExecuteJob *job = action.execute();
-            if (job->error()) {
-                kWarning() << "org.kde.powerdevil.backlighthelper.setbrightness failed";
-                return false;
+            // only the last value of a key repeat burst needs to reach the helper
+            if (m_brightnessWriteTimer->isActive()) {
+                m_pendingBrightness = brightnessValue;
+            } else {
+                writeBrightness(brightnessValue);
             }
-        }
 
-        success = true;
+            if (!qFuzzyCompare(brightnessValue, m_cachedBrightnessMap.value(Screen))) {
+                m_cachedBrightnessMap[Screen] = brightnessValue;
+                onBrightnessChanged(Screen, brightnessValue);
+            }
+
+            // the write itself is asynchronous, this reports whether the helper is failing
+            success = !m_brightnessWriteFailed;
+        }
     } else if (type == Keyboard) {
         kDebug() << "set kbd backlight: " << brightnessValue;
         m_kbdBacklight->SetBrightness(qRound(brightnessValue / 100 * m_kbdMaxBrightness));
@@ -411,6 +454,66 @@ bool PowerDevilUPowerBackend::setBrightness(float brightnessValue, PowerDevil::B
     return success;
 }
 
+float PowerDevilUPowerBackend::helperBrightness() const
+{
+    KAuth::Action action("org.kde.powerdevil.backlighthelper.brightness");
+    action.setHelperId(HELPER_ID);
+    KAuth::ExecuteJob *job = action.execute();
+    job->exec();
+    if (job->error()) {
+        kWarning() << "org.kde.powerdevil.backlighthelper.brightness failed";
+        return 0.0;
+    }
+    return job->data()["brightness"].toFloat();
+}
+
+void PowerDevilUPowerBackend::writeBrightness(float brightness)
+{
+    m_pendingBrightness = -1;
+    m_brightnessWriteTimer->start();
+    ++m_brightnessWrites;
+
+    KAuth::Action action("org.kde.powerdevil.backlighthelper.setbrightness");
+    action.setHelperId(HELPER_ID);
+    action.addArgument("brightness", brightness);
+    KAuth::ExecuteJob *job = action.execute();
+    connect(job, SIGNAL(result(KJob*)), this, SLOT(onBrightnessWriteResult(KJob*)));
+    job->start();
+}
+
+void PowerDevilUPowerBackend::writePendingBrightness()
+{
+    if (m_pendingBrightness >= 0) {
+        writeBrightness(m_pendingBrightness);
+    } else {
+        syncBrightness();
+    }
+}
+
+void PowerDevilUPowerBackend::onBrightnessWriteResult(KJob *job)
+{
+    --m_brightnessWrites;
+    m_brightnessWriteFailed = job->error();
+    if (job->error()) {
+        kWarning() << "org.kde.powerdevil.backlighthelper.setbrightness failed" << job->errorText();
+    }
+
+    if (!m_brightnessWriteTimer->isActive()) {
+        syncBrightness();
+    }
+}
+
+void PowerDevilUPowerBackend::syncBrightness()
+{
+    if (m_brightnessWrites > 0 || m_pendingBrightness >= 0) {
+        return;
+    }
+
+    // the udev changes were ignored while writing, and a failed write
+    // has to show the brightness the screen actually has
+    updateCachedBrightness(brightnessFromDevice(m_udevClient->deviceBySysfsPath(m_syspath)));
+}
+
 void PowerDevilUPowerBackend::slotScreenBrightnessChanged()
 {
     float newBrightness = brightness(Screen);
@@ -41,6 +41,8 @@
 
 #define LOGIN1_SERVICE "org.freedesktop.login1"
 
+class QTimer;
+class KJob;
 class UdevHelper;
 class XRandRXCBHelper;
 class XRandrBrightness;
@@ -64,6 +66,10 @@ public:
 
 private:
     void enumerateDevices();
+    float helperBrightness() const;
+    void writeBrightness(float brightness);
+    void syncBrightness();
+    void updateCachedBrightness(float newBrightness);
 
 private slots:
     void updateDeviceProps();
@@ -77,6 +83,8 @@ private slots:
     void slotScreenBrightnessChanged();
     void onDeviceChanged(const UdevQt::Device &device);
     void onKeyboardBrightnessChanged(int);
+    void writePendingBrightness();
+    void onBrightnessWriteResult(KJob *job);
 
     void onPropertiesChanged(const QString &ifaceName, const QVariantMap &changedProps, const QStringList &invalidatedProps);
     void onDevicePropertiesChanged(const QString &ifaceName, const QVariantMap &changedProps, const QStringList &invalidatedProps);
@@ -90,6 +98,13 @@ private:
     XRandrBrightness         *m_brightnessControl;
     XRandRXCBHelper *m_randrHelper;
 
+    UdevQt::Client *m_udevClient;
+    // writes through the backlight helper, coalesced while a key is held
+    QTimer *m_brightnessWriteTimer;
+    float m_pendingBrightness;
+    int m_brightnessWrites; // in flight
+    bool m_brightnessWriteFailed;
+
     OrgFreedesktopUPowerInterface *m_upowerInterface;
     OrgFreedesktopUPowerKbdBacklightInterface *m_kbdBacklight;
     int m_kbdMaxBrightness;
@@ -21,6 +21,12 @@
 #include "BaseConfig.h"
 
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QRadioButton>
 #include <QVariantList>
 #include <QLoggingCategory>
@@ -35,12 +41,21 @@
 #include <KStandardAction>
 #include <KActionCollection>
 #include <KServiceTypeTrader>
+#include <KSycoca>
 #include <KToolBar>
 #include <kwindowconfig.h>
 
 #include "BaseData.h"
 #include "ModuleView.h"
 
+// Bump when the layout written by saveMenuCache() changes
+static const quint32 menuCacheVersion = 1;
+
+static QString menuCachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/menu-tree");
+}
+
 SettingsBase::SettingsBase( QWidget * parent )
     : KXmlGuiWindow(parent)
 {
@@ -49,6 +64,7 @@ SettingsBase::SettingsBase( QWidget * parent )
     aboutDialog = 0;
     configDialog = 0;
     lostFound = 0;
+    rootModule = 0;
     // Prepare the view area
     stackedWidget = new QStackedWidget( this );
     setWindowTitle(i18n("System Settings"));
@@ -81,20 +97,28 @@ QSize SettingsBase::sizeHint() const
 
 void SettingsBase::initApplication()
 {
-    // Prepare the menu of all modules
-    categories = KServiceTypeTrader::self()->query("SystemSettingsCategory");
-    modules = KServiceTypeTrader::self()->query("KCModule", "[X-KDE-System-Settings-Parent-Category] != ''");
-    modules += KServiceTypeTrader::self()->query("SystemSettingsExternalApp");
-    rootModule = new MenuItem( true, 0 );
-    initMenuList(rootModule);
-    // Handle lost+found modules...
-    if (lostFound) {
-        for (int i = 0; i < modules.size(); ++i) {
-            const KService::Ptr entry = modules.at(i);
-            MenuItem * infoItem = new MenuItem(false, lostFound);
-            infoItem->setService( entry );
-            qDebug() << "Added " << entry->name();
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+    // Prepare the menu of all modules, the cached tree is valid as long as sycoca is unchanged
+    if ( loadMenuCache() ) {
+        qDebug() << "Module tree loaded from cache in" << startupTimer.elapsed() << "ms";
+    } else {
+        categories = KServiceTypeTrader::self()->query("SystemSettingsCategory");
+        modules = KServiceTypeTrader::self()->query("KCModule", "[X-KDE-System-Settings-Parent-Category] != ''");
+        modules += KServiceTypeTrader::self()->query("SystemSettingsExternalApp");
+        rootModule = new MenuItem( true, 0 );
+        initMenuList(rootModule);
+        // Handle lost+found modules...
+        if (lostFound) {
+            for (int i = 0; i < modules.size(); ++i) {
+                const KService::Ptr entry = modules.at(i);
+                MenuItem * infoItem = new MenuItem(false, lostFound);
+                infoItem->setService( entry );
+                qDebug() << "Added " << entry->name();
+            }
         }
+        saveMenuCache();
+        qDebug() << "Module tree built from sycoca in" << startupTimer.elapsed() << "ms";
     }
 
     // Prepare the Base Data
@@ -120,6 +144,73 @@ void SettingsBase::initApplication()
     searchText->completionObject()->setIgnoreCase( true );
     searchText->completionObject()->setItems( BaseData::instance()->menuItem()->keywords() );
     changePlugin();
+    qDebug() << "System Settings ready in" << startupTimer.elapsed() << "ms";
+}
+
+bool SettingsBase::loadMenuCache()
+{
+    QFile file( menuCachePath() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    QDataStream stream( &file );
+    quint32 version;
+    quint32 timeStamp;
+    qint32 count;
+    stream >> version >> timeStamp >> count;
+    if ( stream.status() != QDataStream::Ok || version != menuCacheVersion ||
+         timeStamp != KSycoca::self()->timeStamp() ) {
+        return false;
+    }
+
+    // The items are stored parents first, each one refers to its parent by position
+    rootModule = new MenuItem( true, 0 );
+    QList<MenuItem*> items;
+    for ( qint32 i = 0; i < count; ++i ) {
+        qint32 parentIndex;
+        bool isMenu;
+        QString entryPath;
+        stream >> parentIndex >> isMenu >> entryPath;
+        const KService::Ptr service = KService::serviceByDesktopPath( entryPath );
+        if ( stream.status() != QDataStream::Ok || parentIndex >= items.count() || !service ) {
+            qDebug() << "Discarding stale module cache at" << entryPath;
+            delete rootModule;
+            rootModule = 0;
+            lostFound = 0;
+            return false;
+        }
+        MenuItem * item = new MenuItem( isMenu, parentIndex < 0 ? rootModule : items.at( parentIndex ) );
+        item->setService( service );
+        if ( isMenu && item->category() == "lost-and-found" ) {
+            lostFound = item;
+        }
+        items.append( item );
+    }
+    return true;
+}
+
+void SettingsBase::saveMenuCache()
+{
+    QDir().mkpath( QStandardPaths::writableLocation(QStandardPaths::CacheLocation) );
+    QSaveFile file( menuCachePath() );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        return;
+    }
+
+    // Flatten the tree, parents always come before their children
+    QList<MenuItem*> items = rootModule->children();
+    for ( int i = 0; i < items.count(); ++i ) {
+        items += items.at( i )->children();
+    }
+
+    QDataStream stream( &file );
+    stream << menuCacheVersion << KSycoca::self()->timeStamp() << qint32( items.count() );
+    foreach ( MenuItem * item, items ) {
+        const qint32 parentIndex = item->parent() == rootModule ? -1 : items.indexOf( item->parent() );
+        stream << parentIndex << item->menu() << item->service()->entryPath();
+    }
+    file.commit();
 }
 
 void SettingsBase::initToolBar()
@@ -53,6 +53,8 @@ private Q_SLOTS:
     void initHelpMenu();
     void initConfig();
     void initMenuList(MenuItem * parent);
+    bool loadMenuCache();
+    void saveMenuCache();
     void configUpdated();
     void configShow();
     void about();
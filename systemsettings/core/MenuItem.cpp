@@ -33,7 +33,15 @@ static bool childIsLessThan( MenuItem *left, MenuItem *right )
 
 class MenuItem::Private {
 public:
-    Private() {}
+    Private() : keywordsValid( false ) {}
+
+    void invalidateKeywords()
+    {
+        // Parents carry the keywords of all their children
+        for ( Private * item = this; item; item = item->parent ? item->parent->d : 0 ) {
+            item->keywordsValid = false;
+        }
+    }
 
     MenuItem *parent;
     QList<MenuItem*> children;
@@ -43,6 +51,8 @@ public:
     int weight;
     KService::Ptr service;
     KCModuleInfo item;
+    QStringList keywords;
+    bool keywordsValid;
 };
 
 MenuItem::MenuItem( bool isMenu, MenuItem * itsParent )
@@ -53,6 +63,7 @@ MenuItem::MenuItem( bool isMenu, MenuItem * itsParent )
 
     if ( d->parent ) {
         d->parent->children().append( this );
+        d->parent->d->invalidateKeywords();
     }
 }
 
@@ -65,6 +76,7 @@ MenuItem::~MenuItem()
 void MenuItem::sortChildrenByWeight()
 {
     qSort( d->children.begin(), d->children.end(), childIsLessThan );
+    d->invalidateKeywords();
 }
 
 MenuItem * MenuItem::child( int index )
@@ -74,12 +86,18 @@ MenuItem * MenuItem::child( int index )
 
 QStringList MenuItem::keywords()
 {
+    if ( d->keywordsValid ) {
+        return d->keywords;
+    }
+
     QStringList listOfKeywords;
 
     listOfKeywords << d->item.keywords() << d->name;
     foreach ( MenuItem * child, d->children ) {
         listOfKeywords += child->keywords();
     }
+    d->keywords = listOfKeywords;
+    d->keywordsValid = true;
     return listOfKeywords;
 }
 
@@ -129,6 +147,7 @@ void MenuItem::setService( const KService::Ptr& service )
     d->category = service->property("X-KDE-System-Settings-Category").toString();
     d->name = service->name();
     d->item = KCModuleInfo( service );
+    d->invalidateKeywords();
     const QVariant itemWeight = service->property( "X-KDE-Weight", QVariant::Int );
     if( itemWeight.isValid() ) {
         d->weight = itemWeight.toInt();
@@ -84,6 +84,7 @@ public:
      * Returns the list of keywords, which is used for searching the list of categories and modules.
      *
      * @note The parent items share all the keywords of their children.
+     * The list is built once and cached until the item or its children change.
      * @returns The list of keywords the item has.
      */
     QStringList keywords();